@@ -0,0 +1,318 @@
+#include <string.h>
+
+#include "aot.h"
+#include "object.h"
+#include "operand.h"
+
+// instructions per generated function
+#define AOT_BLOCK_INSTRUCTIONS 512
+
+// helpers every generated program starts w/, mirroring vm.c
+static const char* prelude =
+    "#include <stdio.h>\n"
+    "#include <stdlib.h>\n"
+    "#include <string.h>\n"
+    "\n"
+    "#include \"common.h\"\n"
+    "#include \"memory.h\"\n"
+    "#include \"object.h\"\n"
+    "#include \"output.h\"\n"
+    "#include \"value.h\"\n"
+    "#include \"vm.h\"\n"
+    "\n"
+    "static void runtimeError(const char* message, int line) {\n"
+    "    fprintf(stderr, \"%s\\n[line %d] in script\\n\", message, line);\n"
+    "    freeVM();\n"
+    "    exit(70);\n"
+    "}\n"
+    "\n"
+    "static bool isFalsey(Value value) {\n"
+    "    return IS_NIL(value) || (IS_BOOL(value) && !AS_BOOL(value));\n"
+    "}\n"
+    "\n"
+    "static Value concatenate(Value a, Value b) {\n"
+    "    ObjString* left = AS_STRING(a);\n"
+    "    ObjString* right = AS_STRING(b);\n"
+    "\n"
+    "    int length = left -> length + right -> length;\n"
+    "    char* chars = ALLOCATE(char, length + 1, MEM_STRINGS);\n"
+    "    memcpy(chars, left -> chars, left -> length);\n"
+    "    memcpy(chars + left -> length, right -> chars, right -> length);\n"
+    "    chars[length] = '\\0';\n"
+    "\n"
+    "    Value result = OBJ_VAL(takeString(chars, length));\n"
+    "\n"
+    "    // the one place anything is allocated, so a slice of the\n"
+    "    // collector's work goes here like it goes between run()'s\n"
+    "    // instructions\n"
+    "    if (vm.gcPhase != GC_IDLE)\n"
+    "        gcStep();\n"
+    "\n"
+    "    return result;\n"
+    "}\n"
+    "\n";
+
+// a C string literal w/ the same bytes
+static void emitStringLiteral(FILE* out, const char* chars, int length) {
+    fputc('"', out);
+    for (int i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)chars[i];
+        if (c == '"' || c == '\\')
+            fprintf(out, "\\%c", c);
+        else if (c < 0x20 || c >= 0x7F)
+            // always three digits, so a digit after it can't join in
+            fprintf(out, "\\%03o", c);
+        else
+            fputc(c, out);
+    }
+    fputc('"', out);
+}
+
+// the stack depth never depends on the data, so the stack has a...
+// ... fixed size and every slot index is a constant
+static int maxDepth(Chunk* chunk) {
+    int depth = 0, max = 0;
+
+    for (uint8_t* ip = chunk -> code; ip < chunk -> code + chunk -> count;) {
+        switch (*ip++) {
+            case OP_CONSTANT:
+                ip++;
+                depth++;
+                break;
+            case OP_CONSTANT_LONG:
+            case OP_GET_INPUT:
+            case OP_GET_LOCAL:
+                decodeOperand(&ip);
+                depth++;
+                break;
+            case OP_SET_LOCAL:
+                decodeOperand(&ip);
+                break;
+            case OP_NIL:
+            case OP_TRUE:
+            case OP_FALSE:
+                depth++;
+                break;
+            case OP_EQUAL:
+            case OP_GREATER:
+            case OP_LESS:
+            case OP_ADD:
+            case OP_SUBTRACT:
+            case OP_MULTIPLY:
+            case OP_DIVIDE:
+                depth--;
+                break;
+            default:
+                break;
+        }
+
+        if (depth > max)
+            max = depth;
+    }
+
+    return max;
+}
+
+static void emitConstants(Chunk* chunk, FILE* out) {
+    ValueArray* constants = &chunk -> constants;
+
+    fprintf(out, "// the constant pool, w/ strings made into objects at "
+        "startup\n");
+    fprintf(out, "static const Value constantPool[%d] = {\n",
+        constants -> count > 0 ? constants -> count : 1);
+
+    for (int i = 0; i < constants -> count; i++) {
+        Value value = constants -> values[i];
+        switch (value.type) {
+            // hex floats keep every bit of the double
+            case VAL_NUMBER:
+                fprintf(out, "    {VAL_NUMBER, {.number = %a}},   // %.17g\n",
+                    AS_NUMBER(value), AS_NUMBER(value));
+                break;
+            case VAL_BOOL:
+                fprintf(out, "    {VAL_BOOL, {.boolean = %s}},\n",
+                    AS_BOOL(value) ? "true" : "false");
+                break;
+            default:
+                fprintf(out, "    {VAL_NIL, {.number = 0}},\n");
+                break;
+        }
+    }
+    fprintf(out, "};\n\n");
+
+    // the constants, then the stack's slots, go on the VM's stack...
+    // ... which makes them roots for the collector
+    fprintf(out, "#define constants (vm.dyn_stack)\n");
+    fprintf(out, "#define stack (vm.dyn_stack + %d)\n\n", constants -> count);
+
+    fprintf(out, "static void initStack(void) {\n");
+    fprintf(out, "    for (int i = 0; i < %d; i++)\n", constants -> count);
+    fprintf(out, "        push(constantPool[i]);\n");
+    fprintf(out, "    for (int i = 0; i < %d; i++)\n", maxDepth(chunk));
+    fprintf(out, "        push(NIL_VAL);\n\n");
+
+    for (int i = 0; i < constants -> count; i++) {
+        Value value = constants -> values[i];
+        if (!IS_STRING(value))
+            continue;
+
+        ObjString* string = AS_STRING(value);
+        fprintf(out, "    constants[%d] = OBJ_VAL(copyString(", i);
+        emitStringLiteral(out, string -> chars, string -> length);
+        fprintf(out, ", %d));\n", string -> length);
+    }
+    fprintf(out, "}\n\n");
+}
+
+// a binary op on two numbers, `top` being the right operand
+static void emitNumberOp(FILE* out, int top, int line, const char* wrap,
+                         const char* op) {
+    fprintf(out, "    if (!IS_NUMBER(stack[%d]) || "
+        "!IS_NUMBER(stack[%d]))\n", top - 1, top);
+    fprintf(out, "        runtimeError(\"operands must be numbers\", %d);\n",
+        line);
+    fprintf(out, "    stack[%d] = %s(AS_NUMBER(stack[%d]) %s "
+        "AS_NUMBER(stack[%d]));\n", top - 1, wrap, top - 1, op, top);
+}
+
+bool emitC(Chunk* chunk, const char* scriptName, FILE* out) {
+    fprintf(out, "// generated by `clox --emit-c` from %s\n\n", scriptName);
+    fputs(prelude, out);
+    emitConstants(chunk, out);
+
+    // one huge function takes the C compiler minutes on a big...
+    // ... script, so the code is split into blocks run in order
+    int blocks = 0;
+    int inBlock = AOT_BLOCK_INSTRUCTIONS;
+
+    int top = -1;
+    for (uint8_t* ip = chunk -> code; ip < chunk -> code + chunk -> count;) {
+        int offset = (int)(ip - chunk -> code);
+        int line = getLine(chunk, offset);
+        uint8_t instruction = *ip++;
+
+        if (inBlock == AOT_BLOCK_INSTRUCTIONS) {
+            if (blocks > 0)
+                fprintf(out, "}\n");
+            fprintf(out, "\nstatic void block%d(void) {", blocks++);
+            inBlock = 0;
+        }
+        inBlock++;
+
+        fprintf(out, "\n    // %04d\n", offset);
+
+        switch (instruction) {
+            case OP_CONSTANT:
+            case OP_CONSTANT_LONG: {
+                uint32_t index = instruction == OP_CONSTANT ?
+                    *ip++ : decodeOperand(&ip);
+                fprintf(out, "    stack[%d] = constants[%u];\n", ++top,
+                    index);
+                break;
+            }
+
+            case OP_NIL:
+                fprintf(out, "    stack[%d] = NIL_VAL;\n", ++top);
+                break;
+
+            case OP_TRUE:
+                fprintf(out, "    stack[%d] = BOOL_VAL(true);\n", ++top);
+                break;
+
+            case OP_FALSE:
+                fprintf(out, "    stack[%d] = BOOL_VAL(false);\n", ++top);
+                break;
+
+            case OP_EQUAL:
+                fprintf(out, "    stack[%d] = BOOL_VAL(valuesEqual("
+                    "stack[%d], stack[%d]));\n", top - 1, top - 1, top);
+                top--;
+                break;
+
+            case OP_GREATER:
+                emitNumberOp(out, top--, line, "BOOL_VAL", ">");
+                break;
+
+            case OP_LESS:
+                emitNumberOp(out, top--, line, "BOOL_VAL", "<");
+                break;
+
+            case OP_ADD:
+                fprintf(out, "    if (IS_STRING(stack[%d]) && "
+                    "IS_STRING(stack[%d]))\n", top - 1, top);
+                fprintf(out, "        stack[%d] = concatenate(stack[%d], "
+                    "stack[%d]);\n", top - 1, top - 1, top);
+                fprintf(out, "    else if (IS_NUMBER(stack[%d]) && "
+                    "IS_NUMBER(stack[%d]))\n", top - 1, top);
+                fprintf(out, "        stack[%d] = NUMBER_VAL("
+                    "AS_NUMBER(stack[%d]) + AS_NUMBER(stack[%d]));\n",
+                    top - 1, top - 1, top);
+                fprintf(out, "    else\n");
+                fprintf(out, "        runtimeError(\"operands must be two "
+                    "numbers or two strings\", %d);\n", line);
+                top--;
+                break;
+
+            case OP_SUBTRACT:
+                emitNumberOp(out, top--, line, "NUMBER_VAL", "-");
+                break;
+
+            case OP_MULTIPLY:
+                emitNumberOp(out, top--, line, "NUMBER_VAL", "*");
+                break;
+
+            case OP_DIVIDE:
+                emitNumberOp(out, top--, line, "NUMBER_VAL", "/");
+                break;
+
+            case OP_NOT:
+                fprintf(out, "    stack[%d] = BOOL_VAL(isFalsey("
+                    "stack[%d]));\n", top, top);
+                break;
+
+            case OP_NEGATE:
+                fprintf(out, "    if (!IS_NUMBER(stack[%d]))\n", top);
+                fprintf(out, "        runtimeError(\"operand must be a "
+                    "number\", %d);\n", line);
+                fprintf(out, "    stack[%d] = NUMBER_VAL("
+                    "-AS_NUMBER(stack[%d]));\n", top, top);
+                break;
+
+            // the slots are the bottom of the stack
+            case OP_GET_LOCAL:
+                fprintf(out, "    stack[%d] = stack[%u];\n", top + 1,
+                    decodeOperand(&ip));
+                top++;
+                break;
+
+            case OP_SET_LOCAL:
+                fprintf(out, "    stack[%u] = stack[%d];\n",
+                    decodeOperand(&ip), top);
+                break;
+
+            case OP_RETURN:
+                fprintf(out, "    writeValue(stack[%d]);\n", top);
+                fprintf(out, "    writeOutput(\"\\n\", 1);\n");
+                fprintf(out, "    return;\n");
+                break;
+
+            // there's nothing to bind an input to outside an embedder
+            case OP_GET_INPUT:
+            default:
+                return false;
+        }
+    }
+
+    fprintf(out, "}\n\n");
+
+    fprintf(out, "int main(void) {\n");
+    fprintf(out, "    initVM();\n");
+    fprintf(out, "    initStack();\n");
+    for (int i = 0; i < blocks; i++)
+        fprintf(out, "    block%d();\n", i);
+    fprintf(out, "    freeVM();\n");
+    fprintf(out, "    return 0;\n");
+    fprintf(out, "}\n");
+
+    return true;
+}
@@ -0,0 +1,18 @@
+#ifndef clox_aot_h
+#define clox_aot_h
+
+#include <stdio.h>
+
+#include "chunk.h"
+
+// writes a chunk out as a C program that does what running it...
+// ... would: a statement or two per instruction, w/ the stack in...
+// ... locals and the constant pool as static data; it links...
+// ... against the runtime (every clox source but main.c), see...
+// ... `make aot`
+//
+// false (w/ nothing useful written) for a chunk that reads...
+// ... inputs, which only an embedder can bind
+bool emitC(Chunk* chunk, const char* scriptName, FILE* out);
+
+#endif
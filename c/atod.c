@@ -0,0 +1,348 @@
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "atod.h"
+
+// three ways to the double, cheapest first:
+// - a significand and a power of ten that are both exact doubles...
+//   ... need one multiplication or division, the only rounding...
+//   ... (Clinger); that's every short literal
+// - Eisel-Lemire: the significand times a 128-bit 5^q from the...
+//   ... table below, w/ the rounding settled by the product's low...
+//   ... bits; it gives up when they can't settle it
+// - `strtod()` on a copy of the lexeme, for whatever's left
+
+// the most digits a uint64_t always holds
+#define MAX_SIGNIFICAND_DIGITS 19
+
+// the powers of ten Eisel-Lemire has a 5^q for; literals w/ a...
+// ... decimal exponent outside go to `strtod()`
+#define MIN_POWER -64
+#define MAX_POWER 64
+
+// 10^q exactly, up to the largest that's an exact double
+static const double exactPowers[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// 5^q normalized to 128 bits, truncated for q >= 0 and rounded up...
+// ... for q < 0, as high and low words
+static const uint64_t powersOfFive[][2] = {
+    {0xa87fea27a539e9a5ull, 0x3f2398d747b36224ull},   // 5^-64
+    {0xd29fe4b18e88640eull, 0x8eec7f0d19a03aadull},   // 5^-63
+    {0x83a3eeeef9153e89ull, 0x1953cf68300424acull},   // 5^-62
+    {0xa48ceaaab75a8e2bull, 0x5fa8c3423c052dd7ull},   // 5^-61
+    {0xcdb02555653131b6ull, 0x3792f412cb06794dull},   // 5^-60
+    {0x808e17555f3ebf11ull, 0xe2bbd88bbee40bd0ull},   // 5^-59
+    {0xa0b19d2ab70e6ed6ull, 0x5b6aceaeae9d0ec4ull},   // 5^-58
+    {0xc8de047564d20a8bull, 0xf245825a5a445275ull},   // 5^-57
+    {0xfb158592be068d2eull, 0xeed6e2f0f0d56712ull},   // 5^-56
+    {0x9ced737bb6c4183dull, 0x55464dd69685606bull},   // 5^-55
+    {0xc428d05aa4751e4cull, 0xaa97e14c3c26b886ull},   // 5^-54
+    {0xf53304714d9265dfull, 0xd53dd99f4b3066a8ull},   // 5^-53
+    {0x993fe2c6d07b7fabull, 0xe546a8038efe4029ull},   // 5^-52
+    {0xbf8fdb78849a5f96ull, 0xde98520472bdd033ull},   // 5^-51
+    {0xef73d256a5c0f77cull, 0x963e66858f6d4440ull},   // 5^-50
+    {0x95a8637627989aadull, 0xdde7001379a44aa8ull},   // 5^-49
+    {0xbb127c53b17ec159ull, 0x5560c018580d5d52ull},   // 5^-48
+    {0xe9d71b689dde71afull, 0xaab8f01e6e10b4a6ull},   // 5^-47
+    {0x9226712162ab070dull, 0xcab3961304ca70e8ull},   // 5^-46
+    {0xb6b00d69bb55c8d1ull, 0x3d607b97c5fd0d22ull},   // 5^-45
+    {0xe45c10c42a2b3b05ull, 0x8cb89a7db77c506aull},   // 5^-44
+    {0x8eb98a7a9a5b04e3ull, 0x77f3608e92adb242ull},   // 5^-43
+    {0xb267ed1940f1c61cull, 0x55f038b237591ed3ull},   // 5^-42
+    {0xdf01e85f912e37a3ull, 0x6b6c46dec52f6688ull},   // 5^-41
+    {0x8b61313bbabce2c6ull, 0x2323ac4b3b3da015ull},   // 5^-40
+    {0xae397d8aa96c1b77ull, 0xabec975e0a0d081aull},   // 5^-39
+    {0xd9c7dced53c72255ull, 0x96e7bd358c904a21ull},   // 5^-38
+    {0x881cea14545c7575ull, 0x7e50d64177da2e54ull},   // 5^-37
+    {0xaa242499697392d2ull, 0xdde50bd1d5d0b9e9ull},   // 5^-36
+    {0xd4ad2dbfc3d07787ull, 0x955e4ec64b44e864ull},   // 5^-35
+    {0x84ec3c97da624ab4ull, 0xbd5af13bef0b113eull},   // 5^-34
+    {0xa6274bbdd0fadd61ull, 0xecb1ad8aeacdd58eull},   // 5^-33
+    {0xcfb11ead453994baull, 0x67de18eda5814af2ull},   // 5^-32
+    {0x81ceb32c4b43fcf4ull, 0x80eacf948770ced7ull},   // 5^-31
+    {0xa2425ff75e14fc31ull, 0xa1258379a94d028dull},   // 5^-30
+    {0xcad2f7f5359a3b3eull, 0x096ee45813a04330ull},   // 5^-29
+    {0xfd87b5f28300ca0dull, 0x8bca9d6e188853fcull},   // 5^-28
+    {0x9e74d1b791e07e48ull, 0x775ea264cf55347eull},   // 5^-27
+    {0xc612062576589ddaull, 0x95364afe032a819eull},   // 5^-26
+    {0xf79687aed3eec551ull, 0x3a83ddbd83f52205ull},   // 5^-25
+    {0x9abe14cd44753b52ull, 0xc4926a9672793543ull},   // 5^-24
+    {0xc16d9a0095928a27ull, 0x75b7053c0f178294ull},   // 5^-23
+    {0xf1c90080baf72cb1ull, 0x5324c68b12dd6339ull},   // 5^-22
+    {0x971da05074da7beeull, 0xd3f6fc16ebca5e04ull},   // 5^-21
+    {0xbce5086492111aeaull, 0x88f4bb1ca6bcf585ull},   // 5^-20
+    {0xec1e4a7db69561a5ull, 0x2b31e9e3d06c32e6ull},   // 5^-19
+    {0x9392ee8e921d5d07ull, 0x3aff322e62439fd0ull},   // 5^-18
+    {0xb877aa3236a4b449ull, 0x09befeb9fad487c3ull},   // 5^-17
+    {0xe69594bec44de15bull, 0x4c2ebe687989a9b4ull},   // 5^-16
+    {0x901d7cf73ab0acd9ull, 0x0f9d37014bf60a11ull},   // 5^-15
+    {0xb424dc35095cd80full, 0x538484c19ef38c95ull},   // 5^-14
+    {0xe12e13424bb40e13ull, 0x2865a5f206b06fbaull},   // 5^-13
+    {0x8cbccc096f5088cbull, 0xf93f87b7442e45d4ull},   // 5^-12
+    {0xafebff0bcb24aafeull, 0xf78f69a51539d749ull},   // 5^-11
+    {0xdbe6fecebdedd5beull, 0xb573440e5a884d1cull},   // 5^-10
+    {0x89705f4136b4a597ull, 0x31680a88f8953031ull},   // 5^-9
+    {0xabcc77118461cefcull, 0xfdc20d2b36ba7c3eull},   // 5^-8
+    {0xd6bf94d5e57a42bcull, 0x3d32907604691b4dull},   // 5^-7
+    {0x8637bd05af6c69b5ull, 0xa63f9a49c2c1b110ull},   // 5^-6
+    {0xa7c5ac471b478423ull, 0x0fcf80dc33721d54ull},   // 5^-5
+    {0xd1b71758e219652bull, 0xd3c36113404ea4a9ull},   // 5^-4
+    {0x83126e978d4fdf3bull, 0x645a1cac083126eaull},   // 5^-3
+    {0xa3d70a3d70a3d70aull, 0x3d70a3d70a3d70a4ull},   // 5^-2
+    {0xccccccccccccccccull, 0xcccccccccccccccdull},   // 5^-1
+    {0x8000000000000000ull, 0x0000000000000000ull},   // 5^0
+    {0xa000000000000000ull, 0x0000000000000000ull},   // 5^1
+    {0xc800000000000000ull, 0x0000000000000000ull},   // 5^2
+    {0xfa00000000000000ull, 0x0000000000000000ull},   // 5^3
+    {0x9c40000000000000ull, 0x0000000000000000ull},   // 5^4
+    {0xc350000000000000ull, 0x0000000000000000ull},   // 5^5
+    {0xf424000000000000ull, 0x0000000000000000ull},   // 5^6
+    {0x9896800000000000ull, 0x0000000000000000ull},   // 5^7
+    {0xbebc200000000000ull, 0x0000000000000000ull},   // 5^8
+    {0xee6b280000000000ull, 0x0000000000000000ull},   // 5^9
+    {0x9502f90000000000ull, 0x0000000000000000ull},   // 5^10
+    {0xba43b74000000000ull, 0x0000000000000000ull},   // 5^11
+    {0xe8d4a51000000000ull, 0x0000000000000000ull},   // 5^12
+    {0x9184e72a00000000ull, 0x0000000000000000ull},   // 5^13
+    {0xb5e620f480000000ull, 0x0000000000000000ull},   // 5^14
+    {0xe35fa931a0000000ull, 0x0000000000000000ull},   // 5^15
+    {0x8e1bc9bf04000000ull, 0x0000000000000000ull},   // 5^16
+    {0xb1a2bc2ec5000000ull, 0x0000000000000000ull},   // 5^17
+    {0xde0b6b3a76400000ull, 0x0000000000000000ull},   // 5^18
+    {0x8ac7230489e80000ull, 0x0000000000000000ull},   // 5^19
+    {0xad78ebc5ac620000ull, 0x0000000000000000ull},   // 5^20
+    {0xd8d726b7177a8000ull, 0x0000000000000000ull},   // 5^21
+    {0x878678326eac9000ull, 0x0000000000000000ull},   // 5^22
+    {0xa968163f0a57b400ull, 0x0000000000000000ull},   // 5^23
+    {0xd3c21bcecceda100ull, 0x0000000000000000ull},   // 5^24
+    {0x84595161401484a0ull, 0x0000000000000000ull},   // 5^25
+    {0xa56fa5b99019a5c8ull, 0x0000000000000000ull},   // 5^26
+    {0xcecb8f27f4200f3aull, 0x0000000000000000ull},   // 5^27
+    {0x813f3978f8940984ull, 0x4000000000000000ull},   // 5^28
+    {0xa18f07d736b90be5ull, 0x5000000000000000ull},   // 5^29
+    {0xc9f2c9cd04674edeull, 0xa400000000000000ull},   // 5^30
+    {0xfc6f7c4045812296ull, 0x4d00000000000000ull},   // 5^31
+    {0x9dc5ada82b70b59dull, 0xf020000000000000ull},   // 5^32
+    {0xc5371912364ce305ull, 0x6c28000000000000ull},   // 5^33
+    {0xf684df56c3e01bc6ull, 0xc732000000000000ull},   // 5^34
+    {0x9a130b963a6c115cull, 0x3c7f400000000000ull},   // 5^35
+    {0xc097ce7bc90715b3ull, 0x4b9f100000000000ull},   // 5^36
+    {0xf0bdc21abb48db20ull, 0x1e86d40000000000ull},   // 5^37
+    {0x96769950b50d88f4ull, 0x1314448000000000ull},   // 5^38
+    {0xbc143fa4e250eb31ull, 0x17d955a000000000ull},   // 5^39
+    {0xeb194f8e1ae525fdull, 0x5dcfab0800000000ull},   // 5^40
+    {0x92efd1b8d0cf37beull, 0x5aa1cae500000000ull},   // 5^41
+    {0xb7abc627050305adull, 0xf14a3d9e40000000ull},   // 5^42
+    {0xe596b7b0c643c719ull, 0x6d9ccd05d0000000ull},   // 5^43
+    {0x8f7e32ce7bea5c6full, 0xe4820023a2000000ull},   // 5^44
+    {0xb35dbf821ae4f38bull, 0xdda2802c8a800000ull},   // 5^45
+    {0xe0352f62a19e306eull, 0xd50b2037ad200000ull},   // 5^46
+    {0x8c213d9da502de45ull, 0x4526f422cc340000ull},   // 5^47
+    {0xaf298d050e4395d6ull, 0x9670b12b7f410000ull},   // 5^48
+    {0xdaf3f04651d47b4cull, 0x3c0cdd765f114000ull},   // 5^49
+    {0x88d8762bf324cd0full, 0xa5880a69fb6ac800ull},   // 5^50
+    {0xab0e93b6efee0053ull, 0x8eea0d047a457a00ull},   // 5^51
+    {0xd5d238a4abe98068ull, 0x72a4904598d6d880ull},   // 5^52
+    {0x85a36366eb71f041ull, 0x47a6da2b7f864750ull},   // 5^53
+    {0xa70c3c40a64e6c51ull, 0x999090b65f67d924ull},   // 5^54
+    {0xd0cf4b50cfe20765ull, 0xfff4b4e3f741cf6dull},   // 5^55
+    {0x82818f1281ed449full, 0xbff8f10e7a8921a4ull},   // 5^56
+    {0xa321f2d7226895c7ull, 0xaff72d52192b6a0dull},   // 5^57
+    {0xcbea6f8ceb02bb39ull, 0x9bf4f8a69f764490ull},   // 5^58
+    {0xfee50b7025c36a08ull, 0x02f236d04753d5b4ull},   // 5^59
+    {0x9f4f2726179a2245ull, 0x01d762422c946590ull},   // 5^60
+    {0xc722f0ef9d80aad6ull, 0x424d3ad2b7b97ef5ull},   // 5^61
+    {0xf8ebad2b84e0d58bull, 0xd2e0898765a7deb2ull},   // 5^62
+    {0x9b934c3b330c8577ull, 0x63cc55f49f88eb2full},   // 5^63
+    {0xc2781f49ffcfa6d5ull, 0x3cbf6b71c76b25fbull},   // 5^64
+};
+
+typedef struct {
+    uint64_t high;
+    uint64_t low;
+} Uint128;
+
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 NativeUint128;
+#endif
+
+static Uint128 multiply(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    NativeUint128 product = (NativeUint128)a * b;
+    return (Uint128){(uint64_t)(product >> 64), (uint64_t)product};
+#else
+    uint64_t aHigh = a >> 32, aLow = a & 0xFFFFFFFF;
+    uint64_t bHigh = b >> 32, bLow = b & 0xFFFFFFFF;
+
+    uint64_t lowLow = aLow * bLow;
+    uint64_t highLow = aHigh * bLow;
+    uint64_t lowHigh = aLow * bHigh;
+    uint64_t middle = (lowLow >> 32) + (highLow & 0xFFFFFFFF) +
+        (lowHigh & 0xFFFFFFFF);
+
+    return (Uint128){
+        aHigh * bHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32),
+        (middle << 32) | (lowLow & 0xFFFFFFFF)
+    };
+#endif
+}
+
+static int leadingZeros(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_clzll(x);
+#else
+    int zeros = 0;
+    while (!(x & 0x8000000000000000ull)) {
+        x <<= 1;
+        zeros++;
+    }
+    return zeros;
+#endif
+}
+
+// significand * 10^power (significand != 0) into `result`, false...
+// ... if the product's bits can't tell which way it rounds
+static bool eiselLemire(uint64_t significand, int power, double* result) {
+    if (power < MIN_POWER || power > MAX_POWER)
+        return false;
+
+    // 2^63 * 10^power = 2^(63 + power) * 5^power, and...
+    // ... 152170 / 2^16 is close enough to log2(5) over the range
+    int64_t exponent = (((152170 + 65536) * (int64_t)power) >> 16) +
+        1024 + 63;
+
+    int shift = leadingZeros(significand);
+    significand <<= shift;
+
+    const uint64_t* five = powersOfFive[power - MIN_POWER];
+    Uint128 product = multiply(significand, five[0]);
+
+    // the top 55 bits are exact unless the low 9 of the high word...
+    // ... could still carry, in which case the table's low word...
+    // ... adds the next 64 bits of 5^power
+    if ((product.high & 0x1FF) == 0x1FF) {
+        Uint128 next = multiply(significand, five[1]);
+        product.low += next.high;
+        if (next.high > product.low)
+            product.high++;
+
+        if (product.low == 0xFFFFFFFFFFFFFFFFull)
+            return false;
+    }
+
+    // the product has its top bit at 127 or 126, the mantissa...
+    // ... gets 54 bits of it, one past a double's for rounding
+    uint64_t upperBit = product.high >> 63;
+    uint64_t mantissa = product.high >> (upperBit + 9);
+    shift += (int)(1 ^ upperBit);
+
+    exponent -= shift;
+    if (exponent <= 0)
+        return false;   // subnormal
+
+    // right between two doubles: only when 5^power is exact in...
+    // ... the table can that be told from just above the middle,...
+    // ... and then it's rounded to even
+    if (product.low == 0 && (product.high & 0x1FF) == 0 &&
+            (mantissa & 3) == 1) {
+        if (power < 0 || power > 27)
+            return false;
+        if ((mantissa << (upperBit + 64 - 53 - 2)) == product.high)
+            mantissa &= ~(uint64_t)1;
+    }
+
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+
+    // rounded up past 53 bits
+    if (mantissa >= (1ull << 53)) {
+        mantissa = 1ull << 52;
+        exponent++;
+    }
+    mantissa &= ~(1ull << 52);
+
+    if (exponent > 2046)
+        return false;   // infinity
+
+    uint64_t bits = mantissa | (uint64_t)exponent << 52;
+    memcpy(result, &bits, sizeof(bits));
+    return true;
+}
+
+static double slowNumber(const char* chars, int length) {
+    char small[64];
+    char* copy = length < (int)sizeof(small) ? small : malloc(length + 1);
+    if (copy == NULL)
+        exit(1);
+
+    memcpy(copy, chars, length);
+    copy[length] = '\0';
+    double number = strtod(copy, NULL);
+
+    if (copy != small)
+        free(copy);
+    return number;
+}
+
+double parseNumber(const char* chars, int length) {
+    // the first 19 significant digits, and whether any digit past...
+    // ... them isn't a zero; the number is significand * 10^power
+    uint64_t significand = 0;
+    int digits = 0;
+    int power = 0;
+    bool truncated = false;
+    bool fraction = false;
+
+    for (int i = 0; i < length; i++) {
+        if (chars[i] == '.') {
+            fraction = true;
+            continue;
+        }
+
+        int digit = chars[i] - '0';
+        if (digits == 0 && digit == 0) {
+            // a leading zero
+            power -= fraction;
+        } else if (digits < MAX_SIGNIFICAND_DIGITS) {
+            significand = significand * 10 + digit;
+            digits++;
+            power -= fraction;
+        } else {
+            power += !fraction;
+            truncated |= digit != 0;
+        }
+    }
+
+    if (significand == 0)
+        return 0.0;
+
+    double number;
+    if (!truncated) {
+#if FLT_EVAL_METHOD == 0
+        // w/out excess precision, the one operation is the only...
+        // ... rounding
+        if (significand <= (1ull << 53) && power >= -22 && power <= 22) {
+            return power < 0 ?
+                (double)significand / exactPowers[-power] :
+                (double)significand * exactPowers[power];
+        }
+#endif
+
+        if (eiselLemire(significand, power, &number))
+            return number;
+    } else {
+        // the digits dropped put it between the significand and...
+        // ... the next one, so it's settled if they round the same
+        double above;
+        if (eiselLemire(significand, power, &number) &&
+                eiselLemire(significand + 1, power, &above) &&
+                number == above)
+            return number;
+    }
+
+    return slowNumber(chars, length);
+}
@@ -0,0 +1,12 @@
+#ifndef clox_atod_h
+#define clox_atod_h
+
+#include "common.h"
+
+// the double a number lexeme stands for, correctly rounded and...
+// ... bit for bit what `strtod()` gives; `chars` is the scanner's...
+// ... shape only: digits, then optionally '.' and more digits,...
+// ... and needn't be terminated
+double parseNumber(const char* chars, int length);
+
+#endif
@@ -0,0 +1,287 @@
+// differential test of `parseNumber()`: a generated corpus of number...
+// ... lexemes, the scanner's shape only, has to parse to the same...
+// ... bits `strtod()` gives, from short literals to 400 digits and...
+// ... exact halfway points between doubles; then both are timed,...
+// ... and so is compiling a script full of literals, if given...
+// ... usage: atod_test [lexemes] [seed] [script]
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common.h"
+#include "atod.h"
+#include "memory.h"
+#include "vm.h"
+
+#define MAX_LEXEME 512
+#define TIMING_REPS 20
+#define COMPILE_REPS 50
+
+typedef struct {
+    char chars[MAX_LEXEME];
+    int length;
+} Lexeme;
+
+static double nowNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void appendDigits(Lexeme* lexeme, int count) {
+    for (int i = 0; i < count && lexeme -> length < MAX_LEXEME - 1; i++)
+        lexeme -> chars[lexeme -> length++] = '0' + rand() % 10;
+}
+
+// a double's digits w/out trailing zeros, as a lexeme; false if...
+// ... they don't fit
+static bool fromText(Lexeme* lexeme, const char* text) {
+    int length = (int)strlen(text);
+    if (strchr(text, '.') != NULL) {
+        while (text[length - 1] == '0')
+            length--;
+        if (text[length - 1] == '.')
+            length--;
+    }
+    if (length >= MAX_LEXEME)
+        return false;
+
+    memcpy(lexeme -> chars, text, length);
+    lexeme -> length = length;
+    return true;
+}
+
+static double randomDouble(void) {
+    uint64_t bits = ((uint64_t)rand() << 42) ^ ((uint64_t)rand() << 21) ^
+        (uint64_t)rand();
+    double number;
+    memcpy(&number, &bits, sizeof(number));
+    return number;
+}
+
+// the short literals scripts are mostly made of
+static void shortLiteral(Lexeme* lexeme) {
+    lexeme -> length = snprintf(lexeme -> chars, MAX_LEXEME, "%d",
+        rand() % 1000000);
+    if (rand() % 2) {
+        lexeme -> chars[lexeme -> length++] = '.';
+        appendDigits(lexeme, 1 + rand() % 6);
+    }
+}
+
+static void randomLexeme(Lexeme* lexeme) {
+    char text[2048];
+    lexeme -> length = 0;
+
+    switch (rand() % 6) {
+        case 0:
+            shortLiteral(lexeme);
+            break;
+
+        // up to 40 digits, w/ a '.' anywhere and leading zeros
+        case 1: {
+            if (rand() % 3 == 0)
+                lexeme -> chars[lexeme -> length++] = '0';
+            appendDigits(lexeme, 1 + rand() % 25);
+            if (rand() % 2) {
+                lexeme -> chars[lexeme -> length++] = '.';
+                if (rand() % 2)
+                    for (int i = rand() % 20; i > 0; i--)
+                        lexeme -> chars[lexeme -> length++] = '0';
+                appendDigits(lexeme, 1 + rand() % 15);
+            }
+            break;
+        }
+
+        // any double from 1e-30 to 1e30, to anywhere from 0 to 30...
+        // ... decimals
+        case 2: {
+            double scale = 1.0;
+            for (int e = rand() % 61 - 30; e != 0; e += e > 0 ? -1 : 1)
+                scale = e > 0 ? scale * 10 : scale / 10;
+            double number = (double)(rand() % 1000000) / 1000 * scale;
+            snprintf(text, sizeof(text), "%.*f", rand() % 31, number);
+            if (!fromText(lexeme, text))
+                shortLiteral(lexeme);
+            break;
+        }
+
+        // any double at all, printed exactly: up to 400 digits go...
+        // ... the slow way
+        case 3: {
+            double number = randomDouble();
+            if (!(number - number == 0) || number < 0)
+                number = 1.0;
+            snprintf(text, sizeof(text), "%.*f", rand() % 400, number);
+            if (!fromText(lexeme, text))
+                shortLiteral(lexeme);
+            break;
+        }
+
+        // right between two doubles, or the least bit above it,...
+        // ... where rounding to even decides
+        case 4: {
+            double number = (double)((((uint64_t)rand() << 31) ^ rand()) |
+                1) / (1 << rand() % 24);
+            uint64_t bits;
+            memcpy(&bits, &number, sizeof(bits));
+            bits++;
+            double next;
+            memcpy(&next, &bits, sizeof(next));
+
+            long double middle = ((long double)number + next) / 2;
+            snprintf(text, sizeof(text), "%.80Lf", middle);
+            fromText(lexeme, text);
+            if (rand() % 2)
+                lexeme -> chars[lexeme -> length++] = '1';
+            break;
+        }
+
+        // a 19 to 25 digit integer, past what the significand holds
+        default:
+            appendDigits(lexeme, 19 + rand() % 7);
+            if (lexeme -> chars[0] == '0')
+                lexeme -> chars[0] = '1';
+            break;
+    }
+
+    lexeme -> chars[lexeme -> length] = '\0';
+}
+
+static char* readFile(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "couldn't open file \"%s\"\n", path);
+        exit(74);
+    }
+
+    fseek(file, 0L, SEEK_END);
+    size_t fileSize = ftell(file);
+    rewind(file);
+
+    char* buffer = malloc(fileSize + 1);
+    if (buffer == NULL || fread(buffer, 1, fileSize, file) < fileSize) {
+        fprintf(stderr, "couldn't read file \"%s\"\n", path);
+        exit(74);
+    }
+    buffer[fileSize] = '\0';
+
+    fclose(file);
+    return buffer;
+}
+
+// the lexemes end to end, each w/ a terminator for `strtod()`
+typedef struct {
+    char* chars;
+    size_t count;
+    size_t capacity;
+    int* starts;
+    int* lengths;
+} Corpus;
+
+static void initCorpus(Corpus* corpus, int count) {
+    corpus -> capacity = (size_t)count * 32;
+    corpus -> chars = malloc(corpus -> capacity);
+    corpus -> count = 0;
+    corpus -> starts = malloc(sizeof(int) * count);
+    corpus -> lengths = malloc(sizeof(int) * count);
+}
+
+static void addLexeme(Corpus* corpus, int index, const Lexeme* lexeme) {
+    if (corpus -> count + lexeme -> length + 1 > corpus -> capacity) {
+        corpus -> capacity = corpus -> capacity * 2 + lexeme -> length + 1;
+        corpus -> chars = realloc(corpus -> chars, corpus -> capacity);
+    }
+
+    corpus -> starts[index] = (int)corpus -> count;
+    corpus -> lengths[index] = lexeme -> length;
+    memcpy(corpus -> chars + corpus -> count, lexeme -> chars,
+        lexeme -> length + 1);
+    corpus -> count += lexeme -> length + 1;
+}
+
+static void freeCorpus(Corpus* corpus) {
+    free(corpus -> chars);
+    free(corpus -> starts);
+    free(corpus -> lengths);
+}
+
+// ns per lexeme for each parser
+static void timeParsers(const char* name, const Corpus* corpus, int count) {
+    volatile double sink = 0;
+
+    double start = nowNanos();
+    for (int rep = 0; rep < TIMING_REPS; rep++)
+        for (int i = 0; i < count; i++)
+            sink += strtod(corpus -> chars + corpus -> starts[i], NULL);
+    double strtodTime = nowNanos() - start;
+
+    start = nowNanos();
+    for (int rep = 0; rep < TIMING_REPS; rep++)
+        for (int i = 0; i < count; i++)
+            sink += parseNumber(corpus -> chars + corpus -> starts[i],
+                corpus -> lengths[i]);
+    double parseTime = nowNanos() - start;
+
+    double runs = (double)count * TIMING_REPS;
+    printf("%-16s strtod %7.1f ns  parseNumber %7.1f ns  (%.2fx)\n", name,
+        strtodTime / runs, parseTime / runs, strtodTime / parseTime);
+}
+
+int main(int argc, const char* argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 1000000;
+    unsigned seed = argc > 2 ? (unsigned)atoi(argv[2]) : 1234;
+    srand(seed);
+
+    Corpus corpus, shortCorpus;
+    initCorpus(&corpus, count);
+    initCorpus(&shortCorpus, count);
+    int failures = 0;
+
+    for (int i = 0; i < count; i++) {
+        Lexeme lexeme;
+        randomLexeme(&lexeme);
+        addLexeme(&corpus, i, &lexeme);
+
+        double expected = strtod(lexeme.chars, NULL);
+        double actual = parseNumber(lexeme.chars, lexeme.length);
+        if (memcmp(&expected, &actual, sizeof(double)) != 0) {
+            if (failures++ < 10)
+                printf("MISMATCH: %s\n    strtod:      %a\n"
+                    "    parseNumber: %a\n", lexeme.chars, expected, actual);
+        }
+
+        shortLiteral(&lexeme);
+        lexeme.chars[lexeme.length] = '\0';
+        addLexeme(&shortCorpus, i, &lexeme);
+    }
+
+    printf("%d lexemes, %d mismatches\n", count, failures);
+
+    timeParsers("short literals", &shortCorpus, count);
+    timeParsers("whole corpus", &corpus, count);
+
+    if (argc > 3) {
+        char* src = readFile(argv[3]);
+        size_t bytes = strlen(src);
+
+        initVM();
+        double start = nowNanos();
+        for (int rep = 0; rep < COMPILE_REPS; rep++)
+            freeProgram(compileProgram(src, NULL, 0));
+        double compileTime = nowNanos() - start;
+        freeVM();
+
+        printf("compiling %s: %.1f MB/s\n", argv[3],
+            bytes * COMPILE_REPS / (compileTime / 1e9) / 1e6);
+        free(src);
+    }
+
+    freeCorpus(&shortCorpus);
+    freeCorpus(&corpus);
+    return failures == 0 ? 0 : 1;
+}
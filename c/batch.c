@@ -0,0 +1,270 @@
+#include "batch.h"
+#include "chunk.h"
+#include "memory.h"
+#include "operand.h"
+
+// what a stack slot's lanes hold: rows only differ in their...
+// ... inputs and there's no control flow, so every lane of a...
+// ... slot has the same type and one tag covers the whole batch
+typedef enum {
+    LANES_NUMBER,
+    LANES_BOOL,     // 1.0 for true, 0.0 for false
+} LaneType;
+
+typedef double Lanes[BATCH_LANES];
+
+typedef struct {
+    LaneType type;
+
+    // the slot's own scratch, or straight into an input column
+    const double* lanes;
+} Slot;
+
+// a stack of column vectors; every push is at least a byte of...
+// ... code, so the chunk's length bounds how deep it gets
+typedef struct {
+    Slot* slots;
+    Lanes* scratch;
+    int count;
+    int capacity;
+} BatchStack;
+
+// the kernels: plain loops over double arrays that the compiler...
+// ... turns into SIMD, w/ comparisons giving 1.0 or 0.0
+
+#define BINARY_KERNEL(name, op) \
+    static void name(double* dst, const double* a, const double* b, \
+                     int lanes) { \
+        for (int i = 0; i < lanes; i++) \
+            dst[i] = a[i] op b[i]; \
+    }
+
+BINARY_KERNEL(addLanes, +)
+BINARY_KERNEL(subtractLanes, -)
+BINARY_KERNEL(multiplyLanes, *)
+BINARY_KERNEL(divideLanes, /)
+BINARY_KERNEL(greaterLanes, >)
+BINARY_KERNEL(lessLanes, <)
+BINARY_KERNEL(equalLanes, ==)
+
+#undef BINARY_KERNEL
+
+static void negateLanes(double* dst, const double* a, int lanes) {
+    for (int i = 0; i < lanes; i++)
+        dst[i] = -a[i];
+}
+
+static void notLanes(double* dst, const double* a, int lanes) {
+    for (int i = 0; i < lanes; i++)
+        dst[i] = 1.0 - a[i];
+}
+
+static void fillLanes(double* dst, double value, int lanes) {
+    for (int i = 0; i < lanes; i++)
+        dst[i] = value;
+}
+
+// pushes a slot and returns its scratch for the caller to fill
+static double* pushSlot(BatchStack* stack, LaneType type) {
+    double* scratch = stack -> scratch[stack -> count];
+    stack -> slots[stack -> count].type = type;
+    stack -> slots[stack -> count].lanes = scratch;
+    stack -> count++;
+    return scratch;
+}
+
+// runs one batch of `lanes` rows starting at `row`, and returns...
+// ... false when it needs something only the scalar VM does
+static bool runBatch(Program* program, BatchStack* stack,
+                     const double* const* columns, int row, int lanes,
+                     Value* results) {
+    Chunk* chunk = &program -> chunk;
+    uint8_t* ip = chunk -> code;
+    stack -> count = 0;
+
+    for (;;) {
+        uint8_t instruction = *ip++;
+
+        switch (instruction) {
+            case OP_CONSTANT:
+            case OP_CONSTANT_LONG: {
+                uint32_t index = instruction == OP_CONSTANT ?
+                    *ip++ : decodeOperand(&ip);
+
+                Value constant = chunk -> constants.values[index];
+                if (!IS_NUMBER(constant))
+                    return false;
+
+                fillLanes(pushSlot(stack, LANES_NUMBER),
+                    AS_NUMBER(constant), lanes);
+                break;
+            }
+
+            case OP_TRUE:
+            case OP_FALSE:
+                fillLanes(pushSlot(stack, LANES_BOOL),
+                    instruction == OP_TRUE ? 1.0 : 0.0, lanes);
+                break;
+
+            case OP_GET_INPUT: {
+                uint32_t index = decodeOperand(&ip);
+                pushSlot(stack, LANES_NUMBER);
+                stack -> slots[stack -> count - 1].lanes =
+                    columns[index] + row;
+                break;
+            }
+
+            case OP_EQUAL:
+            case OP_GREATER:
+            case OP_LESS:
+            case OP_ADD:
+            case OP_SUBTRACT:
+            case OP_MULTIPLY:
+            case OP_DIVIDE: {
+                Slot* b = &stack -> slots[stack -> count - 1];
+                Slot* a = &stack -> slots[stack -> count - 2];
+                double* dst = stack -> scratch[stack -> count - 2];
+
+                if (instruction == OP_EQUAL) {
+                    // a number never equals a bool
+                    if (a -> type != b -> type)
+                        fillLanes(dst, 0.0, lanes);
+                    else
+                        equalLanes(dst, a -> lanes, b -> lanes, lanes);
+
+                    a -> type = LANES_BOOL;
+                    a -> lanes = dst;
+                    stack -> count--;
+                    break;
+                }
+
+                if (a -> type != LANES_NUMBER || b -> type != LANES_NUMBER)
+                    return false;
+
+                switch (instruction) {
+                    case OP_GREATER:
+                        greaterLanes(dst, a -> lanes, b -> lanes, lanes);
+                        break;
+                    case OP_LESS:
+                        lessLanes(dst, a -> lanes, b -> lanes, lanes);
+                        break;
+                    case OP_ADD:
+                        addLanes(dst, a -> lanes, b -> lanes, lanes);
+                        break;
+                    case OP_SUBTRACT:
+                        subtractLanes(dst, a -> lanes, b -> lanes, lanes);
+                        break;
+                    case OP_MULTIPLY:
+                        multiplyLanes(dst, a -> lanes, b -> lanes, lanes);
+                        break;
+                    case OP_DIVIDE:
+                        divideLanes(dst, a -> lanes, b -> lanes, lanes);
+                        break;
+                }
+
+                bool compares = instruction == OP_GREATER ||
+                    instruction == OP_LESS;
+                a -> type = compares ? LANES_BOOL : LANES_NUMBER;
+                a -> lanes = dst;
+                stack -> count--;
+                break;
+            }
+
+            case OP_NOT: {
+                Slot* a = &stack -> slots[stack -> count - 1];
+                double* dst = stack -> scratch[stack -> count - 1];
+
+                // numbers are all truthy
+                if (a -> type == LANES_NUMBER)
+                    fillLanes(dst, 0.0, lanes);
+                else
+                    notLanes(dst, a -> lanes, lanes);
+
+                a -> type = LANES_BOOL;
+                a -> lanes = dst;
+                break;
+            }
+
+            case OP_NEGATE: {
+                Slot* a = &stack -> slots[stack -> count - 1];
+                double* dst = stack -> scratch[stack -> count - 1];
+
+                if (a -> type != LANES_NUMBER)
+                    return false;
+
+                negateLanes(dst, a -> lanes, lanes);
+                a -> lanes = dst;
+                break;
+            }
+
+            case OP_RETURN: {
+                Slot* a = &stack -> slots[stack -> count - 1];
+                for (int i = 0; i < lanes; i++)
+                    results[row + i] = a -> type == LANES_NUMBER ?
+                        NUMBER_VAL(a -> lanes[i]) :
+                        BOOL_VAL(a -> lanes[i] != 0.0);
+                return true;
+            }
+
+            // nil and anything added later
+            default:
+                return false;
+        }
+    }
+}
+
+// the batch's rows one at a time, `*kept` counts object results...
+// ... left on the VM's stack to keep them from the collector
+static InterpretResult runRows(Program* program, Value* inputs,
+                               const double* const* columns, int row,
+                               int lanes, Value* results, int* kept) {
+    for (int r = row; r < row + lanes; r++) {
+        for (int i = 0; i < program -> inputCount; i++)
+            inputs[i] = NUMBER_VAL(columns[i][r]);
+
+        InterpretResult res = runProgram(program, inputs, &results[r]);
+        if (res != INTERPRET_OK)
+            return res;
+
+        if (IS_OBJ(results[r])) {
+            push(results[r]);
+            (*kept)++;
+        }
+    }
+
+    return INTERPRET_OK;
+}
+
+InterpretResult runProgramBatch(Program* program,
+                                const double* const* columns, int rows,
+                                Value* results) {
+    BatchStack stack;
+    stack.count = 0;
+    stack.capacity = program -> chunk.count;
+    stack.slots = ALLOCATE(Slot, stack.capacity, MEM_STACK);
+    stack.scratch = ALLOCATE(Lanes, stack.capacity, MEM_STACK);
+
+    Value* inputs = ALLOCATE(Value, program -> inputCount, MEM_STACK);
+
+    InterpretResult res = INTERPRET_OK;
+    int kept = 0;
+
+    for (int row = 0; row < rows && res == INTERPRET_OK;
+            row += BATCH_LANES) {
+        int lanes = rows - row < BATCH_LANES ? rows - row : BATCH_LANES;
+
+        if (!runBatch(program, &stack, columns, row, lanes, results))
+            res = runRows(program, inputs, columns, row, lanes, results,
+                &kept);
+    }
+
+    // a runtime error already emptied the VM's stack
+    if (res == INTERPRET_OK)
+        vm.count -= kept;
+
+    FREE_ARRAY(Value, inputs, program -> inputCount, MEM_STACK);
+    FREE_ARRAY(Lanes, stack.scratch, stack.capacity, MEM_STACK);
+    FREE_ARRAY(Slot, stack.slots, stack.capacity, MEM_STACK);
+
+    return res;
+}
@@ -0,0 +1,24 @@
+#ifndef clox_batch_h
+#define clox_batch_h
+
+#include "common.h"
+#include "value.h"
+#include "vm.h"
+
+// rows run through the chunk together: each stack slot holds...
+// ... this many lanes, one per row
+#define BATCH_LANES 256
+
+// runs a program once per batch of rows instead of once per row...
+// ... `columns[i]` holds `rows` values of the program's i-th input...
+// ... and row r's value goes in `results[r]`
+//
+// numbers and bools are done a whole batch per opcode; a batch...
+// ... needing anything else (nil, strings, a type error) is run...
+// ... row by row through `runProgram()` instead, which also reports...
+// ... the error of the first failing row
+InterpretResult runProgramBatch(Program* program,
+                                const double* const* columns, int rows,
+                                Value* results);
+
+#endif
@@ -0,0 +1,106 @@
+// compares running a compiled expression over columns of numbers...
+// ... a row at a time against a batch at a time...
+// ... usage: batch_bench [rows...]
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "common.h"
+#include "batch.h"
+#include "memory.h"
+#include "value.h"
+#include "vm.h"
+
+#define INPUT_COUNT 3
+
+static const char* const inputNames[INPUT_COUNT] = {
+    "price", "quantity", "discount"
+};
+
+// a filter and a projection over the same columns
+static const char* expressions[] = {
+    "(price * quantity - discount) * 1.08 > 100",
+    "(price * quantity - discount) * 1.08",
+};
+
+static double nowNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void bench(const char* src, int rows) {
+    double* columns[INPUT_COUNT];
+    for (int i = 0; i < INPUT_COUNT; i++)
+        columns[i] = malloc(sizeof(double) * rows);
+
+    for (int r = 0; r < rows; r++) {
+        columns[0][r] = 5 + r % 37;
+        columns[1][r] = 1 + r % 7;
+        columns[2][r] = r % 11;
+    }
+
+    Value* scalar = malloc(sizeof(Value) * rows);
+    Value* batched = malloc(sizeof(Value) * rows);
+    Program* program = compileProgram(src, inputNames, INPUT_COUNT);
+
+    // a row at a time...
+    double start = nowNanos();
+    for (int r = 0; r < rows; r++) {
+        Value inputs[INPUT_COUNT];
+        for (int i = 0; i < INPUT_COUNT; i++)
+            inputs[i] = NUMBER_VAL(columns[i][r]);
+
+        runProgram(program, inputs, &scalar[r]);
+    }
+    double scalarTime = nowNanos() - start;
+
+    // ... and a batch at a time
+    start = nowNanos();
+    runProgramBatch(program, (const double* const*)columns, rows, batched);
+    double batchTime = nowNanos() - start;
+
+    int mismatches = 0;
+    for (int r = 0; r < rows; r++) {
+        if (!valuesEqual(scalar[r], batched[r]))
+            mismatches++;
+    }
+
+    printf("%9d %14.0f %14.0f %8.2fx   %s\n", rows,
+        rows / (scalarTime / 1e9), rows / (batchTime / 1e9),
+        scalarTime / batchTime, mismatches == 0 ? "ok" : "MISMATCH");
+
+    freeProgram(program);
+    free(batched);
+    free(scalar);
+    for (int i = 0; i < INPUT_COUNT; i++)
+        free(columns[i]);
+}
+
+int main(int argc, const char* argv[]) {
+    initVM();
+
+    for (size_t e = 0; e < sizeof(expressions) / sizeof(expressions[0]);
+            e++) {
+        printf("%s\n", expressions[e]);
+        printf("%9s %14s %14s %9s\n", "rows", "scalar rows/s",
+            "batch rows/s", "speedup");
+
+        if (argc > 1) {
+            for (int i = 1; i < argc; i++)
+                bench(expressions[e], atoi(argv[i]));
+        }
+        else {
+            bench(expressions[e], 10000);
+            bench(expressions[e], 1000000);
+        }
+
+        printf("\n");
+    }
+
+    freeVM();
+    return 0;
+}
@@ -0,0 +1,212 @@
+// tests of `runProgramBatch()` against running the same program a...
+// ... row at a time: batches of numbers and bools, the row-by-row...
+// ... fallback for programs that need anything else, object...
+// ... results kept from a cycle that runs mid-batch, and errors
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "batch.h"
+#include "memory.h"
+#include "object.h"
+#include "value.h"
+#include "vm.h"
+
+// two whole batches and a partial one
+#define ROWS (2 * BATCH_LANES + 88)
+
+static const char* const names[] = {"x", "y"};
+
+static double xs[ROWS];
+static double ys[ROWS];
+static const double* const columns[] = {xs, ys};
+
+static int failures = 0;
+
+static void expect(const char* what, bool ok) {
+    printf("%-52s %s\n", what, ok ? "ok" : "<-- FAILED");
+
+    if (!ok)
+        failures++;
+}
+
+// whether the collector still has `object` in its list
+static bool isLive(Obj* object) {
+    for (Obj* live = vm.objects; live != NULL; live = live -> next)
+        if (live == object)
+            return true;
+    return false;
+}
+
+static int compareAddresses(const void* a, const void* b) {
+    uintptr_t x = (uintptr_t)*(Obj* const*)a;
+    uintptr_t y = (uintptr_t)*(Obj* const*)b;
+    return (x > y) - (x < y);
+}
+
+// runs `src` over every row both ways, and counts the rows where...
+// ... they disagree; -1 if either run fails
+static int mismatches(const char* src) {
+    Program* program = compileProgram(src, names, 2);
+    if (program == NULL)
+        return -1;
+
+    Value* batched = malloc(sizeof(Value) * ROWS);
+    int count = 0;
+    if (runProgramBatch(program, columns, ROWS, batched) != INTERPRET_OK)
+        count = -1;
+
+    for (int r = 0; r < ROWS && count >= 0; r++) {
+        Value inputs[] = {NUMBER_VAL(xs[r]), NUMBER_VAL(ys[r])};
+        Value scalar;
+        if (runProgram(program, inputs, &scalar) != INTERPRET_OK)
+            count = -1;
+        else if (!valuesEqual(scalar, batched[r]))
+            count++;
+    }
+
+    free(batched);
+    freeProgram(program);
+    return count;
+}
+
+void test_batched(void) {
+    expect("x * 2 - y / 4 matches row by row",
+        mismatches("x * 2 - y / 4") == 0);
+    expect("-(x - y) matches", mismatches("-(x - y)") == 0);
+    expect("x > y matches", mismatches("x > y") == 0);
+    expect("!(x < y) == (x == y) matches",
+        mismatches("!(x < y) == (x == y)") == 0);
+    expect("x == true matches", mismatches("x == true") == 0);
+}
+
+void test_fallback(void) {
+    // nil and strings aren't done in lanes, so these run row by row
+    expect("x == nil matches row by row",
+        mismatches("x == nil") == 0);
+    expect("!nil == (x > y) matches",
+        mismatches("!nil == (x > y)") == 0);
+    expect("(x > y) == !nil matches, nil after the inputs",
+        mismatches("(x > y) == !nil") == 0);
+    expect("\"a\" == \"a\" == (x < y) matches",
+        mismatches("\"a\" == \"a\" == (x < y)") == 0);
+
+    // a nil result, not just a nil along the way
+    Program* program = compileProgram("nil", names, 2);
+    Value* results = malloc(sizeof(Value) * ROWS);
+    bool allNil = runProgramBatch(program, columns, ROWS, results) ==
+        INTERPRET_OK;
+    for (int r = 0; r < ROWS; r++)
+        allNil = allNil && IS_NIL(results[r]);
+    expect("nil gives nil in every row", allNil);
+    free(results);
+    freeProgram(program);
+}
+
+void test_object_results(void) {
+    Program* program = compileProgram("\"x\" + \"y\"", names, 2);
+    Value* results = malloc(sizeof(Value) * ROWS);
+    int stackCount = vm.count;
+
+    // what one row's result takes, w/ nothing else allocated
+    Value inputs[] = {NUMBER_VAL(0), NUMBER_VAL(0)};
+    Value result;
+    size_t before = getMemStats().bytes;
+    runProgram(program, inputs, &result);
+    size_t perRow = getMemStats().bytes - before;
+
+    // the batch's scratch comes first, a slot of lanes per byte of...
+    // ... code (a little over, to cover the slots' tags), then a...
+    // ... cycle starts ten rows in and goes on one object per slice,...
+    // ... so those first results, born before it, are only held by...
+    // ... the VM's stack while it marks and sweeps
+    size_t scratch = program -> chunk.count *
+        (BATCH_LANES + 4) * sizeof(double);
+    vm.gcSliceBudget = 1;
+    vm.nextGC = getMemStats().bytes + scratch + 10 * perRow;
+
+    expect("\"x\" + \"y\" runs",
+        runProgramBatch(program, columns, ROWS, results) == INTERPRET_OK);
+    expect("... through a whole cycle", vm.gcPhase == GC_IDLE &&
+        vm.nextGC > getMemStats().bytes);
+
+    // every row makes its own string, so a result that was swept...
+    // ... shows up as an address a later row's string reused
+    Obj* objects[ROWS];
+    bool live = true;
+    for (int r = 0; r < ROWS; r++) {
+        live = live && IS_OBJ(results[r]) && isLive(AS_OBJ(results[r]));
+        objects[r] = IS_OBJ(results[r]) ? AS_OBJ(results[r]) : NULL;
+    }
+    qsort(objects, ROWS, sizeof(Obj*), compareAddresses);
+    for (int r = 1; r < ROWS; r++)
+        live = live && objects[r] != objects[r - 1];
+    expect("... and every result is still live after it", live);
+
+    bool strings = live;
+    for (int r = 0; r < ROWS && strings; r++)
+        strings = IS_STRING(results[r]) &&
+            AS_STRING(results[r]) -> length == 2 &&
+            memcmp(AS_STRING(results[r]) -> chars, "xy", 2) == 0;
+    expect("... giving \"xy\" in every row", strings);
+    expect("... and the stack's as it was", vm.count == stackCount);
+
+    vm.gcSliceBudget = GC_DEFAULT_SLICE_BUDGET;
+    while (gcStep())
+        ;
+
+    free(results);
+    freeProgram(program);
+}
+
+void test_errors(void) {
+    Value* results = malloc(sizeof(Value) * ROWS);
+    int stackCount = vm.count;
+
+    Program* program = compileProgram("x + \"s\"", names, 2);
+    expect("x + \"s\" is a runtime error",
+        runProgramBatch(program, columns, ROWS, results) ==
+        INTERPRET_RUNTIME_ERROR);
+    expect("... leaving the stack empty", vm.count == 0);
+    freeProgram(program);
+
+    program = compileProgram("-(x > y)", names, 2);
+    expect("-(x > y), a type error in lanes, is one too",
+        runProgramBatch(program, columns, ROWS, results) ==
+        INTERPRET_RUNTIME_ERROR);
+    freeProgram(program);
+
+    expect("a batch after them still matches",
+        mismatches("x * y") == 0 && vm.count == stackCount);
+    free(results);
+}
+
+int main(void) {
+    initVM();
+
+    for (int r = 0; r < ROWS; r++) {
+        xs[r] = r % 17 - 8;
+        ys[r] = (r * 7) % 13 - 6;
+    }
+
+    printf("test_batched:\n");
+    test_batched();
+    printf("\n");
+
+    printf("test_fallback:\n");
+    test_fallback();
+    printf("\n");
+
+    printf("test_object_results:\n");
+    test_object_results();
+    printf("\n");
+
+    printf("test_errors:\n");
+    test_errors();
+
+    freeVM();
+    return failures == 0 ? 0 : 1;
+}
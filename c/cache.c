@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "cache.h"
+#include "memory.h"
+
+// a cached program and the source it was compiled from
+typedef struct CacheEntry {
+    uint32_t hash;
+    int length;
+    char* src;
+    Program* program;
+    size_t bytes;
+
+    // recency list, most recently used first
+    struct CacheEntry* newer;
+    struct CacheEntry* older;
+
+    // next entry in the same bucket
+    struct CacheEntry* chain;
+} CacheEntry;
+
+typedef struct {
+    CacheEntry** buckets;
+    int bucketCount;    // a power of two, or 0 before the first insert
+
+    CacheEntry* newest;
+    CacheEntry* oldest;
+
+    ChunkCacheStats stats;
+} ChunkCache;
+
+static ChunkCache cache;
+
+// FNV-1a
+static uint32_t hashSource(const char* src, int length) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        hash ^= (uint8_t)src[i];
+        hash *= 16777619;
+    }
+    return hash;
+}
+
+// what an entry keeps alive outside the collected heap
+static size_t entryBytes(CacheEntry* entry) {
+    Chunk* chunk = &entry -> program -> chunk;
+
+    return sizeof(CacheEntry) + entry -> length + 1 + sizeof(Program) +
+        chunk -> capacity +
+        chunk -> rle_lines.capacity * 2 * sizeof(int) +
+        chunk -> constants.capacity * sizeof(Value);
+}
+
+void initChunkCache(void) {
+    // the buckets are allocated on the first insert, so an...
+    // ... unused cache costs nothing
+    cache.buckets = NULL;
+    cache.bucketCount = 0;
+    cache.newest = NULL;
+    cache.oldest = NULL;
+
+    cache.stats = (ChunkCacheStats){0};
+    cache.stats.budget = CHUNK_CACHE_DEFAULT_BUDGET;
+}
+
+static void unlinkRecent(CacheEntry* entry) {
+    if (entry -> newer != NULL)
+        entry -> newer -> older = entry -> older;
+    else
+        cache.newest = entry -> older;
+
+    if (entry -> older != NULL)
+        entry -> older -> newer = entry -> newer;
+    else
+        cache.oldest = entry -> newer;
+}
+
+static void linkNewest(CacheEntry* entry) {
+    entry -> newer = NULL;
+    entry -> older = cache.newest;
+
+    if (cache.newest != NULL)
+        cache.newest -> newer = entry;
+    else
+        cache.oldest = entry;
+
+    cache.newest = entry;
+}
+
+static void freeEntry(CacheEntry* entry) {
+    freeProgram(entry -> program);
+    FREE_ARRAY(char, entry -> src, entry -> length + 1, MEM_CACHE);
+    FREE(CacheEntry, entry, MEM_CACHE);
+}
+
+static void evict(CacheEntry* entry) {
+    CacheEntry** link = &cache.buckets[entry -> hash &
+        (cache.bucketCount - 1)];
+    while (*link != entry)
+        link = &(*link) -> chain;
+    *link = entry -> chain;
+
+    unlinkRecent(entry);
+
+    cache.stats.bytes -= entry -> bytes;
+    cache.stats.count--;
+    cache.stats.evictions++;
+
+    freeEntry(entry);
+}
+
+// evicts from the old end, but never `keep`
+static void evictOverBudget(CacheEntry* keep) {
+    while (cache.stats.bytes > cache.stats.budget &&
+            cache.oldest != NULL && cache.oldest != keep)
+        evict(cache.oldest);
+}
+
+void freeChunkCache(void) {
+    CacheEntry* entry = cache.newest;
+    while (entry != NULL) {
+        CacheEntry* older = entry -> older;
+        freeEntry(entry);
+        entry = older;
+    }
+
+    FREE_ARRAY(CacheEntry*, cache.buckets, cache.bucketCount, MEM_CACHE);
+    cache.buckets = NULL;
+    cache.bucketCount = 0;
+    cache.newest = NULL;
+    cache.oldest = NULL;
+
+    // the counters stay for whoever reports them at exit
+    cache.stats.bytes = 0;
+    cache.stats.count = 0;
+}
+
+void setChunkCacheBudget(size_t budget) {
+    cache.stats.budget = budget;
+    evictOverBudget(NULL);
+}
+
+// doubles the buckets and rehashes every entry into them
+static void growBuckets(void) {
+    int oldCount = cache.bucketCount;
+    CacheEntry** oldBuckets = cache.buckets;
+
+    cache.bucketCount = GROW_CAPACITY(oldCount);
+    cache.buckets = ALLOCATE(CacheEntry*, cache.bucketCount, MEM_CACHE);
+    for (int i = 0; i < cache.bucketCount; i++)
+        cache.buckets[i] = NULL;
+
+    for (int i = 0; i < oldCount; i++) {
+        CacheEntry* entry = oldBuckets[i];
+        while (entry != NULL) {
+            CacheEntry* next = entry -> chain;
+            CacheEntry** bucket = &cache.buckets[entry -> hash &
+                (cache.bucketCount - 1)];
+            entry -> chain = *bucket;
+            *bucket = entry;
+            entry = next;
+        }
+    }
+
+    FREE_ARRAY(CacheEntry*, oldBuckets, oldCount, MEM_CACHE);
+}
+
+Program* cachedProgram(const char* src) {
+    int length = (int)strlen(src);
+    uint32_t hash = hashSource(src, length);
+
+    if (cache.bucketCount > 0) {
+        CacheEntry* entry = cache.buckets[hash & (cache.bucketCount - 1)];
+        for (; entry != NULL; entry = entry -> chain) {
+            if (entry -> hash == hash && entry -> length == length &&
+                    memcmp(entry -> src, src, length) == 0) {
+                cache.stats.hits++;
+                unlinkRecent(entry);
+                linkNewest(entry);
+                return entry -> program;
+            }
+        }
+    }
+
+    cache.stats.misses++;
+
+    // source that doesn't compile isn't cached, it'd only...
+    // ... report its errors again
+    Program* program = compileProgram(src, NULL, 0);
+    if (program == NULL)
+        return NULL;
+
+    // kept at a load factor of 3/4 or less
+    if (cache.stats.count + 1 > cache.bucketCount * 3 / 4)
+        growBuckets();
+
+    CacheEntry* entry = ALLOCATE(CacheEntry, 1, MEM_CACHE);
+    entry -> hash = hash;
+    entry -> length = length;
+    entry -> src = ALLOCATE(char, length + 1, MEM_CACHE);
+    memcpy(entry -> src, src, length + 1);
+    entry -> program = program;
+    entry -> bytes = entryBytes(entry);
+
+    CacheEntry** bucket = &cache.buckets[hash & (cache.bucketCount - 1)];
+    entry -> chain = *bucket;
+    *bucket = entry;
+    linkNewest(entry);
+
+    cache.stats.bytes += entry -> bytes;
+    cache.stats.count++;
+
+    evictOverBudget(entry);
+    return program;
+}
+
+ChunkCacheStats getChunkCacheStats(void) {
+    return cache.stats;
+}
+
+void printChunkCacheStats(void) {
+    ChunkCacheStats stats = cache.stats;
+    size_t lookups = stats.hits + stats.misses;
+
+    fprintf(stderr, "==chunk-cache==\n");
+    fprintf(stderr, "%zu hits, %zu misses (%.1f%% hit), %zu evictions\n",
+        stats.hits, stats.misses,
+        lookups == 0 ? 0.0 : 100.0 * stats.hits / lookups,
+        stats.evictions);
+    fprintf(stderr, "%d programs in %zu of %zu bytes\n", stats.count,
+        stats.bytes, stats.budget);
+}
@@ -0,0 +1,39 @@
+#ifndef clox_cache_h
+#define clox_cache_h
+
+#include "common.h"
+#include "vm.h"
+
+// bytes of compiled programs kept unless told otherwise
+#define CHUNK_CACHE_DEFAULT_BUDGET (1024 * 1024)
+
+typedef struct {
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    size_t bytes;       // what the cached programs take up
+    size_t budget;
+    int count;
+} ChunkCacheStats;
+
+// initializes the cache w/ the default budget
+void initChunkCache(void);
+
+// frees every cached program
+void freeChunkCache(void);
+
+// evicts least recently used programs until the rest fit
+void setChunkCacheBudget(size_t budget);
+
+// the compiled program for `src`, compiled only if it isn't...
+// ... cached already, NULL if it doesn't compile; the cache owns...
+// ... it, and it stays cached until it's the least recently used...
+// ... one over the budget (the one just returned never is)
+Program* cachedProgram(const char* src);
+
+ChunkCacheStats getChunkCacheStats(void);
+
+// reports the counters to stderr
+void printChunkCacheStats(void);
+
+#endif
@@ -0,0 +1,75 @@
+// compares the latency of a chunk cache hit against compiling...
+// ... the same short expression cold, as `interpret()` used to...
+// ... usage: cache_bench [repetitions]
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "common.h"
+#include "cache.h"
+#include "memory.h"
+#include "value.h"
+#include "vm.h"
+
+static const char* sources[] = {
+    "1 + 2",
+    "(1 + 2) * 3 - 4 / 5",
+    "!(1 < 2) == (3 > 4)",
+    "\"hello\" + \" \" + \"world\"",
+    "-(1.5 * 2.25) + 10 * (7 - 3) / 2 > 12.5 == !false",
+};
+
+static double nowNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void bench(const char* src, int reps) {
+    Value result;
+
+    // compiled from scratch every time...
+    double start = nowNanos();
+    for (int i = 0; i < reps; i++) {
+        Program* program = compileProgram(src, NULL, 0);
+        runProgram(program, NULL, &result);
+        freeProgram(program);
+    }
+    double coldTime = nowNanos() - start;
+
+    // ... and looked up in the cache, w/ the first time a miss
+    start = nowNanos();
+    for (int i = 0; i < reps; i++)
+        runProgram(cachedProgram(src), NULL, &result);
+    double cachedTime = nowNanos() - start;
+
+    printf("%-50s %10.1f %10.1f %8.2fx\n", src, coldTime / reps,
+        cachedTime / reps, coldTime / cachedTime);
+}
+
+int main(int argc, const char* argv[]) {
+    initVM();
+
+    int reps = argc > 1 ? atoi(argv[1]) : 200000;
+
+    printf("%-50s %10s %10s %9s\n", "source", "cold ns", "cached ns",
+        "speedup");
+    for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); i++)
+        bench(sources[i], reps);
+
+    ChunkCacheStats stats = getChunkCacheStats();
+    printf("\n%zu hits, %zu misses, %d programs in %zu bytes\n",
+        stats.hits, stats.misses, stats.count, stats.bytes);
+
+    // a budget w/ room for about two programs evicts the rest
+    setChunkCacheBudget(stats.bytes / stats.count * 2);
+    stats = getChunkCacheStats();
+    printf("budget %zu: %zu evictions, %d program(s) in %zu bytes\n",
+        stats.budget, stats.evictions, stats.count, stats.bytes);
+
+    freeVM();
+    return 0;
+}
@@ -0,0 +1,185 @@
+// tests of the chunk cache: it evicts the least recently used...
+// ... program first, keeps what it holds within its byte budget,...
+// ... never evicts the program it's just returned, and counts hits...
+// ... and misses the way lookups went
+
+#include <stdio.h>
+
+#include "common.h"
+#include "cache.h"
+#include "memory.h"
+#include "value.h"
+#include "vm.h"
+
+// same shape and no shared constants, so every one of them costs...
+// ... the cache the same number of bytes
+static const char* const A = "1 + 2";
+static const char* const B = "3 + 4";
+static const char* const C = "5 + 6";
+static const char* const D = "7 + 8";
+
+static int failures = 0;
+
+static void expect(const char* what, bool ok) {
+    printf("%-52s %s\n", what, ok ? "ok" : "<-- FAILED");
+
+    if (!ok)
+        failures++;
+}
+
+// looks `src` up, and says whether it was a hit
+static bool hit(const char* src) {
+    size_t hits = getChunkCacheStats().hits;
+    cachedProgram(src);
+    return getChunkCacheStats().hits == hits + 1;
+}
+
+// empties the cache, counters and all, w/ the default budget
+static void resetCache(void) {
+    freeChunkCache();
+    initChunkCache();
+}
+
+// what one of A, B, C or D costs
+static size_t entrySize(void) {
+    resetCache();
+    cachedProgram(A);
+    size_t bytes = getChunkCacheStats().bytes;
+    resetCache();
+    return bytes;
+}
+
+void test_counters(void) {
+    resetCache();
+
+    Program* first = cachedProgram(A);
+    ChunkCacheStats stats = getChunkCacheStats();
+    expect("a first lookup is a miss",
+        first != NULL && stats.misses == 1 && stats.hits == 0);
+    expect("... and caches the program", stats.count == 1);
+
+    Program* second = cachedProgram(A);
+    stats = getChunkCacheStats();
+    expect("a second lookup is a hit",
+        stats.misses == 1 && stats.hits == 1);
+    expect("... and returns the same program", second == first);
+
+    cachedProgram(B);
+    cachedProgram(B);
+    cachedProgram(A);
+    stats = getChunkCacheStats();
+    expect("3 hits, 2 misses, 2 programs after A A B B A",
+        stats.hits == 3 && stats.misses == 2 && stats.count == 2);
+
+    // source that doesn't compile misses every time, and isn't kept
+    expect("source that doesn't compile gives NULL",
+        cachedProgram("1 +") == NULL);
+    expect("... and misses again the next time", !hit("1 +"));
+    stats = getChunkCacheStats();
+    expect("... w/out being cached",
+        stats.misses == 4 && stats.count == 2 && stats.evictions == 0);
+}
+
+void test_lru_order(void) {
+    size_t size = entrySize();
+    setChunkCacheBudget(3 * size);
+
+    cachedProgram(A);
+    cachedProgram(B);
+    cachedProgram(C);
+    expect("three programs fit a budget of three",
+        getChunkCacheStats().count == 3 &&
+        getChunkCacheStats().evictions == 0);
+
+    // A's used again, so B's the least recently used now...
+    expect("A is still cached", hit(A));
+    cachedProgram(D);
+    ChunkCacheStats stats = getChunkCacheStats();
+    expect("a fourth evicts one", stats.evictions == 1 && stats.count == 3);
+
+    // ... from newest to oldest that's D A C, and putting B back...
+    // ... evicts C, the oldest by then, leaving B D A
+    expect("... and it was B, the least recently used", !hit(B));
+    expect("D and A are still cached", hit(D) && hit(A));
+    expect("... but C isn't", !hit(C));
+    expect("3 evictions in all", getChunkCacheStats().evictions == 3);
+}
+
+void test_byte_budget(void) {
+    size_t size = entrySize();
+    setChunkCacheBudget(2 * size + size / 2);
+
+    const char* sources[] = {A, B, C, D, A, C};
+    bool within = true;
+    for (int i = 0; i < 6; i++) {
+        cachedProgram(sources[i]);
+        within = within && getChunkCacheStats().bytes <=
+            getChunkCacheStats().budget;
+    }
+    ChunkCacheStats stats = getChunkCacheStats();
+    expect("it stays within a budget of 2.5 programs", within);
+    expect("... holding two of them",
+        stats.count == 2 && stats.bytes == 2 * size);
+
+    // a smaller budget evicts right away, not on the next insert
+    setChunkCacheBudget(size);
+    stats = getChunkCacheStats();
+    expect("lowering the budget evicts down to it",
+        stats.count == 1 && stats.bytes == size);
+    expect("... keeping the most recently used", hit(C));
+
+    setChunkCacheBudget(0);
+    stats = getChunkCacheStats();
+    expect("a budget of 0 evicts everything",
+        stats.count == 0 && stats.bytes == 0);
+}
+
+void test_keeps_newest(void) {
+    resetCache();
+    setChunkCacheBudget(1);
+
+    Program* program = cachedProgram(A);
+    ChunkCacheStats stats = getChunkCacheStats();
+    expect("a program bigger than the budget is still returned",
+        program != NULL);
+    expect("... and stays cached over the budget",
+        stats.count == 1 && stats.bytes > stats.budget);
+
+    Value result;
+    expect("... and runs",
+        runProgram(program, NULL, &result) == INTERPRET_OK &&
+        IS_NUMBER(result) && AS_NUMBER(result) == 3);
+    expect("... and is a hit next time", hit(A));
+
+    // the next one in evicts it, but not itself
+    program = cachedProgram(B);
+    stats = getChunkCacheStats();
+    expect("the next miss evicts it, not the new one",
+        program != NULL && stats.count == 1 && stats.evictions == 1);
+    expect("... which runs",
+        runProgram(program, NULL, &result) == INTERPRET_OK &&
+        IS_NUMBER(result) && AS_NUMBER(result) == 7);
+    expect("... and stays cached", hit(B));
+}
+
+int main(void) {
+    initVM();
+
+    printf("test_counters:\n");
+    test_counters();
+    printf("\n");
+
+    printf("test_lru_order:\n");
+    test_lru_order();
+    printf("\n");
+
+    printf("test_byte_budget:\n");
+    test_byte_budget();
+    printf("\n");
+
+    printf("test_keeps_newest:\n");
+    test_keeps_newest();
+
+    freeVM();
+    return failures == 0 ? 0 : 1;
+}
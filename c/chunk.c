@@ -2,6 +2,7 @@
 
 #include "chunk.h"
 #include "memory.h"
+#include "operand.h"
 
 // initializes a chunk
 void initChunk(Chunk* chunk) {
@@ -23,7 +24,7 @@ void writeChunk(Chunk* chunk, uint8_t byte, int line) {
         int oldCapacity = chunk -> capacity;
         chunk -> capacity = GROW_CAPACITY(oldCapacity);
         chunk -> code = GROW_ARRAY(uint8_t, chunk -> code,
-            oldCapacity, chunk -> capacity);
+            oldCapacity, chunk -> capacity, MEM_CHUNK_CODE);
         // chunk -> code = NEW_GROW_ARRAY(uint8_t, chunk -> code,
         //     chunk -> capacity);
     }
@@ -40,7 +41,8 @@ void writeChunk(Chunk* chunk, uint8_t byte, int line) {
 // frees the chunk
 void freeChunk(Chunk* chunk) {
     // frees code
-    FREE_ARRAY(uint8_t, chunk -> code, chunk -> capacity);
+    FREE_ARRAY(uint8_t, chunk -> code, chunk -> capacity,
+        MEM_CHUNK_CODE);
     // NEW_FREE_ARRAY(chunk -> code);
 
     // frees lines
@@ -61,13 +63,26 @@ int getLine(Chunk* chunk, int offset) {
 // adds a constant to the constant pool...
 // ... and returns its index
 int addConstant(Chunk* chunk, Value value) {
+    // constants are roots, so the collector has to hear...
+    // ... about ones added in the middle of a cycle; stored...
+    // ... first, since growing the pool can start one
     writeValueArray(&chunk -> constants, value);
+    writeBarrier(chunk -> constants.values[chunk -> constants.count - 1]);
     
     // return index where constant was appended...
     // ... to locate later
     return chunk -> constants.count - 1;
 }
 
+// appends a variable-length operand to the chunk
+void writeOperand(Chunk* chunk, uint32_t operand, int line) {
+    uint8_t buffer[OPERAND_MAX_BYTES];
+    int length = encodeOperand(operand, buffer);
+
+    for (int i = 0; i < length; i++)
+        writeChunk(chunk, buffer[i], line);
+}
+
 // writes an appropriate constant opcode to the chunk...
 // ... and the value's index appropriately
 void writeConstant(Chunk* chunk, Value value, int line) {
@@ -82,19 +97,10 @@ void writeConstant(Chunk* chunk, Value value, int line) {
         writeChunk(chunk, valueIndex, line);
     }
 
-    // writing an OP_CONSTANT_LONG
-    else if (valueIndex >= 256) {
-        // we know the index, which needs to be split...
-        // ... into three bytes
-        int first_byte = (valueIndex & (255 << 16)) >> 16;
-        int second_byte = (valueIndex & (255 << 8)) >> 8;
-        int third_byte = valueIndex & 255;
-
-        // write the opcode and split up valueIndex
+    // writing an OP_CONSTANT_LONG w/ the index as a...
+    // ... variable-length operand (two bytes up to 16383)
+    else {
         writeChunk(chunk, OP_CONSTANT_LONG, line);
-        writeChunk(chunk, first_byte, line);
-        writeChunk(chunk, second_byte, line);
-        writeChunk(chunk, third_byte, line);
+        writeOperand(chunk, (uint32_t)valueIndex, line);
     }
-
 }
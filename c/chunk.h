@@ -7,8 +7,8 @@
 
 // defines our one-byte opcodes (operation codes)
 typedef enum {
-    OP_CONSTANT,
-    OP_CONSTANT_LONG,
+    OP_CONSTANT,        // 1-byte constant index
+    OP_CONSTANT_LONG,   // variable-length constant index
     OP_NIL,
     OP_TRUE,
     OP_FALSE,
@@ -21,6 +21,9 @@ typedef enum {
     OP_DIVIDE,
     OP_NOT,
     OP_NEGATE,
+    OP_GET_INPUT,       // variable-length input index
+    OP_GET_LOCAL,       // variable-length slot index
+    OP_SET_LOCAL,       // variable-length slot index
     OP_RETURN
 } OpCode;
 
@@ -54,7 +57,11 @@ int getLine(Chunk* chunk, int offset);
 // ... and returns its index
 int addConstant(Chunk* chunk, Value value);
 
-// writes an OP_CONSTANT_LONG to the chunk
+// appends a variable-length operand to the chunk, see operand.h
+void writeOperand(Chunk* chunk, uint32_t operand, int line);
+
+// writes an OP_CONSTANT, or an OP_CONSTANT_LONG if the...
+// ... index doesn't fit in a byte, to the chunk
 void writeConstant(Chunk* chunk, Value value, int line);
 
 #endif
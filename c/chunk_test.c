@@ -1,12 +1,17 @@
+#include <stdio.h>
+
 #include "common.h"
 #include "chunk.h"
 #include "debug.h"
+#include "operand.h"
+
+static int failures = 0;
 
 void test_writing_easy1(void) {
     Chunk chunk;
     initChunk(&chunk);
 
-    int constant = addConstant(&chunk, 1.2);
+    int constant = addConstant(&chunk, NUMBER_VAL(1.2));
     writeChunk(&chunk, OP_CONSTANT, 123);
     writeChunk(&chunk, constant, 123);
 
@@ -20,11 +25,11 @@ void test_writing_easy2(void) {
     Chunk chunk;
     initChunk(&chunk);
 
-    int constant = addConstant(&chunk, 1.2);
+    int constant = addConstant(&chunk, NUMBER_VAL(1.2));
     writeChunk(&chunk, OP_CONSTANT, 123);
     writeChunk(&chunk, constant, 123);
 
-    constant = addConstant(&chunk, 1.3);
+    constant = addConstant(&chunk, NUMBER_VAL(1.3));
     writeChunk(&chunk, OP_CONSTANT, 124);
     writeChunk(&chunk, constant, 124);
 
@@ -39,14 +44,41 @@ void test_writing_medium_n(int n) {
     initChunk(&chunk);
 
     for(int i = 0; i < n; i++)
-        writeConstant(&chunk, (i + 1) * .3, i + 1);
+        writeConstant(&chunk, NUMBER_VAL((i + 1) * .3), i + 1);
 
     disassembleChunk(&chunk, "test-writing-medium_n");
     freeChunk(&chunk);
 }
 
+void test_operand_round_trip(void) {
+    uint32_t operands[] = {
+        0, 1, 127, 128, 255, 256, 16383, 16384,
+        (1 << 21) - 1, 1 << 21, (1 << 24) + 5, UINT32_MAX
+    };
+    int count = (int)(sizeof(operands) / sizeof(operands[0]));
+
+    for (int i = 0; i < count; i++) {
+        uint8_t buffer[OPERAND_MAX_BYTES];
+        int length = encodeOperand(operands[i], buffer);
+
+        uint8_t* ip = buffer;
+        uint32_t decoded = decodeOperand(&ip);
+
+        bool ok = decoded == operands[i] && ip - buffer == length &&
+            length == operandLength(operands[i]);
+        printf("%10u -> %d byte(s) -> %10u%s\n", operands[i], length,
+            decoded, ok ? "" : "  <-- FAILED");
+
+        if (!ok)
+            failures++;
+    }
+}
+
 int main(void) {
     test_writing_medium_n((1 << 8) | 1);
 
-    return 0;
+    printf("\ntest_operand_round_trip:\n");
+    test_operand_round_trip();
+
+    return failures == 0 ? 0 : 1;
 }
@@ -1,11 +1,18 @@
 #ifndef clox_common_h
 #define clox_common_h
 
+// building w/ -DNDEBUG leaves out the diagnostic output...
+// ... below, which is what the benchmarks want
+#ifndef NDEBUG
 // dumps chunk
 #define DEBUG_PRINT_CODE
 
 // diagnostic logging for the VM
 #define DEBUG_TRACE_EXECUTION
+#endif
+
+// logs the collector's cycles
+// #define DEBUG_LOG_GC
 
 #include <stdbool.h>	// Boolean bools
 #include <stddef.h>	// NULL, size_t
@@ -1,8 +1,11 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "common.h"
+#include "atod.h"
 #include "compiler.h"
+#include "ir.h"
 #include "scanner.h"
 
 #ifdef DEBUG_PRINT_CODE
@@ -49,6 +52,14 @@ Parser parser;
 
 Chunk* compilingChunk;
 
+// the names identifiers can refer to, see compileWithInputs()
+static const char* const* inputNames = NULL;
+static int inputCount = 0;
+
+// whether expressions go through the IR, and the one being built
+static bool irEnabled = false;
+static Ir ir;
+
 static Chunk* currentChunk(void) {
     return compilingChunk;
 }
@@ -122,8 +133,20 @@ static void consume(TokenType type, const char* msg) {
     errorAtCurrent(msg);
 }
 
-// appends a single byte to the chunk
+void setCompilerIr(bool enabled) {
+    irEnabled = enabled;
+}
+
+// appends a single byte to the chunk...
+// ... or, building IR, the node for the opcode `byte` is
 static void emitByte(uint8_t byte) {
+    if (irEnabled) {
+        // an operand the error left out would be missing
+        if (!parser.hadError)
+            irEmit(&ir, (OpCode)byte, parser.previous.line);
+        return;
+    }
+
     writeChunk(currentChunk(), byte, parser.previous.line);
 }
 
@@ -136,29 +159,43 @@ static void emitReturn(void) {
     emitByte(OP_RETURN);
 }
 
-// TODO: be able to return "uint24_t"
-static uint8_t makeConstant(Value value) {
-    // adds the given value to the end of the chunk's...
-    // ... constant table and returns its index
-    int constant_index = addConstant(currentChunk(), value);
-
-    // TODO: change to "UINT24_MAX"
-    // handles bounds checking for constant index...
-    // ... can only handle up to 256 constants in a chunk
-    if (constant_index > UINT8_MAX) {
-        error("too many constants in one chunk");
-        return 0;
+// adds the given value to the end of the chunk's constant...
+// ... table and loads it w/ an OP_CONSTANT or, past 256...
+// ... constants, an OP_CONSTANT_LONG
+static void emitConstant(Value value) {
+    if (irEnabled) {
+        // the constant pool is where a cycle finds a string, until...
+        // ... lowering replaces it w/ the constants still used
+        if (IS_OBJ(value))
+            addConstant(currentChunk(), value);
+
+        if (!parser.hadError)
+            irEmitConstant(&ir, value, parser.previous.line);
+        return;
     }
 
-    return (uint8_t)constant_index;
+    writeConstant(currentChunk(), value, parser.previous.line);
 }
 
-static void emitConstant(Value value) {
-    emitBytes(OP_CONSTANT, makeConstant(value));
+static void emitInput(uint32_t input) {
+    if (irEnabled) {
+        if (!parser.hadError)
+            irEmitInput(&ir, input, parser.previous.line);
+        return;
+    }
+
+    emitByte(OP_GET_INPUT);
+    writeOperand(currentChunk(), input, parser.previous.line);
 }
 
 static void endCompiler(void) {
-    emitReturn();
+    if (irEnabled) {
+        if (!parser.hadError)
+            lowerIr(&ir, currentChunk());
+        freeIr(&ir);
+    } else {
+        emitReturn();
+    }
 
     #ifdef DEBUG_PRINT_CODE
     if (!parser.hadError)
@@ -246,9 +283,11 @@ static void grouping(void) {
 }
 
 static void number(void) {
-    // take number literal and use C std library...
-    // ... to convert it a double value
-    double value = strtod(parser.previous.start, NULL);
+    // convert the number literal to a double value...
+    // ... w/out `strtod()`, which is slow on short...
+    // ... literals, see atod.c
+    double value = parseNumber(parser.previous.start,
+                               parser.previous.length);
 
     // generate code to load the value...
     // ... and wrap in a Value before storing...
@@ -264,6 +303,26 @@ static void string(void) {
                                     parser.previous.length - 2)));
 }
 
+// an input's name: emits a load of it by index
+static void variable(void) {
+    // plain compile() has no names to refer to
+    if (inputNames == NULL) {
+        error("expected expression");
+        return;
+    }
+
+    for (int i = 0; i < inputCount; i++) {
+        if (strlen(inputNames[i]) == (size_t)parser.previous.length &&
+                memcmp(inputNames[i], parser.previous.start,
+                    parser.previous.length) == 0) {
+            emitInput((uint32_t)i);
+            return;
+        }
+    }
+
+    error("undefined input");
+}
+
 static void unary(void) {
     TokenType operatorType = parser.previous.type;
 
@@ -307,7 +366,7 @@ ParseRule rules[] = {
     [TOKEN_GREATER_EQUAL] = {NULL,     binary, PREC_COMPARISON},
     [TOKEN_LESS]          = {NULL,     binary, PREC_COMPARISON},
     [TOKEN_LESS_EQUAL]    = {NULL,     binary, PREC_COMPARISON},
-    [TOKEN_IDENTIFIER]    = {NULL,     NULL,   PREC_NONE},
+    [TOKEN_IDENTIFIER]    = {variable, NULL,   PREC_NONE},
     [TOKEN_STRING]        = {string,   NULL,   PREC_NONE},
     [TOKEN_NUMBER]        = {number,   NULL,   PREC_NONE},
     [TOKEN_AND]           = {NULL,     NULL,   PREC_NONE},
@@ -366,11 +425,22 @@ static void expression(void) {
 }
 
 bool compile(const char* src, Chunk* chunk) {
+    return compileWithInputs(src, chunk, NULL, 0);
+}
+
+bool compileWithInputs(const char* src, Chunk* chunk,
+                       const char* const* names, int count) {
     initScanner(src);
 
+    inputNames = names;
+    inputCount = count;
+
     // initalizing module variable attached to Chunk of code
     compilingChunk = chunk;
 
+    if (irEnabled)
+        initIr(&ir);
+
     // initializing parser fields
     parser.hadError = false;
     parser.panicMode = false;
@@ -386,5 +456,8 @@ bool compile(const char* src, Chunk* chunk) {
 
     endCompiler();
 
+    inputNames = NULL;
+    inputCount = 0;
+
     return !parser.hadError;
 }
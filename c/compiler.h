@@ -6,4 +6,14 @@
 
 bool compile(const char* src, Chunk* chunk);
 
+// like compile(), but an identifier in the expression names...
+// ... an input, read w/ OP_GET_INPUT by its index in `inputNames`
+bool compileWithInputs(const char* src, Chunk* chunk,
+                       const char* const* inputNames, int inputCount);
+
+// w/ it on, expressions are built as IR, optimized and lowered...
+// ... to bytecode at the end instead of emitted as they're parsed,...
+// ... see ir.h
+void setCompilerIr(bool enabled);
+
 #endif
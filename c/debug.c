@@ -1,6 +1,7 @@
 #include <stdio.h>
 
 #include "debug.h"
+#include "operand.h"
 #include "value.h"
 
 void disassembleChunk(Chunk* chunk, const char* name) {
@@ -32,25 +33,29 @@ static int constantInstruction(const char* name, Chunk* chunk,
 
 static int constantLongInstruction(const char* name, Chunk* chunk,
                                int offset) {
-    // grab the constant index
-    uint8_t first_byte_constant_index = chunk -> code[offset + 1];
-    uint8_t second_byte_constant_index = chunk -> code[offset + 2];
-    uint8_t third_byte_constant_index = chunk -> code[offset + 3];
-
-    int constant_index = (first_byte_constant_index << 16) |
-                         (second_byte_constant_index << 8) |
-                         (third_byte_constant_index);
+    // grab the variable-length constant index
+    uint8_t* operand = &chunk -> code[offset + 1];
+    uint32_t constant_index = decodeOperand(&operand);
 
     // print out the name of the opcode and constant index
-    printf("%-16s %4d '", name, constant_index);
+    printf("%-16s %4u '", name, constant_index);
 
     // look up the actual constant value
     printValue(chunk -> constants.values[constant_index]);
 
     printf("'\n");
 
-    // skips past opcode and three bytes
-    return offset + 4;
+    // skips past opcode and however many bytes the index took
+    return (int)(operand - chunk -> code);
+}
+
+// an input or a slot, by its variable-length index
+static int operandInstruction(const char* name, Chunk* chunk, int offset) {
+    uint8_t* operand = &chunk -> code[offset + 1];
+    uint32_t index = decodeOperand(&operand);
+
+    printf("%-16s %4u\n", name, index);
+    return (int)(operand - chunk -> code);
 }
 
 static int simpleInstruction(const char* name, int offset) {
@@ -104,6 +109,12 @@ int disassembleInstructionWithRLE(Chunk* chunk, int offset) {
             return simpleInstruction("OP_NOT", offset);
         case OP_NEGATE:
             return simpleInstruction("OP_NEGATE", offset);
+        case OP_GET_INPUT:
+            return operandInstruction("OP_GET_INPUT", chunk, offset);
+        case OP_GET_LOCAL:
+            return operandInstruction("OP_GET_LOCAL", chunk, offset);
+        case OP_SET_LOCAL:
+            return operandInstruction("OP_SET_LOCAL", chunk, offset);
         case OP_RETURN:
             return simpleInstruction("OP_RETURN", offset);
         default:
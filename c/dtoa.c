@@ -0,0 +1,433 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dtoa.h"
+
+// Grisu3 (Loitsch, "Printing Floating-Point Numbers Quickly and...
+// ... Accurately w/ Integers"): the digits come out of 64-bit...
+// ... integer arithmetic on the double scaled by a cached power...
+// ... of ten; about 99.5% of doubles are proven shortest that way...
+// ... and the rest go the slow way, through snprintf() and strtod()
+
+// the most digits Grisu3 produces before giving up
+#define GRISU_MAX_DIGITS 18
+
+// a float w/ a 64-bit significand: f * 2^e
+typedef struct {
+    uint64_t f;
+    int e;
+} DiyFp;
+
+typedef struct {
+    uint64_t f;
+    int e;
+    int decimalExponent;
+} CachedPower;
+
+// 10^k for every eighth k from -348 to 340, rounded to 64 bits
+static const CachedPower cachedPowers[] = {
+    {0xfa8fd5a0081c0288ull, -1220, -348},
+    {0xbaaee17fa23ebf76ull, -1193, -340},
+    {0x8b16fb203055ac76ull, -1166, -332},
+    {0xcf42894a5dce35eaull, -1140, -324},
+    {0x9a6bb0aa55653b2dull, -1113, -316},
+    {0xe61acf033d1a45dfull, -1087, -308},
+    {0xab70fe17c79ac6caull, -1060, -300},
+    {0xff77b1fcbebcdc4full, -1034, -292},
+    {0xbe5691ef416bd60cull, -1007, -284},
+    {0x8dd01fad907ffc3cull,  -980, -276},
+    {0xd3515c2831559a83ull,  -954, -268},
+    {0x9d71ac8fada6c9b5ull,  -927, -260},
+    {0xea9c227723ee8bcbull,  -901, -252},
+    {0xaecc49914078536dull,  -874, -244},
+    {0x823c12795db6ce57ull,  -847, -236},
+    {0xc21094364dfb5637ull,  -821, -228},
+    {0x9096ea6f3848984full,  -794, -220},
+    {0xd77485cb25823ac7ull,  -768, -212},
+    {0xa086cfcd97bf97f4ull,  -741, -204},
+    {0xef340a98172aace5ull,  -715, -196},
+    {0xb23867fb2a35b28eull,  -688, -188},
+    {0x84c8d4dfd2c63f3bull,  -661, -180},
+    {0xc5dd44271ad3cdbaull,  -635, -172},
+    {0x936b9fcebb25c996ull,  -608, -164},
+    {0xdbac6c247d62a584ull,  -582, -156},
+    {0xa3ab66580d5fdaf6ull,  -555, -148},
+    {0xf3e2f893dec3f126ull,  -529, -140},
+    {0xb5b5ada8aaff80b8ull,  -502, -132},
+    {0x87625f056c7c4a8bull,  -475, -124},
+    {0xc9bcff6034c13053ull,  -449, -116},
+    {0x964e858c91ba2655ull,  -422, -108},
+    {0xdff9772470297ebdull,  -396, -100},
+    {0xa6dfbd9fb8e5b88full,  -369,  -92},
+    {0xf8a95fcf88747d94ull,  -343,  -84},
+    {0xb94470938fa89bcfull,  -316,  -76},
+    {0x8a08f0f8bf0f156bull,  -289,  -68},
+    {0xcdb02555653131b6ull,  -263,  -60},
+    {0x993fe2c6d07b7facull,  -236,  -52},
+    {0xe45c10c42a2b3b06ull,  -210,  -44},
+    {0xaa242499697392d3ull,  -183,  -36},
+    {0xfd87b5f28300ca0eull,  -157,  -28},
+    {0xbce5086492111aebull,  -130,  -20},
+    {0x8cbccc096f5088ccull,  -103,  -12},
+    {0xd1b71758e219652cull,   -77,   -4},
+    {0x9c40000000000000ull,   -50,    4},
+    {0xe8d4a51000000000ull,   -24,   12},
+    {0xad78ebc5ac620000ull,     3,   20},
+    {0x813f3978f8940984ull,    30,   28},
+    {0xc097ce7bc90715b3ull,    56,   36},
+    {0x8f7e32ce7bea5c70ull,    83,   44},
+    {0xd5d238a4abe98068ull,   109,   52},
+    {0x9f4f2726179a2245ull,   136,   60},
+    {0xed63a231d4c4fb27ull,   162,   68},
+    {0xb0de65388cc8ada8ull,   189,   76},
+    {0x83c7088e1aab65dbull,   216,   84},
+    {0xc45d1df942711d9aull,   242,   92},
+    {0x924d692ca61be758ull,   269,  100},
+    {0xda01ee641a708deaull,   295,  108},
+    {0xa26da3999aef774aull,   322,  116},
+    {0xf209787bb47d6b85ull,   348,  124},
+    {0xb454e4a179dd1877ull,   375,  132},
+    {0x865b86925b9bc5c2ull,   402,  140},
+    {0xc83553c5c8965d3dull,   428,  148},
+    {0x952ab45cfa97a0b3ull,   455,  156},
+    {0xde469fbd99a05fe3ull,   481,  164},
+    {0xa59bc234db398c25ull,   508,  172},
+    {0xf6c69a72a3989f5cull,   534,  180},
+    {0xb7dcbf5354e9beceull,   561,  188},
+    {0x88fcf317f22241e2ull,   588,  196},
+    {0xcc20ce9bd35c78a5ull,   614,  204},
+    {0x98165af37b2153dfull,   641,  212},
+    {0xe2a0b5dc971f303aull,   667,  220},
+    {0xa8d9d1535ce3b396ull,   694,  228},
+    {0xfb9b7cd9a4a7443cull,   720,  236},
+    {0xbb764c4ca7a44410ull,   747,  244},
+    {0x8bab8eefb6409c1aull,   774,  252},
+    {0xd01fef10a657842cull,   800,  260},
+    {0x9b10a4e5e9913129ull,   827,  268},
+    {0xe7109bfba19c0c9dull,   853,  276},
+    {0xac2820d9623bf429ull,   880,  284},
+    {0x80444b5e7aa7cf85ull,   907,  292},
+    {0xbf21e44003acdd2dull,   933,  300},
+    {0x8e679c2f5e44ff8full,   960,  308},
+    {0xd433179d9c8cb841ull,   986,  316},
+    {0x9e19db92b4e31ba9ull,  1013,  324},
+    {0xeb96bf6ebadf77d9ull,  1039,  332},
+    {0xaf87023b9bf0ee6bull,  1066,  340},
+};
+
+#define CACHED_POWERS_OFFSET 348
+#define DECIMAL_EXPONENT_DISTANCE 8
+
+// scaled digits have a binary exponent in this range, so the...
+// ... integer part fits in 32 bits
+#define MIN_TARGET_EXPONENT (-60)
+#define MAX_TARGET_EXPONENT (-32)
+
+#define SIGNIFICAND_MASK 0x000FFFFFFFFFFFFFull
+#define HIDDEN_BIT 0x0010000000000000ull
+#define EXPONENT_BIAS 1075
+#define DENORMAL_EXPONENT (-1074)
+
+static const uint32_t smallPowersOfTen[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+    1000000000
+};
+
+// the product's high 64 bits, rounded
+static DiyFp multiply(DiyFp x, DiyFp y) {
+    uint64_t a = x.f >> 32, b = x.f & 0xFFFFFFFF;
+    uint64_t c = y.f >> 32, d = y.f & 0xFFFFFFFF;
+
+    uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t middle = (bd >> 32) + (ad & 0xFFFFFFFF) + (bc & 0xFFFFFFFF) +
+        (1u << 31);
+
+    return (DiyFp){ac + (ad >> 32) + (bc >> 32) + (middle >> 32),
+        x.e + y.e + 64};
+}
+
+static DiyFp normalize(DiyFp x) {
+    #if defined(__GNUC__)
+    int shift = __builtin_clzll(x.f);
+    x.f <<= shift;
+    x.e -= shift;
+    #else
+    while ((x.f & (1ull << 63)) == 0) {
+        x.f <<= 1;
+        x.e--;
+    }
+    #endif
+    return x;
+}
+
+// `w` normalized, and the midpoints between it and its...
+// ... neighbours w/ the same exponent as it
+static void decompose(double number, DiyFp* w, DiyFp* minus, DiyFp* plus) {
+    uint64_t bits;
+    memcpy(&bits, &number, sizeof(bits));
+
+    uint64_t significand = bits & SIGNIFICAND_MASK;
+    int biasedExponent = (int)(bits >> 52) & 0x7FF;
+
+    DiyFp v;
+    if (biasedExponent == 0)
+        v = (DiyFp){significand, DENORMAL_EXPONENT};
+    else
+        v = (DiyFp){significand | HIDDEN_BIT, biasedExponent - EXPONENT_BIAS};
+
+    *plus = normalize((DiyFp){(v.f << 1) + 1, v.e - 1});
+
+    // past a power of two the next double down is half as far
+    if (significand == 0 && biasedExponent > 1)
+        *minus = (DiyFp){(v.f << 2) - 1, v.e - 2};
+    else
+        *minus = (DiyFp){(v.f << 1) - 1, v.e - 1};
+    minus -> f <<= minus -> e - plus -> e;
+    minus -> e = plus -> e;
+
+    *w = normalize(v);
+}
+
+// the cached power that scales a binary exponent of `e` into the...
+// ... target range
+static CachedPower cachedPowerFor(int e) {
+    int minExponent = MIN_TARGET_EXPONENT - (e + 64);
+
+    // ceil((minExponent + 63) * log10(2)), truncation being the...
+    // ... ceiling for negatives already
+    double estimate = (minExponent + 63) * 0.30102999566398114;
+    int k = (int)estimate;
+    if (estimate > k)
+        k++;
+
+    int index = (CACHED_POWERS_OFFSET + k - 1) / DECIMAL_EXPONENT_DISTANCE +
+        1;
+    return cachedPowers[index];
+}
+
+// steps the last digit down towards `w` while that stays inside...
+// ... the safe interval, then says whether the result is provably...
+// ... the closest shortest one
+static bool roundWeed(char* digits, int length, uint64_t distanceTooHighW,
+                      uint64_t unsafeInterval, uint64_t rest,
+                      uint64_t tenKappa, uint64_t unit) {
+    uint64_t smallDistance = distanceTooHighW - unit;
+    uint64_t bigDistance = distanceTooHighW + unit;
+
+    while (rest < smallDistance && unsafeInterval - rest >= tenKappa &&
+            (rest + tenKappa < smallDistance ||
+             smallDistance - rest >= rest + tenKappa - smallDistance)) {
+        digits[length - 1]--;
+        rest += tenKappa;
+    }
+
+    // w/ the error in mind, another digit could still be closer
+    if (rest < bigDistance && unsafeInterval - rest >= tenKappa &&
+            (rest + tenKappa < bigDistance ||
+             bigDistance - rest > rest + tenKappa - bigDistance))
+        return false;
+
+    return 2 * unit <= rest && rest <= unsafeInterval - 4 * unit;
+}
+
+// generates digits of `w` until they're inside the interval...
+// ... between `low` and `high`, false if it can't be sure
+static bool digitGen(DiyFp low, DiyFp w, DiyFp high, char* digits,
+                     int* length, int* kappa) {
+    uint64_t unit = 1;
+    DiyFp tooLow = {low.f - unit, low.e};
+    DiyFp tooHigh = {high.f + unit, high.e};
+    uint64_t unsafeInterval = tooHigh.f - tooLow.f;
+
+    int shift = -w.e;
+    uint64_t one = 1ull << shift;
+    uint32_t integrals = (uint32_t)(tooHigh.f >> shift);
+    uint64_t fractionals = tooHigh.f & (one - 1);
+
+    // the integral digits all at once, dividing by a constant...
+    // ... being a multiply, least significant first
+    uint32_t integralDigits[10];
+    *kappa = 0;
+    for (uint32_t rest = integrals; rest > 0; rest /= 10)
+        integralDigits[(*kappa)++] = rest % 10;
+    uint32_t divisor = *kappa > 0 ? smallPowersOfTen[*kappa - 1] : 0;
+
+    *length = 0;
+    while (*kappa > 0) {
+        uint32_t digit = integralDigits[--(*kappa)];
+        digits[(*length)++] = (char)('0' + digit);
+        integrals -= digit * divisor;
+
+        uint64_t rest = ((uint64_t)integrals << shift) + fractionals;
+        if (rest < unsafeInterval)
+            return roundWeed(digits, *length, tooHigh.f - w.f,
+                unsafeInterval, rest, (uint64_t)divisor << shift, unit);
+
+        divisor /= 10;
+    }
+
+    for (;;) {
+        fractionals *= 10;
+        unit *= 10;
+        unsafeInterval *= 10;
+
+        digits[(*length)++] = (char)('0' + (fractionals >> shift));
+        fractionals &= one - 1;
+        (*kappa)--;
+
+        if (fractionals < unsafeInterval)
+            return roundWeed(digits, *length, (tooHigh.f - w.f) * unit,
+                unsafeInterval, fractionals, one, unit);
+
+        if (*length == GRISU_MAX_DIGITS)
+            return false;
+    }
+}
+
+// `number` (positive, finite, not 0) is digits * 10^exponent
+static bool grisu3(double number, char* digits, int* length,
+                   int* exponent) {
+    DiyFp w, minus, plus;
+    decompose(number, &w, &minus, &plus);
+
+    CachedPower power = cachedPowerFor(w.e);
+    DiyFp scale = {power.f, power.e};
+
+    int kappa;
+    bool exact = digitGen(multiply(minus, scale), multiply(w, scale),
+        multiply(plus, scale), digits, length, &kappa);
+
+    *exponent = kappa - power.decimalExponent;
+    return exact;
+}
+
+// fewer and fewer digits from `%e` until one reads back right
+static void slowDigits(double number, char* digits, int* length,
+                       int* exponent) {
+    char formatted[NUMBER_MAX_CHARS];
+
+    for (int precision = 1; precision <= 17; precision++) {
+        snprintf(formatted, sizeof(formatted), "%.*e", precision - 1,
+            number);
+        if (strtod(formatted, NULL) == number || precision == 17)
+            break;
+    }
+
+    // "d.ddde+x": the digits, then the exponent
+    char* c = formatted;
+    *length = 0;
+    for (; *c != 'e'; c++)
+        if (*c != '.')
+            digits[(*length)++] = *c;
+
+    while (*length > 1 && digits[*length - 1] == '0')
+        (*length)--;
+
+    *exponent = atoi(c + 1) - (*length - 1);
+}
+
+// below 2^53 doubles are at most 1 apart, so any other decimal w/...
+// ... fewer digits is a different double: an integer's own digits...
+// ... are the shortest
+static void integerDigits(uint64_t integer, char* digits, int* length,
+                          int* exponent) {
+    // callers never pass 0, but a do-while writes at least one digit...
+    // ... either way, so the scan below never reads past `count`
+    char reversed[GRISU_MAX_DIGITS];
+    int count = 0;
+    do {
+        reversed[count++] = (char)('0' + integer % 10);
+        integer /= 10;
+    } while (integer > 0);
+
+    // trailing zeros go in the exponent
+    *exponent = 0;
+    while (*exponent < count - 1 && reversed[*exponent] == '0')
+        (*exponent)++;
+
+    *length = 0;
+    for (int i = count - 1; i >= *exponent; i--)
+        digits[(*length)++] = reversed[i];
+}
+
+static int writeZeros(char* buffer, int count) {
+    for (int i = 0; i < count; i++)
+        buffer[i] = '0';
+    return count;
+}
+
+int formatNumber(double number, char* buffer) {
+    if (number != number) {
+        memcpy(buffer, "nan", 3);
+        return 3;
+    }
+
+    int n = 0;
+    if (signbit(number)) {
+        buffer[n++] = '-';
+        number = -number;
+    }
+
+    if (number == 0) {
+        buffer[n++] = '0';
+        return n;
+    }
+    if (number > 1.7976931348623157e308) {
+        memcpy(buffer + n, "inf", 3);
+        return n + 3;
+    }
+
+    char digits[GRISU_MAX_DIGITS + 1];
+    int length, exponent;
+    if (number < 9007199254740992.0 && number == (double)(uint64_t)number)
+        integerDigits((uint64_t)number, digits, &length, &exponent);
+    else if (!grisu3(number, digits, &length, &exponent))
+        slowDigits(number, digits, &length, &exponent);
+
+    // where the decimal point goes, counted from the first digit
+    int point = length + exponent;
+
+    if (point > 0 && point <= 21) {
+        // 1234, 1200, 12.34
+        if (point >= length) {
+            memcpy(buffer + n, digits, length);
+            n += length;
+            n += writeZeros(buffer + n, point - length);
+        } else {
+            memcpy(buffer + n, digits, point);
+            n += point;
+            buffer[n++] = '.';
+            memcpy(buffer + n, digits + point, length - point);
+            n += length - point;
+        }
+    } else if (point > -6 && point <= 0) {
+        // 0.001234
+        buffer[n++] = '0';
+        buffer[n++] = '.';
+        n += writeZeros(buffer + n, -point);
+        memcpy(buffer + n, digits, length);
+        n += length;
+    } else {
+        // 1.234e+21, 1e-7
+        buffer[n++] = digits[0];
+        if (length > 1) {
+            buffer[n++] = '.';
+            memcpy(buffer + n, digits + 1, length - 1);
+            n += length - 1;
+        }
+        int e = point - 1;
+        buffer[n++] = 'e';
+        buffer[n++] = e < 0 ? '-' : '+';
+        if (e < 0)
+            e = -e;
+        if (e >= 100)
+            buffer[n++] = (char)('0' + e / 100);
+        if (e >= 10)
+            buffer[n++] = (char)('0' + e / 10 % 10);
+        buffer[n++] = (char)('0' + e % 10);
+    }
+
+    return n;
+}
@@ -0,0 +1,15 @@
+#ifndef clox_dtoa_h
+#define clox_dtoa_h
+
+#include "common.h"
+
+// room formatNumber() needs, it writes no terminator
+#define NUMBER_MAX_CHARS 32
+
+// writes the shortest decimal that reads back as exactly `number`...
+// ... (the closest such, when there's a choice) and returns its...
+// ... length: "12", "0.1", "1.5e-7", "1e+21", like JavaScript...
+// ... does, but w/ "-0", "nan", "inf" and "-inf" like `%g`
+int formatNumber(double number, char* buffer);
+
+#endif
@@ -0,0 +1,103 @@
+// compares evaluating one expression over many records by...
+// ... compiling it per record, the way `interpret()` has to,...
+// ... against compiling it once and binding each record's inputs...
+// ... usage: embed_bench [records...]
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "common.h"
+#include "memory.h"
+#include "value.h"
+#include "vm.h"
+
+#define INPUT_COUNT 3
+
+static const char* const inputNames[INPUT_COUNT] = {
+    "price", "quantity", "discount"
+};
+
+static const char* expression = "(price * quantity - discount) * 1.08 > 100";
+
+static double nowNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// the i-th record's inputs, w/ roughly half of them over 100
+static void record(int i, double inputs[INPUT_COUNT]) {
+    inputs[0] = 5 + i % 37;
+    inputs[1] = 1 + i % 7;
+    inputs[2] = i % 11;
+}
+
+static void bench(int records) {
+    char src[128];
+    double fields[INPUT_COUNT];
+    int hits = 0;
+
+    // the record's values spliced into the source, compiled...
+    // ... and run, as `interpret()` does minus the printing
+    double start = nowNanos();
+    for (int i = 0; i < records; i++) {
+        record(i, fields);
+        snprintf(src, sizeof(src), "(%.17g * %.17g - %.17g) * 1.08 > 100",
+            fields[0], fields[1], fields[2]);
+
+        Program* program = compileProgram(src, NULL, 0);
+        Value result;
+        if (runProgram(program, NULL, &result) == INTERPRET_OK &&
+                AS_BOOL(result))
+            hits++;
+        freeProgram(program);
+    }
+    double compileEachTime = nowNanos() - start;
+
+    // ... and compiled once, w/ the values bound as inputs
+    start = nowNanos();
+    Program* program = compileProgram(expression, inputNames, INPUT_COUNT);
+    for (int i = 0; i < records; i++) {
+        record(i, fields);
+
+        Value inputs[INPUT_COUNT];
+        for (int j = 0; j < INPUT_COUNT; j++)
+            inputs[j] = NUMBER_VAL(fields[j]);
+
+        Value result;
+        if (runProgram(program, inputs, &result) == INTERPRET_OK &&
+                AS_BOOL(result))
+            hits--;
+    }
+    freeProgram(program);
+    double compileOnceTime = nowNanos() - start;
+
+    // both ways agree iff every hit was taken back
+    printf("%9d %16.0f %16.0f %8.2fx   %s\n", records,
+        records / (compileEachTime / 1e9), records / (compileOnceTime / 1e9),
+        compileEachTime / compileOnceTime, hits == 0 ? "ok" : "MISMATCH");
+}
+
+int main(int argc, const char* argv[]) {
+    initVM();
+
+    printf("%s\n\n", expression);
+    printf("%9s %16s %16s %9s\n", "records", "compile each/s",
+        "compile once/s", "speedup");
+
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++)
+            bench(atoi(argv[i]));
+    }
+    else {
+        bench(10000);
+        bench(100000);
+        bench(1000000);
+    }
+
+    freeVM();
+    return 0;
+}
@@ -0,0 +1,145 @@
+// measures the pauses of the incremental collector...
+// ... usage: gc_bench [live] [garbage] [objects-per-slice]
+//
+// the slice budget is a count of objects marked or swept per...
+// ... slice, not a time; what that costs in time is what's measured
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "common.h"
+#include "chunk.h"
+#include "memory.h"
+#include "object.h"
+#include "vm.h"
+
+// pauses are binned by powers of two microseconds
+#define HISTOGRAM_BUCKETS 16
+
+static double nowMicros(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// `live` strings reachable thru the chunk's constants...
+// ... and `garbage` strings reachable from nowhere
+static void buildHeap(Chunk* chunk, int live, int garbage) {
+    char name[32];
+
+    for (int i = 0; i < live; i++) {
+        int length = snprintf(name, sizeof(name), "live%d", i);
+        addConstant(chunk, OBJ_VAL(copyString(name, length)));
+    }
+
+    for (int i = 0; i < garbage; i++) {
+        int length = snprintf(name, sizeof(name), "garbage%d", i);
+        copyString(name, length);
+    }
+}
+
+// runs one whole cycle in slices of `budget` objects and...
+// ... returns the longest slice in microseconds
+static double runCycle(int budget, long histogram[], long* slices,
+                       double* total) {
+    vm.gcSliceBudget = budget;
+    double maxPause = 0;
+    bool more = true;
+
+    double start = nowMicros();
+    startGC();
+    double pause = nowMicros() - start;
+
+    for (;;) {
+        *total += pause;
+        (*slices)++;
+
+        if (pause > maxPause)
+            maxPause = pause;
+
+        int bucket = 0;
+        while (bucket < HISTOGRAM_BUCKETS - 1 &&
+                pause >= (double)(1L << bucket))
+            bucket++;
+        histogram[bucket]++;
+
+        if (!more)
+            break;
+
+        start = nowMicros();
+        more = gcStep();
+        pause = nowMicros() - start;
+    }
+
+    return maxPause;
+}
+
+static void printHistogram(long histogram[], long slices) {
+    printf("pause histogram (us):\n");
+
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (histogram[i] == 0)
+            continue;
+
+        long low = i == 0 ? 0 : 1L << (i - 1);
+        printf("  [%6ld, %6ld) %10ld ", low, 1L << i, histogram[i]);
+
+        int bar = (int)(50 * histogram[i] / slices);
+        for (int j = 0; j < bar; j++)
+            printf("#");
+        printf("\n");
+    }
+}
+
+int main(int argc, const char* argv[]) {
+    int live = argc > 1 ? atoi(argv[1]) : 100000;
+    int garbage = argc > 2 ? atoi(argv[2]) : 100000;
+    int budget = argc > 3 ? atoi(argv[3]) : GC_DEFAULT_SLICE_BUDGET;
+
+    initVM();
+
+    // no cycles while the heap is being built
+    vm.nextGC = (size_t)-1;
+
+    Chunk chunk;
+    initChunk(&chunk);
+    vm.chunk = &chunk;
+
+    printf("==gc-bench== live %d, garbage %d, slice budget %d objects\n",
+        live, garbage, budget);
+
+    // incremental: bounded slices
+    buildHeap(&chunk, live, garbage);
+
+    long histogram[HISTOGRAM_BUCKETS] = {0};
+    long slices = 0;
+    double total = 0;
+    double maxPause = runCycle(budget, histogram, &slices, &total);
+
+    printf("incremental: %ld slices, %.0f us total, max pause %.1f us\n",
+        slices, total, maxPause);
+    printHistogram(histogram, slices);
+
+    // stop-the-world: the same heap w/ no budget, where the program...
+    // ... waits for the whole cycle, so the pause is every slice...
+    // ... of it (the roots, marking and sweeping) added up
+    buildHeap(&chunk, 0, garbage);
+
+    long stwHistogram[HISTOGRAM_BUCKETS] = {0};
+    long stwSlices = 0;
+    double stwPause = 0;
+    runCycle(INT_MAX, stwHistogram, &stwSlices, &stwPause);
+
+    printf("stop-the-world: pause %.1f us (roots + mark + sweep)\n",
+        stwPause);
+
+    vm.chunk = NULL;
+    freeChunk(&chunk);
+    freeVM();
+
+    return 0;
+}
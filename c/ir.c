@@ -0,0 +1,714 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ir.h"
+#include "memory.h"
+#include "object.h"
+
+// what computing a node again can cost, capped so a long...
+// ... chain can't overflow it
+#define IR_MAX_COST (1 << 20)
+
+static IrStats stats;
+
+void initIr(Ir* ir) {
+    ir -> count = 0;
+    ir -> capacity = 0;
+    ir -> nodes = NULL;
+
+    ir -> operandCount = 0;
+    ir -> operandCapacity = 0;
+    ir -> operands = NULL;
+}
+
+void freeIr(Ir* ir) {
+    FREE_ARRAY(IrNode, ir -> nodes, ir -> capacity, MEM_IR);
+    FREE_ARRAY(int, ir -> operands, ir -> operandCapacity, MEM_IR);
+    initIr(ir);
+}
+
+static int addNode(Ir* ir, OpCode op, int line) {
+    if (ir -> capacity < ir -> count + 1) {
+        int oldCapacity = ir -> capacity;
+        ir -> capacity = GROW_CAPACITY(oldCapacity);
+        ir -> nodes = GROW_ARRAY(IrNode, ir -> nodes, oldCapacity,
+            ir -> capacity, MEM_IR);
+    }
+
+    IrNode* node = &ir -> nodes[ir -> count];
+    node -> op = op;
+    node -> left = -1;
+    node -> right = -1;
+    node -> value = NIL_VAL;
+    node -> input = 0;
+    node -> line = line;
+    node -> forward = ir -> count;
+    node -> type = IR_TYPE_UNKNOWN;
+
+    return ir -> count++;
+}
+
+static void pushOperand(Ir* ir, int node) {
+    if (ir -> operandCapacity < ir -> operandCount + 1) {
+        int oldCapacity = ir -> operandCapacity;
+        ir -> operandCapacity = GROW_CAPACITY(oldCapacity);
+        ir -> operands = GROW_ARRAY(int, ir -> operands, oldCapacity,
+            ir -> operandCapacity, MEM_IR);
+    }
+
+    ir -> operands[ir -> operandCount++] = node;
+}
+
+static int popOperand(Ir* ir) {
+    return ir -> operands[--ir -> operandCount];
+}
+
+// how many values `op` pops
+static int arity(OpCode op) {
+    switch (op) {
+        case OP_EQUAL:
+        case OP_GREATER:
+        case OP_LESS:
+        case OP_ADD:
+        case OP_SUBTRACT:
+        case OP_MULTIPLY:
+        case OP_DIVIDE:
+            return 2;
+        case OP_NOT:
+        case OP_NEGATE:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+void irEmit(Ir* ir, OpCode op, int line) {
+    int node = addNode(ir, op, line);
+
+    // the right operand is the one on top
+    if (arity(op) == 2)
+        ir -> nodes[node].right = popOperand(ir);
+    if (arity(op) >= 1)
+        ir -> nodes[node].left = popOperand(ir);
+
+    pushOperand(ir, node);
+}
+
+void irEmitConstant(Ir* ir, Value value, int line) {
+    int node = addNode(ir, OP_CONSTANT, line);
+    ir -> nodes[node].value = value;
+    pushOperand(ir, node);
+}
+
+void irEmitInput(Ir* ir, uint32_t input, int line) {
+    int node = addNode(ir, OP_GET_INPUT, line);
+    ir -> nodes[node].input = input;
+    pushOperand(ir, node);
+}
+
+// nodes only ever forward to earlier ones, so this ends
+static int resolve(Ir* ir, int node) {
+    while (node >= 0 && ir -> nodes[node].forward != node)
+        node = ir -> nodes[node].forward;
+    return node;
+}
+
+// points a node's operands past the nodes they replaced
+static void resolveOperands(Ir* ir, IrNode* node) {
+    node -> left = resolve(ir, node -> left);
+    node -> right = resolve(ir, node -> right);
+}
+
+// the instructions a tree of nodes lowers to, w/ every use of a...
+// ... node computing it again (which is what the parser emits)
+static size_t treeInstructions(Ir* ir, int root) {
+    size_t* sizes = ALLOCATE(size_t, ir -> count, MEM_IR);
+
+    for (int i = 0; i <= root; i++) {
+        IrNode* node = &ir -> nodes[i];
+        int left = resolve(ir, node -> left);
+        int right = resolve(ir, node -> right);
+
+        sizes[i] = 1 + (left >= 0 ? sizes[left] : 0) +
+            (right >= 0 ? sizes[right] : 0);
+    }
+
+    // plus the OP_RETURN
+    size_t size = sizes[root] + 1;
+    FREE_ARRAY(size_t, sizes, ir -> count, MEM_IR);
+    return size;
+}
+
+// --- simplification ---
+
+static bool isConstant(IrNode* node) {
+    switch (node -> op) {
+        case OP_CONSTANT:
+        case OP_NIL:
+        case OP_TRUE:
+        case OP_FALSE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static Value constantValue(IrNode* node) {
+    switch (node -> op) {
+        case OP_CONSTANT:
+            return node -> value;
+        case OP_TRUE:
+            return BOOL_VAL(true);
+        case OP_FALSE:
+            return BOOL_VAL(false);
+        default:
+            return NIL_VAL;
+    }
+}
+
+static bool isNumberConstant(IrNode* node) {
+    return node -> op == OP_CONSTANT && IS_NUMBER(node -> value);
+}
+
+// 1, or a +0 (`x - -0` is `x + 0`, which turns a -0 into +0)
+static bool isIdentity(IrNode* node, double identity) {
+    return isNumberConstant(node) && AS_NUMBER(node -> value) == identity &&
+        !signbit(AS_NUMBER(node -> value));
+}
+
+// turns a node into a constant, whatever it was
+static void fold(IrNode* node, Value value) {
+    if (IS_BOOL(value)) {
+        node -> op = AS_BOOL(value) ? OP_TRUE : OP_FALSE;
+        node -> type = IR_TYPE_BOOL;
+    } else {
+        node -> op = OP_CONSTANT;
+        node -> value = value;
+        node -> type = IS_NUMBER(value) ? IR_TYPE_NUMBER : IR_TYPE_UNKNOWN;
+    }
+
+    node -> left = -1;
+    node -> right = -1;
+}
+
+// folds an op whose operands are constants, as long as the op...
+// ... couldn't fail at runtime; strings are never concatenated...
+// ... ahead of time, a long chain of them would build every...
+// ... prefix of the result
+static bool foldConstants(Ir* ir, IrNode* node) {
+    IrNode* left = node -> left >= 0 ? &ir -> nodes[node -> left] : NULL;
+    IrNode* right = node -> right >= 0 ? &ir -> nodes[node -> right] : NULL;
+
+    switch (node -> op) {
+        case OP_EQUAL:
+            if (!isConstant(left) || !isConstant(right))
+                return false;
+            fold(node, BOOL_VAL(valuesEqual(constantValue(left),
+                constantValue(right))));
+            return true;
+
+        case OP_NOT: {
+            if (!isConstant(left))
+                return false;
+
+            // nil and false are falsey, like in the VM
+            Value value = constantValue(left);
+            fold(node, BOOL_VAL(IS_NIL(value) ||
+                (IS_BOOL(value) && !AS_BOOL(value))));
+            return true;
+        }
+
+        case OP_NEGATE:
+            if (!isNumberConstant(left))
+                return false;
+            fold(node, NUMBER_VAL(-AS_NUMBER(left -> value)));
+            return true;
+
+        default:
+            break;
+    }
+
+    if (arity(node -> op) != 2 || !isNumberConstant(left) ||
+            !isNumberConstant(right))
+        return false;
+
+    double a = AS_NUMBER(left -> value);
+    double b = AS_NUMBER(right -> value);
+
+    switch (node -> op) {
+        case OP_GREATER:
+            fold(node, BOOL_VAL(a > b));
+            return true;
+        case OP_LESS:
+            fold(node, BOOL_VAL(a < b));
+            return true;
+        case OP_ADD:
+            fold(node, NUMBER_VAL(a + b));
+            return true;
+        case OP_SUBTRACT:
+            fold(node, NUMBER_VAL(a - b));
+            return true;
+        case OP_MULTIPLY:
+            fold(node, NUMBER_VAL(a * b));
+            return true;
+        case OP_DIVIDE:
+            fold(node, NUMBER_VAL(a / b));
+            return true;
+        default:
+            return false;
+    }
+}
+
+// the node an op does nothing to, or -1; only where the operand...
+// ... is known to be a number (or a bool for `!!`), else the op...
+// ... could have been the one to report a runtime error
+static int identityOperand(Ir* ir, IrNode* node) {
+    IrNode* left = node -> left >= 0 ? &ir -> nodes[node -> left] : NULL;
+    IrNode* right = node -> right >= 0 ? &ir -> nodes[node -> right] : NULL;
+
+    switch (node -> op) {
+        case OP_MULTIPLY:
+            if (isIdentity(right, 1) && left -> type == IR_TYPE_NUMBER)
+                return node -> left;
+            if (isIdentity(left, 1) && right -> type == IR_TYPE_NUMBER)
+                return node -> right;
+            return -1;
+
+        case OP_DIVIDE:
+            if (isIdentity(right, 1) && left -> type == IR_TYPE_NUMBER)
+                return node -> left;
+            return -1;
+
+        case OP_SUBTRACT:
+            if (isIdentity(right, 0) && left -> type == IR_TYPE_NUMBER)
+                return node -> left;
+            return -1;
+
+        // `--x`
+        case OP_NEGATE:
+            if (left -> op == OP_NEGATE &&
+                    ir -> nodes[left -> left].type == IR_TYPE_NUMBER)
+                return left -> left;
+            return -1;
+
+        // `!!x`, which `!` only takes the truth of, so it's also...
+        // ... `!!!x` to `!x` whatever x is
+        case OP_NOT:
+            if (left -> op == OP_NOT &&
+                    ir -> nodes[left -> left].type == IR_TYPE_BOOL)
+                return left -> left;
+            return -1;
+
+        default:
+            return -1;
+    }
+}
+
+static IrType typeOf(Ir* ir, IrNode* node) {
+    switch (node -> op) {
+        case OP_CONSTANT:
+            return IS_NUMBER(node -> value) ?
+                IR_TYPE_NUMBER : IR_TYPE_UNKNOWN;
+
+        case OP_TRUE:
+        case OP_FALSE:
+        case OP_EQUAL:
+        case OP_GREATER:
+        case OP_LESS:
+        case OP_NOT:
+            return IR_TYPE_BOOL;
+
+        case OP_SUBTRACT:
+        case OP_MULTIPLY:
+        case OP_DIVIDE:
+        case OP_NEGATE:
+            return IR_TYPE_NUMBER;
+
+        // two strings concatenate instead
+        case OP_ADD:
+            return ir -> nodes[node -> left].type == IR_TYPE_NUMBER &&
+                ir -> nodes[node -> right].type == IR_TYPE_NUMBER ?
+                IR_TYPE_NUMBER : IR_TYPE_UNKNOWN;
+
+        default:
+            return IR_TYPE_UNKNOWN;
+    }
+}
+
+static void simplify(Ir* ir) {
+    for (int i = 0; i < ir -> count; i++) {
+        IrNode* node = &ir -> nodes[i];
+        resolveOperands(ir, node);
+
+        if (foldConstants(ir, node))
+            continue;
+
+        int identity = identityOperand(ir, node);
+        if (identity >= 0) {
+            node -> forward = identity;
+            continue;
+        }
+
+        node -> type = typeOf(ir, node);
+    }
+}
+
+// --- common subexpression elimination ---
+
+static uint32_t hashNode(IrNode* node) {
+    uint32_t hash = 2166136261u;
+    uint64_t bits = 0;
+
+    switch (node -> op) {
+        case OP_CONSTANT:
+            if (IS_NUMBER(node -> value)) {
+                // the bits, so -0 and +0 aren't the same constant
+                double number = AS_NUMBER(node -> value);
+                memcpy(&bits, &number, sizeof(bits));
+            } else {
+                ObjString* string = AS_STRING(node -> value);
+                for (int i = 0; i < string -> length; i++)
+                    bits = (bits ^ (uint8_t)string -> chars[i]) * 31;
+            }
+            break;
+        case OP_GET_INPUT:
+            bits = node -> input;
+            break;
+        default:
+            break;
+    }
+
+    uint32_t words[] = {
+        (uint32_t)node -> op, (uint32_t)node -> left,
+        (uint32_t)node -> right, (uint32_t)bits, (uint32_t)(bits >> 32)
+    };
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+        hash ^= words[i];
+        hash *= 16777619;
+    }
+    return hash;
+}
+
+static bool sameNode(IrNode* a, IrNode* b) {
+    if (a -> op != b -> op || a -> left != b -> left ||
+            a -> right != b -> right)
+        return false;
+
+    switch (a -> op) {
+        case OP_CONSTANT:
+            if (IS_NUMBER(a -> value) != IS_NUMBER(b -> value))
+                return false;
+            if (IS_NUMBER(a -> value)) {
+                double x = AS_NUMBER(a -> value);
+                double y = AS_NUMBER(b -> value);
+                return memcmp(&x, &y, sizeof(double)) == 0;
+            }
+            return valuesEqual(a -> value, b -> value);
+        case OP_GET_INPUT:
+            return a -> input == b -> input;
+        default:
+            return true;
+    }
+}
+
+// value numbering: every node is looked up by its op and its...
+// ... (already numbered) operands, and one that was seen before...
+// ... forwards to it; evaluation has no side effects but errors,...
+// ... and the first of two equal nodes errors first anyway
+static void eliminateCommon(Ir* ir) {
+    int capacity = 8;
+    while (capacity < ir -> count * 2)
+        capacity *= 2;
+
+    int* table = ALLOCATE(int, capacity, MEM_IR);
+    for (int i = 0; i < capacity; i++)
+        table[i] = -1;
+
+    for (int i = 0; i < ir -> count; i++) {
+        IrNode* node = &ir -> nodes[i];
+        if (node -> forward != i)
+            continue;
+
+        resolveOperands(ir, node);
+
+        uint32_t index = hashNode(node) & (capacity - 1);
+        for (;;) {
+            if (table[index] == -1) {
+                table[index] = i;
+                break;
+            }
+            if (sameNode(&ir -> nodes[table[index]], node)) {
+                node -> forward = table[index];
+                break;
+            }
+            index = (index + 1) & (capacity - 1);
+        }
+    }
+
+    FREE_ARRAY(int, table, capacity, MEM_IR);
+}
+
+// --- dead value elimination ---
+
+// drops every node the root doesn't use and renumbers the rest,...
+// ... which leaves nothing forwarded; returns the new root
+static int eliminateDead(Ir* ir, int root) {
+    root = resolve(ir, root);
+    int oldCount = ir -> count;
+
+    bool* live = ALLOCATE(bool, ir -> count, MEM_IR);
+    int* renumbered = ALLOCATE(int, ir -> count, MEM_IR);
+    memset(live, 0, sizeof(bool) * ir -> count);
+
+    // operands come before their users, so one pass back from...
+    // ... the root sees every user of a node before the node
+    live[root] = true;
+    for (int i = root; i >= 0; i--) {
+        if (!live[i])
+            continue;
+
+        IrNode* node = &ir -> nodes[i];
+        resolveOperands(ir, node);
+        if (node -> left >= 0)
+            live[node -> left] = true;
+        if (node -> right >= 0)
+            live[node -> right] = true;
+    }
+
+    int count = 0;
+    for (int i = 0; i <= root; i++) {
+        if (!live[i])
+            continue;
+
+        IrNode node = ir -> nodes[i];
+        if (node.left >= 0)
+            node.left = renumbered[node.left];
+        if (node.right >= 0)
+            node.right = renumbered[node.right];
+        node.forward = count;
+
+        renumbered[i] = count;
+        ir -> nodes[count++] = node;
+    }
+    ir -> count = count;
+
+    FREE_ARRAY(int, renumbered, oldCount, MEM_IR);
+    FREE_ARRAY(bool, live, oldCount, MEM_IR);
+    return count - 1;
+}
+
+// --- lowering ---
+
+typedef struct {
+    Chunk* chunk;
+    ValueArray constants;
+    int* constantIndex;     // each constant node's, or -1
+    int* slot;              // a shared node's local, or -1
+    bool* computed;         // whether its slot has been set yet
+    size_t instructions;
+} Lowering;
+
+static void lowerOperand(Lowering* lowering, OpCode op, uint32_t operand,
+                         int line) {
+    writeChunk(lowering -> chunk, op, line);
+    writeOperand(lowering -> chunk, operand, line);
+    lowering -> instructions++;
+}
+
+static void lowerNode(Lowering* lowering, int index, IrNode* node) {
+    if (node -> op == OP_GET_INPUT) {
+        lowerOperand(lowering, OP_GET_INPUT, node -> input, node -> line);
+        return;
+    }
+
+    if (node -> op != OP_CONSTANT) {
+        writeChunk(lowering -> chunk, node -> op, node -> line);
+        lowering -> instructions++;
+        return;
+    }
+
+    // equal constants were numbered as one node, so they share...
+    // ... an entry in the constant pool too
+    if (lowering -> constantIndex[index] < 0) {
+        writeValueArray(&lowering -> constants, node -> value);
+        lowering -> constantIndex[index] = lowering -> constants.count - 1;
+    }
+
+    int constant = lowering -> constantIndex[index];
+    if (constant < 256) {
+        writeChunk(lowering -> chunk, OP_CONSTANT, node -> line);
+        writeChunk(lowering -> chunk, constant, node -> line);
+        lowering -> instructions++;
+    } else {
+        lowerOperand(lowering, OP_CONSTANT_LONG, constant, node -> line);
+    }
+}
+
+// a node used more than once gets a slot when reading it back...
+// ... beats computing it again: `uses` times `cost` instructions...
+// ... against `cost` plus a slot's OP_NIL, OP_SET_LOCAL and an...
+// ... OP_GET_LOCAL per use after the first
+static int assignSlots(Ir* ir, int* slot) {
+    int* uses = ALLOCATE(int, ir -> count, MEM_IR);
+    int* cost = ALLOCATE(int, ir -> count, MEM_IR);
+    memset(uses, 0, sizeof(int) * ir -> count);
+
+    for (int i = 0; i < ir -> count; i++) {
+        IrNode* node = &ir -> nodes[i];
+        if (node -> left >= 0)
+            uses[node -> left]++;
+        if (node -> right >= 0)
+            uses[node -> right]++;
+    }
+
+    int slots = 0;
+    for (int i = 0; i < ir -> count; i++) {
+        IrNode* node = &ir -> nodes[i];
+
+        cost[i] = 1;
+        int operands[] = {node -> left, node -> right};
+        for (int j = 0; j < 2; j++) {
+            int operand = operands[j];
+            if (operand >= 0)
+                cost[i] += slot[operand] >= 0 ? 1 : cost[operand];
+        }
+        if (cost[i] > IR_MAX_COST)
+            cost[i] = IR_MAX_COST;
+
+        slot[i] = -1;
+        if (uses[i] > 1 && node -> left >= 0 &&
+                (long)(uses[i] - 1) * (cost[i] - 1) > 2)
+            slot[i] = slots++;
+    }
+
+    FREE_ARRAY(int, cost, ir -> count, MEM_IR);
+    FREE_ARRAY(int, uses, ir -> count, MEM_IR);
+    return slots;
+}
+
+typedef struct {
+    int node;
+    bool operandsDone;
+} LowerFrame;
+
+static void lowerTree(Ir* ir, int root, Chunk* chunk, Lowering* lowering) {
+    int line = ir -> nodes[root].line;
+
+    int slots = assignSlots(ir, lowering -> slot);
+
+    // the slots sit at the bottom of the program's stack
+    for (int i = 0; i < slots; i++) {
+        writeChunk(chunk, OP_NIL, line);
+        lowering -> instructions++;
+    }
+
+    // post-order, w/ an explicit stack, since the left spine of...
+    // ... a long chain of `+` is as deep as the chain is long
+    int capacity = 8;
+    int count = 0;
+    LowerFrame* frames = ALLOCATE(LowerFrame, capacity, MEM_IR);
+    frames[count++] = (LowerFrame){root, false};
+
+    while (count > 0) {
+        LowerFrame frame = frames[--count];
+        IrNode* node = &ir -> nodes[frame.node];
+        int slot = lowering -> slot[frame.node];
+
+        if (frame.operandsDone) {
+            lowerNode(lowering, frame.node, node);
+            if (slot >= 0) {
+                lowerOperand(lowering, OP_SET_LOCAL, slot, node -> line);
+                lowering -> computed[frame.node] = true;
+            }
+            continue;
+        }
+
+        if (slot >= 0 && lowering -> computed[frame.node]) {
+            lowerOperand(lowering, OP_GET_LOCAL, slot, node -> line);
+            continue;
+        }
+
+        if (capacity < count + 3) {
+            int oldCapacity = capacity;
+            capacity = GROW_CAPACITY(oldCapacity);
+            frames = GROW_ARRAY(LowerFrame, frames, oldCapacity, capacity,
+                MEM_IR);
+        }
+
+        // the left operand comes off first
+        frames[count++] = (LowerFrame){frame.node, true};
+        if (node -> right >= 0)
+            frames[count++] = (LowerFrame){node -> right, false};
+        if (node -> left >= 0)
+            frames[count++] = (LowerFrame){node -> left, false};
+    }
+
+    FREE_ARRAY(LowerFrame, frames, capacity, MEM_IR);
+
+    writeChunk(chunk, OP_RETURN, line);
+    lowering -> instructions++;
+}
+
+void lowerIr(Ir* ir, Chunk* chunk) {
+    int root = ir -> operands[ir -> operandCount - 1];
+    stats.expressions++;
+
+    stats.nodes[IR_PASS_BUILD] += ir -> count;
+    stats.instructions[IR_PASS_BUILD] += treeInstructions(ir, root);
+
+    simplify(ir);
+    stats.nodes[IR_PASS_SIMPLIFY] += ir -> count;
+    stats.instructions[IR_PASS_SIMPLIFY] +=
+        treeInstructions(ir, resolve(ir, root));
+
+    eliminateCommon(ir);
+    stats.nodes[IR_PASS_CSE] += ir -> count;
+
+    root = eliminateDead(ir, root);
+    stats.nodes[IR_PASS_DVE] += ir -> count;
+
+    Lowering lowering;
+    lowering.chunk = chunk;
+    initValueArray(&lowering.constants);
+    lowering.constantIndex = ALLOCATE(int, ir -> count, MEM_IR);
+    lowering.slot = ALLOCATE(int, ir -> count, MEM_IR);
+    lowering.computed = ALLOCATE(bool, ir -> count, MEM_IR);
+    lowering.instructions = 0;
+    for (int i = 0; i < ir -> count; i++) {
+        lowering.constantIndex[i] = -1;
+        lowering.computed[i] = false;
+    }
+
+    lowerTree(ir, root, chunk, &lowering);
+
+    // dropping nodes dropped nothing that'd be emitted, dead...
+    // ... nodes were never going to be
+    stats.instructions[IR_PASS_CSE] += lowering.instructions;
+    stats.instructions[IR_PASS_DVE] += lowering.instructions;
+
+    FREE_ARRAY(bool, lowering.computed, ir -> count, MEM_IR);
+    FREE_ARRAY(int, lowering.slot, ir -> count, MEM_IR);
+    FREE_ARRAY(int, lowering.constantIndex, ir -> count, MEM_IR);
+
+    // the old constants kept the strings alive until now
+    freeValueArray(&chunk -> constants);
+    chunk -> constants = lowering.constants;
+}
+
+IrStats getIrStats(void) {
+    return stats;
+}
+
+void printIrStats(void) {
+    static const char* passNames[IR_PASS_COUNT] = {
+        "build", "simplify", "cse", "dve"
+    };
+
+    fprintf(stderr, "==ir==\n");
+    fprintf(stderr, "%zu expressions\n", stats.expressions);
+    fprintf(stderr, "%-12s %12s %12s\n", "pass", "nodes", "instructions");
+    for (int i = 0; i < IR_PASS_COUNT; i++)
+        fprintf(stderr, "%-12s %12zu %12zu\n", passNames[i], stats.nodes[i],
+            stats.instructions[i]);
+}
@@ -0,0 +1,82 @@
+#ifndef clox_ir_h
+#define clox_ir_h
+
+#include "chunk.h"
+
+// an expression as a DAG instead of bytecode: the compiler builds...
+// ... it when asked to (see `setCompilerIr()`), it's optimized...
+// ... by a few passes and then lowered back to the same opcodes
+
+// what a node is known to evaluate to, if it evaluates at all
+typedef enum {
+    IR_TYPE_UNKNOWN,
+    IR_TYPE_NUMBER,
+    IR_TYPE_BOOL
+} IrType;
+
+// a node is the instruction that computes its value, its...
+// ... operands being earlier nodes, so the nodes are always...
+// ... in an order they could be computed in
+typedef struct {
+    OpCode op;          // never OP_CONSTANT_LONG, a local or OP_RETURN
+    int left;           // operands, -1 past the op's arity
+    int right;
+    Value value;        // OP_CONSTANT's
+    uint32_t input;     // OP_GET_INPUT's
+    int line;
+
+    int forward;        // the node that replaced this one, or itself
+    IrType type;
+} IrNode;
+
+typedef struct {
+    int count;
+    int capacity;
+    IrNode* nodes;
+
+    // the nodes built but not yet used, like the VM's stack
+    int operandCount;
+    int operandCapacity;
+    int* operands;
+} Ir;
+
+// the passes, in the order they run
+typedef enum {
+    IR_PASS_BUILD,      // the expression as parsed
+    IR_PASS_SIMPLIFY,   // constant folding, `x * 1`, `--x`, `!!x`
+    IR_PASS_CSE,        // common subexpressions computed once
+    IR_PASS_DVE,        // nodes nothing uses any more dropped
+    IR_PASS_COUNT
+} IrPass;
+
+// the IR's nodes, and the instructions it'd lower to, after each...
+// ... pass, summed over every expression lowered
+typedef struct {
+    size_t expressions;
+    size_t nodes[IR_PASS_COUNT];
+    size_t instructions[IR_PASS_COUNT];
+} IrStats;
+
+void initIr(Ir* ir);
+
+void freeIr(Ir* ir);
+
+// builds the node for `op` (not OP_CONSTANT or OP_GET_INPUT), w/...
+// ... the nodes on top as its operands, and leaves it on top
+void irEmit(Ir* ir, OpCode op, int line);
+
+void irEmitConstant(Ir* ir, Value value, int line);
+
+void irEmitInput(Ir* ir, uint32_t input, int line);
+
+// runs the passes over the node on top and writes what's left...
+// ... to the empty chunk, then an OP_RETURN; the chunk's...
+// ... constants are replaced by the ones still used
+void lowerIr(Ir* ir, Chunk* chunk);
+
+IrStats getIrStats(void);
+
+// reports the counts to stderr
+void printIrStats(void);
+
+#endif
@@ -0,0 +1,281 @@
+// differential test of the IR: a generated corpus of expressions,...
+// ... full of repeated subexpressions, `* 1`, `--` and `!!`, is...
+// ... compiled both straight to bytecode and through the IR, and...
+// ... every run of the two has to agree, runtime errors included;...
+// ... then both are timed and the passes' counts reported...
+// ... usage: ir_test [expressions] [seed], runtime errors go to...
+// ... stderr
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common.h"
+#include "compiler.h"
+#include "ir.h"
+#include "memory.h"
+#include "value.h"
+#include "vm.h"
+
+#define INPUT_COUNT 4
+#define ROWS 8
+#define TIMING_REPS 2000
+#define MAX_SRC 4096
+#define MAX_REUSED 8
+
+static const char* const inputNames[INPUT_COUNT] = {"x", "y", "z", "w"};
+
+static const char* const passNames[IR_PASS_COUNT] = {
+    "build", "simplify", "cse", "dve"
+};
+
+static int failures = 0;
+
+static double nowNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+typedef struct {
+    char chars[MAX_SRC];
+    int length;
+} Source;
+
+// subexpressions already generated, to be used again
+static Source reused[MAX_REUSED];
+static int reusedCount = 0;
+
+static void append(Source* src, const char* text) {
+    while (*text != '\0' && src -> length < MAX_SRC - 1)
+        src -> chars[src -> length++] = *text++;
+    src -> chars[src -> length] = '\0';
+}
+
+static void genBool(Source* src, int depth);
+
+static void genNumber(Source* src, int depth) {
+    static const char* operators[] = {" + ", " - ", " * ", " / "};
+    char literal[32];
+
+    if (reusedCount > 0 && rand() % 4 == 0) {
+        append(src, reused[rand() % reusedCount].chars);
+        return;
+    }
+
+    if (depth == 0 || rand() % 5 == 0) {
+        switch (rand() % 4) {
+            case 0:
+                snprintf(literal, sizeof(literal), "%d", rand() % 10);
+                append(src, literal);
+                break;
+            case 1:
+                snprintf(literal, sizeof(literal), "%d.%d", rand() % 100,
+                    rand() % 10);
+                append(src, literal);
+                break;
+            default:
+                // `w` is sometimes a string, nil or a bool
+                append(src, inputNames[rand() % INPUT_COUNT]);
+                break;
+        }
+        return;
+    }
+
+    Source sub = {.length = 0};
+    switch (rand() % 6) {
+        case 0:
+            append(&sub, "--");
+            genNumber(&sub, depth - 1);
+            break;
+        case 1:
+            append(&sub, "(");
+            genNumber(&sub, depth - 1);
+            append(&sub, rand() % 2 ? " * 1)" : " / 1)");
+            break;
+        case 2:
+            append(&sub, "(1 * ");
+            genNumber(&sub, depth - 1);
+            append(&sub, rand() % 2 ? ")" : " - 0)");
+            break;
+        default:
+            append(&sub, "(");
+            genNumber(&sub, depth - 1);
+            append(&sub, operators[rand() % 4]);
+            genNumber(&sub, depth - 1);
+            append(&sub, ")");
+            break;
+    }
+
+    if (reusedCount < MAX_REUSED)
+        reused[reusedCount++] = sub;
+    else
+        reused[rand() % MAX_REUSED] = sub;
+    append(src, sub.chars);
+}
+
+static void genBool(Source* src, int depth) {
+    static const char* comparisons[] = {
+        " < ", " > ", " <= ", " >= ", " == ", " != "
+    };
+
+    if (depth == 0) {
+        append(src, rand() % 2 ? "true" : "nil");
+        return;
+    }
+
+    append(src, "(");
+    switch (rand() % 5) {
+        case 0:
+        case 1:
+            genNumber(src, depth - 1);
+            append(src, comparisons[rand() % 6]);
+            genNumber(src, depth - 1);
+            break;
+        case 2:
+            append(src, rand() % 2 ? "!!" : "!");
+            genBool(src, depth - 1);
+            break;
+        case 3:
+            append(src, "!!");
+            genNumber(src, depth - 1);
+            break;
+        default:
+            genBool(src, depth - 1);
+            append(src, rand() % 2 ? " == " : " != ");
+            genBool(src, depth - 1);
+            break;
+    }
+    append(src, ")");
+}
+
+// a constant of a program that's never freed, so it's a root
+static Value lox;
+
+static Value randomInput(int input) {
+    if (input == INPUT_COUNT - 1) {
+        switch (rand() % 4) {
+            case 0:  return lox;
+            case 1:  return NIL_VAL;
+            case 2:  return BOOL_VAL(false);
+            default: break;
+        }
+    }
+
+    switch (rand() % 3) {
+        case 0:  return NUMBER_VAL(0.0);
+        case 1:  return NUMBER_VAL(-0.0);
+        default: return NUMBER_VAL((rand() % 20001 - 10000) / 100.0);
+    }
+}
+
+// bit for bit, so a -0 where there should be a +0 shows up
+static bool sameResult(Value a, Value b) {
+    if (IS_NUMBER(a) && IS_NUMBER(b)) {
+        double x = AS_NUMBER(a), y = AS_NUMBER(b);
+        return (isnan(x) && isnan(y)) || memcmp(&x, &y, sizeof(x)) == 0;
+    }
+    return valuesEqual(a, b);
+}
+
+static void check(const char* src, Program* direct, Program* optimized,
+                  const Value* inputs) {
+    Value expected, actual;
+    InterpretResult expectedRes = runProgram(direct, inputs, &expected);
+    InterpretResult actualRes = runProgram(optimized, inputs, &actual);
+
+    if (expectedRes != actualRes ||
+            (expectedRes == INTERPRET_OK && !sameResult(expected, actual))) {
+        printf("MISMATCH: %s\n    direct: ", src);
+        printValue(expected);
+        printf("\n    ir:     ");
+        printValue(actual);
+        printf("\n");
+        failures++;
+    }
+}
+
+int main(int argc, const char* argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 2000;
+    unsigned seed = argc > 2 ? (unsigned)atoi(argv[2]) : 1234;
+    srand(seed);
+
+    initVM();
+
+    Program** direct = malloc(sizeof(Program*) * count);
+    Program** optimized = malloc(sizeof(Program*) * count);
+
+    Program* loxProgram = compileProgram("\"lox\"", NULL, 0);
+    lox = loxProgram -> chunk.constants.values[0];
+
+    Value (*rows)[INPUT_COUNT] = malloc(sizeof(*rows) * ROWS);
+    for (int r = 0; r < ROWS; r++)
+        for (int i = 0; i < INPUT_COUNT; i++)
+            rows[r][i] = randomInput(i);
+
+    size_t directBytes = 0, optimizedBytes = 0;
+
+    for (int e = 0; e < count; e++) {
+        Source src = {.length = 0};
+        reusedCount = 0;
+        if (rand() % 2)
+            genNumber(&src, 2 + rand() % 5);
+        else
+            genBool(&src, 2 + rand() % 5);
+
+        setCompilerIr(false);
+        direct[e] = compileProgram(src.chars, inputNames, INPUT_COUNT);
+        setCompilerIr(true);
+        optimized[e] = compileProgram(src.chars, inputNames, INPUT_COUNT);
+
+        directBytes += direct[e] -> chunk.count;
+        optimizedBytes += optimized[e] -> chunk.count;
+
+        for (int r = 0; r < ROWS; r++)
+            check(src.chars, direct[e], optimized[e], rows[r]);
+    }
+
+    printf("%d expressions, %d mismatches\n", count, failures);
+    printf("%zu bytes of code direct, %zu through the ir\n", directBytes,
+        optimizedBytes);
+
+    IrStats stats = getIrStats();
+    printf("%-12s %12s %12s\n", "pass", "nodes", "instructions");
+    for (int i = 0; i < IR_PASS_COUNT; i++)
+        printf("%-12s %12zu %12zu\n", passNames[i], stats.nodes[i],
+            stats.instructions[i]);
+
+    Value result;
+    double start = nowNanos();
+    for (int rep = 0; rep < TIMING_REPS; rep++)
+        for (int e = 0; e < count; e++)
+            runProgram(direct[e], rows[rep % ROWS], &result);
+    double directTime = nowNanos() - start;
+
+    start = nowNanos();
+    for (int rep = 0; rep < TIMING_REPS; rep++)
+        for (int e = 0; e < count; e++)
+            runProgram(optimized[e], rows[rep % ROWS], &result);
+    double optimizedTime = nowNanos() - start;
+
+    double runs = (double)count * TIMING_REPS;
+    printf("direct %8.1f ns/run\n", directTime / runs);
+    printf("ir     %8.1f ns/run  (%.2fx)\n", optimizedTime / runs,
+        directTime / optimizedTime);
+
+    for (int e = 0; e < count; e++) {
+        freeProgram(direct[e]);
+        freeProgram(optimized[e]);
+    }
+    freeProgram(loxProgram);
+    free(rows);
+    free(optimized);
+    free(direct);
+
+    freeVM();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,414 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "chunk.h"
+#include "jit.h"
+#include "memory.h"
+#include "operand.h"
+
+// a template JIT: each opcode becomes a fixed run of SSE2...
+// ... instructions, w/ the VM's stack mapped onto xmm registers...
+// ... (slot n lives in xmmn) instead of memory
+//
+// a chunk w/out control flow has a type for every slot that's...
+// ... known at compile time, except for inputs, which are checked...
+// ... as they're loaded; numbers are doubles and bools are 1.0 or...
+// ... 0.0, so neither needs a tag until the result is boxed
+//
+// the generated function is `int f(const Value* inputs, double* out)`...
+// ... returning 0 w/ the result in `*out`, or 1 when an input...
+// ... wasn't a number and the interpreter has to run it instead
+
+#if defined(__x86_64__) && defined(__unix__)
+#define JIT_SUPPORTED
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// xmm0-13 hold the stack, xmm14 holds 1.0 and xmm15 is scratch
+#define JIT_MAX_DEPTH 14
+#define XMM_ONE 14
+#define XMM_SCRATCH 15
+
+struct JitFunction {
+    uint8_t* code;
+    size_t mappedSize;
+    size_t codeSize;
+    ValueType resultType;   // VAL_NUMBER or VAL_BOOL
+};
+
+typedef int (*NativeFn)(const Value* inputs, double* out);
+
+#ifdef JIT_SUPPORTED
+
+typedef struct {
+    uint8_t* bytes;
+    int count;
+    int capacity;
+
+    // offsets of the rel32s of the jumps to the bail-out stub
+    int* bails;
+    int bailCount;
+    int bailCapacity;
+} Assembler;
+
+static void emit(Assembler* as, uint8_t byte) {
+    if (as -> capacity < as -> count + 1) {
+        int oldCapacity = as -> capacity;
+        as -> capacity = GROW_CAPACITY(oldCapacity);
+        as -> bytes = GROW_ARRAY(uint8_t, as -> bytes, oldCapacity,
+            as -> capacity, MEM_CHUNK_CODE);
+    }
+
+    as -> bytes[as -> count++] = byte;
+}
+
+static void emit32(Assembler* as, uint32_t word) {
+    for (int i = 0; i < 4; i++)
+        emit(as, (uint8_t)(word >> (8 * i)));
+}
+
+static void emit64(Assembler* as, uint64_t word) {
+    for (int i = 0; i < 8; i++)
+        emit(as, (uint8_t)(word >> (8 * i)));
+}
+
+// REX w/ the high bits of the ModRM reg and rm fields, if needed
+static void emitRex(Assembler* as, bool wide, int reg, int rm) {
+    uint8_t rex = 0x40 | (wide ? 0x08 : 0) | (reg >= 8 ? 0x04 : 0) |
+        (rm >= 8 ? 0x01 : 0);
+    if (rex != 0x40)
+        emit(as, rex);
+}
+
+// `op xmm<reg>, xmm<rm>` w/ a mandatory prefix (0x66 or 0xF2)
+static void sse(Assembler* as, uint8_t prefix, uint8_t opcode, int reg,
+                int rm) {
+    emit(as, prefix);
+    emitRex(as, false, reg, rm);
+    emit(as, 0x0F);
+    emit(as, opcode);
+    emit(as, 0xC0 | (reg & 7) << 3 | (rm & 7));
+}
+
+#define ADDSD(as, dst, src)     sse(as, 0xF2, 0x58, dst, src)
+#define SUBSD(as, dst, src)     sse(as, 0xF2, 0x5C, dst, src)
+#define MULSD(as, dst, src)     sse(as, 0xF2, 0x59, dst, src)
+#define DIVSD(as, dst, src)     sse(as, 0xF2, 0x5E, dst, src)
+#define MOVAPD(as, dst, src)    sse(as, 0x66, 0x28, dst, src)
+#define ANDPD(as, dst, src)     sse(as, 0x66, 0x54, dst, src)
+#define XORPD(as, dst, src)     sse(as, 0x66, 0x57, dst, src)
+
+// cmpsd predicates
+#define CMP_EQ 0
+#define CMP_LT 1
+
+// dst = all ones if `dst <predicate> src`, else zero
+static void cmpsd(Assembler* as, int dst, int src, uint8_t predicate) {
+    sse(as, 0xF2, 0xC2, dst, src);
+    emit(as, predicate);
+}
+
+// xmm<dst> = the bits of `value`, by way of rax
+static void loadImmediate(Assembler* as, int dst, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    // mov rax, imm64
+    emit(as, 0x48);
+    emit(as, 0xB8);
+    emit64(as, bits);
+
+    // movq xmm<dst>, rax
+    emit(as, 0x66);
+    emitRex(as, true, dst, 0);
+    emit(as, 0x0F);
+    emit(as, 0x6E);
+    emit(as, 0xC0 | (dst & 7) << 3);
+}
+
+// xmm<dst> = inputs[index], bailing out unless it's a number
+static void loadInput(Assembler* as, int dst, uint32_t index) {
+    uint32_t offset = index * sizeof(Value);
+
+    // cmp dword [rdi + offset], VAL_NUMBER
+    emit(as, 0x81);
+    emit(as, 0xBF);
+    emit32(as, offset + offsetof(Value, type));
+    emit32(as, VAL_NUMBER);
+
+    // jne bail
+    emit(as, 0x0F);
+    emit(as, 0x85);
+    if (as -> bailCapacity < as -> bailCount + 1) {
+        int oldCapacity = as -> bailCapacity;
+        as -> bailCapacity = GROW_CAPACITY(oldCapacity);
+        as -> bails = GROW_ARRAY(int, as -> bails, oldCapacity,
+            as -> bailCapacity, MEM_CHUNK_CODE);
+    }
+    as -> bails[as -> bailCount++] = as -> count;
+    emit32(as, 0);
+
+    // movsd xmm<dst>, [rdi + offset]
+    emit(as, 0xF2);
+    emitRex(as, false, dst, 0);
+    emit(as, 0x0F);
+    emit(as, 0x10);
+    emit(as, 0x80 | (dst & 7) << 3 | 7);
+    emit32(as, offset + offsetof(Value, as));
+}
+
+// *out = xmm<src>, return 0, then the bail-out stub
+static void emitEpilogue(Assembler* as, int src) {
+    // movsd [rsi], xmm<src>
+    emit(as, 0xF2);
+    emitRex(as, false, src, 0);
+    emit(as, 0x0F);
+    emit(as, 0x11);
+    emit(as, (src & 7) << 3 | 6);
+
+    // xor eax, eax; ret
+    emit(as, 0x31);
+    emit(as, 0xC0);
+    emit(as, 0xC3);
+
+    int bail = as -> count;
+
+    // mov eax, 1; ret
+    emit(as, 0xB8);
+    emit32(as, 1);
+    emit(as, 0xC3);
+
+    for (int i = 0; i < as -> bailCount; i++) {
+        int at = as -> bails[i];
+        int32_t rel = bail - (at + 4);
+        memcpy(&as -> bytes[at], &rel, sizeof(rel));
+    }
+}
+
+typedef enum {
+    SLOT_NUMBER,
+    SLOT_BOOL,
+} SlotType;
+
+// translates the chunk, returns false for anything it doesn't do
+static bool assemble(Assembler* as, Chunk* chunk, ValueType* resultType) {
+    SlotType types[JIT_MAX_DEPTH];
+    int depth = 0;
+
+    loadImmediate(as, XMM_ONE, 1.0);
+
+    uint8_t* ip = chunk -> code;
+    for (;;) {
+        uint8_t instruction = *ip++;
+
+        // everything but these pushes or leaves the depth alone
+        bool pushes = instruction == OP_CONSTANT ||
+            instruction == OP_CONSTANT_LONG || instruction == OP_TRUE ||
+            instruction == OP_FALSE || instruction == OP_GET_INPUT;
+        if (pushes && depth == JIT_MAX_DEPTH)
+            return false;
+
+        switch (instruction) {
+            case OP_CONSTANT:
+            case OP_CONSTANT_LONG: {
+                uint32_t index = instruction == OP_CONSTANT ?
+                    *ip++ : decodeOperand(&ip);
+
+                Value constant = chunk -> constants.values[index];
+                if (!IS_NUMBER(constant))
+                    return false;
+
+                loadImmediate(as, depth, AS_NUMBER(constant));
+                types[depth++] = SLOT_NUMBER;
+                break;
+            }
+
+            case OP_TRUE:
+                MOVAPD(as, depth, XMM_ONE);
+                types[depth++] = SLOT_BOOL;
+                break;
+
+            case OP_FALSE:
+                XORPD(as, depth, depth);
+                types[depth++] = SLOT_BOOL;
+                break;
+
+            case OP_GET_INPUT:
+                loadInput(as, depth, decodeOperand(&ip));
+                types[depth++] = SLOT_NUMBER;
+                break;
+
+            case OP_EQUAL: {
+                int a = depth - 2, b = depth - 1;
+
+                // a number never equals a bool
+                if (types[a] != types[b])
+                    XORPD(as, a, a);
+                else {
+                    cmpsd(as, a, b, CMP_EQ);
+                    ANDPD(as, a, XMM_ONE);
+                }
+
+                types[a] = SLOT_BOOL;
+                depth--;
+                break;
+            }
+
+            case OP_GREATER:
+            case OP_LESS:
+            case OP_ADD:
+            case OP_SUBTRACT:
+            case OP_MULTIPLY:
+            case OP_DIVIDE: {
+                int a = depth - 2, b = depth - 1;
+
+                // the interpreter reports the error
+                if (types[a] != SLOT_NUMBER || types[b] != SLOT_NUMBER)
+                    return false;
+
+                switch (instruction) {
+                    case OP_GREATER:
+                        // b < a, which is false for NaN like `>`
+                        MOVAPD(as, XMM_SCRATCH, b);
+                        cmpsd(as, XMM_SCRATCH, a, CMP_LT);
+                        MOVAPD(as, a, XMM_SCRATCH);
+                        ANDPD(as, a, XMM_ONE);
+                        types[a] = SLOT_BOOL;
+                        break;
+                    case OP_LESS:
+                        cmpsd(as, a, b, CMP_LT);
+                        ANDPD(as, a, XMM_ONE);
+                        types[a] = SLOT_BOOL;
+                        break;
+                    case OP_ADD:      ADDSD(as, a, b); break;
+                    case OP_SUBTRACT: SUBSD(as, a, b); break;
+                    case OP_MULTIPLY: MULSD(as, a, b); break;
+                    case OP_DIVIDE:   DIVSD(as, a, b); break;
+                }
+
+                depth--;
+                break;
+            }
+
+            case OP_NOT: {
+                int a = depth - 1;
+
+                // numbers are all truthy
+                if (types[a] == SLOT_NUMBER)
+                    XORPD(as, a, a);
+                else {
+                    MOVAPD(as, XMM_SCRATCH, XMM_ONE);
+                    SUBSD(as, XMM_SCRATCH, a);
+                    MOVAPD(as, a, XMM_SCRATCH);
+                }
+
+                types[a] = SLOT_BOOL;
+                break;
+            }
+
+            case OP_NEGATE: {
+                int a = depth - 1;
+                if (types[a] != SLOT_NUMBER)
+                    return false;
+
+                // flip the sign bit
+                loadImmediate(as, XMM_SCRATCH, -0.0);
+                XORPD(as, a, XMM_SCRATCH);
+                break;
+            }
+
+            case OP_RETURN:
+                emitEpilogue(as, depth - 1);
+                *resultType = types[depth - 1] == SLOT_NUMBER ?
+                    VAL_NUMBER : VAL_BOOL;
+                return true;
+
+            // nil and anything added later
+            default:
+                return false;
+        }
+    }
+}
+
+JitFunction* jitCompile(Program* program) {
+    Assembler as = {0};
+    ValueType resultType;
+
+    bool assembled = assemble(&as, &program -> chunk, &resultType);
+    FREE_ARRAY(int, as.bails, as.bailCapacity, MEM_CHUNK_CODE);
+
+    if (!assembled) {
+        FREE_ARRAY(uint8_t, as.bytes, as.capacity, MEM_CHUNK_CODE);
+        return NULL;
+    }
+
+    // written while writable, then made executable instead
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t mappedSize = (as.count + page - 1) / page * page;
+
+    void* code = mmap(NULL, mappedSize, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (code == MAP_FAILED) {
+        FREE_ARRAY(uint8_t, as.bytes, as.capacity, MEM_CHUNK_CODE);
+        return NULL;
+    }
+
+    memcpy(code, as.bytes, as.count);
+    FREE_ARRAY(uint8_t, as.bytes, as.capacity, MEM_CHUNK_CODE);
+
+    if (mprotect(code, mappedSize, PROT_READ | PROT_EXEC) != 0) {
+        munmap(code, mappedSize);
+        return NULL;
+    }
+
+    JitFunction* function = ALLOCATE(JitFunction, 1, MEM_CHUNK_CODE);
+    function -> code = code;
+    function -> mappedSize = mappedSize;
+    function -> codeSize = (size_t)as.count;
+    function -> resultType = resultType;
+    return function;
+}
+
+void jitFree(JitFunction* function) {
+    if (function == NULL)
+        return;
+
+    munmap(function -> code, function -> mappedSize);
+    FREE(JitFunction, function, MEM_CHUNK_CODE);
+}
+
+#else
+
+JitFunction* jitCompile(Program* program) {
+    (void)program;
+    return NULL;
+}
+
+void jitFree(JitFunction* function) {
+    (void)function;
+}
+
+#endif
+
+InterpretResult jitRun(JitFunction* function, Program* program,
+                       const Value* inputs, Value* result) {
+    if (function == NULL)
+        return runProgram(program, inputs, result);
+
+    // ISO C has no cast from a data ptr to a function ptr
+    NativeFn native;
+    memcpy(&native, &function -> code, sizeof(native));
+
+    double out;
+    if (native(inputs, &out) != 0)
+        return runProgram(program, inputs, result);
+
+    *result = function -> resultType == VAL_NUMBER ?
+        NUMBER_VAL(out) : BOOL_VAL(out != 0.0);
+    return INTERPRET_OK;
+}
+
+size_t jitCodeSize(JitFunction* function) {
+    return function == NULL ? 0 : function -> codeSize;
+}
@@ -0,0 +1,29 @@
+#ifndef clox_jit_h
+#define clox_jit_h
+
+#include "common.h"
+#include "value.h"
+#include "vm.h"
+
+// a program translated to native x86-64 code, see jit.c
+typedef struct JitFunction JitFunction;
+
+// translates a program made of number and bool constants,...
+// ... inputs and the arithmetic, comparison and logic opcodes;...
+// ... NULL for anything else (strings, nil, a type error known...
+// ... at compile time) or off x86-64, so `runProgram()` it instead
+JitFunction* jitCompile(Program* program);
+
+// runs the native code, or the program through `runProgram()`...
+// ... when an input isn't a number, so the result is always...
+// ... what the interpreter would give
+InterpretResult jitRun(JitFunction* function, Program* program,
+                       const Value* inputs, Value* result);
+
+// frees the native code
+void jitFree(JitFunction* function);
+
+// bytes of native code, for reports
+size_t jitCodeSize(JitFunction* function);
+
+#endif
@@ -0,0 +1,248 @@
+// differential test of the JIT: a generated corpus of expressions...
+// ... is run through both the JIT and the interpreter, w/ random...
+// ... inputs, and every result has to match; then the ones the...
+// ... JIT compiled are timed both ways...
+// ... usage: jit_test [expressions] [seed]
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "common.h"
+#include "jit.h"
+#include "memory.h"
+#include "value.h"
+#include "vm.h"
+
+#define INPUT_COUNT 3
+#define ROWS 8
+#define TIMING_REPS 2000
+#define MAX_SRC 4096
+
+static const char* const inputNames[INPUT_COUNT] = {"x", "y", "z"};
+
+static int failures = 0;
+
+static double nowNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+typedef struct {
+    char chars[MAX_SRC];
+    int length;
+} Source;
+
+static void append(Source* src, const char* text) {
+    while (*text != '\0' && src -> length < MAX_SRC - 1)
+        src -> chars[src -> length++] = *text++;
+    src -> chars[src -> length] = '\0';
+}
+
+static void genBool(Source* src, int depth);
+
+// an expression that evaluates to a number
+static void genNumber(Source* src, int depth) {
+    static const char* operators[] = {" + ", " - ", " * ", " / "};
+    char literal[32];
+
+    if (depth == 0 || rand() % 4 == 0) {
+        switch (rand() % 3) {
+            case 0:
+                snprintf(literal, sizeof(literal), "%d", rand() % 100);
+                append(src, literal);
+                break;
+            case 1:
+                snprintf(literal, sizeof(literal), "%d.%d", rand() % 100,
+                    rand() % 1000);
+                append(src, literal);
+                break;
+            default:
+                append(src, inputNames[rand() % INPUT_COUNT]);
+                break;
+        }
+        return;
+    }
+
+    if (rand() % 5 == 0) {
+        append(src, "-");
+        genNumber(src, depth - 1);
+        return;
+    }
+
+    append(src, "(");
+    genNumber(src, depth - 1);
+    append(src, operators[rand() % 4]);
+    genNumber(src, depth - 1);
+    append(src, ")");
+}
+
+// an expression that evaluates to a bool, a few w/ nil or...
+// ... strings in them so the JIT has something to turn down
+static void genBool(Source* src, int depth) {
+    static const char* comparisons[] = {
+        " < ", " > ", " <= ", " >= ", " == ", " != "
+    };
+
+    if (depth == 0) {
+        append(src, rand() % 2 ? "true" : "false");
+        return;
+    }
+
+    append(src, "(");
+    switch (rand() % 6) {
+        case 0:
+        case 1:
+        case 2:
+            genNumber(src, depth - 1);
+            append(src, comparisons[rand() % 6]);
+            genNumber(src, depth - 1);
+            break;
+        case 3:
+            append(src, "!");
+            genBool(src, depth - 1);
+            break;
+        case 4:
+            genBool(src, depth - 1);
+            append(src, rand() % 2 ? " == " : " != ");
+            if (rand() % 2)
+                genBool(src, depth - 1);
+            else
+                genNumber(src, depth - 1);
+            break;
+        default:
+            genNumber(src, depth - 1);
+            append(src, " == ");
+            append(src, rand() % 2 ? "nil" : "\"lox\"");
+            break;
+    }
+    append(src, ")");
+}
+
+static double randomInput(void) {
+    switch (rand() % 4) {
+        case 0:  return 0.0;
+        case 1:  return (double)(rand() % 100);
+        default: return (rand() % 20001 - 10000) / 100.0;
+    }
+}
+
+static bool sameResult(Value a, Value b) {
+    if (IS_NUMBER(a) && IS_NUMBER(b) &&
+            isnan(AS_NUMBER(a)) && isnan(AS_NUMBER(b)))
+        return true;
+    return valuesEqual(a, b);
+}
+
+static void check(const char* src, Program* program, JitFunction* function,
+                  const Value* inputs) {
+    Value expected, actual;
+    InterpretResult expectedRes = runProgram(program, inputs, &expected);
+    InterpretResult actualRes = jitRun(function, program, inputs, &actual);
+
+    if (expectedRes != actualRes ||
+            (expectedRes == INTERPRET_OK && !sameResult(expected, actual))) {
+        printf("MISMATCH: %s\n    interpreter: ", src);
+        printValue(expected);
+        printf("\n    jit:         ");
+        printValue(actual);
+        printf("\n");
+        failures++;
+    }
+}
+
+// a bool input where a number was compiled for has to bail out
+static void testGuard(void) {
+    Program* program = compileProgram("x == true", inputNames, INPUT_COUNT);
+    JitFunction* function = jitCompile(program);
+
+    Value inputs[INPUT_COUNT] = {BOOL_VAL(true), NUMBER_VAL(0),
+        NUMBER_VAL(0)};
+    check("x == true (x = true)", program, function, inputs);
+
+    inputs[0] = NUMBER_VAL(1);
+    check("x == true (x = 1)", program, function, inputs);
+
+    jitFree(function);
+    freeProgram(program);
+}
+
+int main(int argc, const char* argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 2000;
+    unsigned seed = argc > 2 ? (unsigned)atoi(argv[2]) : 1234;
+    srand(seed);
+
+    initVM();
+
+    Program** programs = malloc(sizeof(Program*) * count);
+    JitFunction** functions = malloc(sizeof(JitFunction*) * count);
+    Value (*rows)[INPUT_COUNT] = malloc(sizeof(*rows) * ROWS);
+
+    for (int r = 0; r < ROWS; r++)
+        for (int i = 0; i < INPUT_COUNT; i++)
+            rows[r][i] = NUMBER_VAL(randomInput());
+
+    int compiled = 0;
+    size_t codeBytes = 0;
+
+    for (int e = 0; e < count; e++) {
+        Source src = {.length = 0};
+        if (rand() % 2)
+            genNumber(&src, 1 + rand() % 6);
+        else
+            genBool(&src, 1 + rand() % 6);
+
+        programs[e] = compileProgram(src.chars, inputNames, INPUT_COUNT);
+        functions[e] = jitCompile(programs[e]);
+
+        if (functions[e] != NULL) {
+            compiled++;
+            codeBytes += jitCodeSize(functions[e]);
+        }
+
+        for (int r = 0; r < ROWS; r++)
+            check(src.chars, programs[e], functions[e], rows[r]);
+    }
+
+    testGuard();
+
+    printf("%d expressions, %d compiled (%.1f%%), %zu bytes of code\n",
+        count, compiled, 100.0 * compiled / count, codeBytes);
+    printf("%d mismatches\n", failures);
+
+    // only what the JIT compiled is timed, the rest runs the same
+    Value result;
+    double start = nowNanos();
+    for (int rep = 0; rep < TIMING_REPS; rep++)
+        for (int e = 0; e < count; e++)
+            if (functions[e] != NULL)
+                runProgram(programs[e], rows[rep % ROWS], &result);
+    double interpretTime = nowNanos() - start;
+
+    start = nowNanos();
+    for (int rep = 0; rep < TIMING_REPS; rep++)
+        for (int e = 0; e < count; e++)
+            if (functions[e] != NULL)
+                jitRun(functions[e], programs[e], rows[rep % ROWS], &result);
+    double jitTime = nowNanos() - start;
+
+    double runs = (double)compiled * TIMING_REPS;
+    printf("interpreter %8.1f ns/run\n", interpretTime / runs);
+    printf("jit         %8.1f ns/run  (%.2fx)\n", jitTime / runs,
+        interpretTime / jitTime);
+
+    for (int e = 0; e < count; e++) {
+        jitFree(functions[e]);
+        freeProgram(programs[e]);
+    }
+    free(rows);
+    free(functions);
+    free(programs);
+
+    freeVM();
+    return failures == 0 ? 0 : 1;
+}
@@ -3,13 +3,21 @@
 #include <string.h>
 
 #include "common.h"
+#include "aot.h"
+#include "cache.h"
 #include "chunk.h"
+#include "compiler.h"
 #include "debug.h"
+#include "ir.h"
+#include "memory.h"
+#include "output.h"
 #include "vm.h"
 
 static void repl(void) {
     char line[1024];
     for (;;) {
+        // the last line's result, before the prompt
+        flushOutput();
         printf("> ");
 
         if (!fgets(line, sizeof(line), stdin)) {
@@ -74,9 +82,65 @@ static void runFile(const char* path) {
         exit(70);
 }
 
+// translates a script to C instead of running it, see aot.h
+static void emitFile(const char* path, const char* outPath) {
+    char* src = readFile(path);
+
+    Chunk chunk;
+    initChunk(&chunk);
+    if (!compile(src, &chunk))
+        exit(65);
+
+    FILE* out = fopen(outPath, "w");
+    if (out == NULL) {
+        fprintf(stderr, "couldn't open file \"%s\"\n", outPath);
+        exit(74);
+    }
+
+    bool emitted = emitC(&chunk, path, out);
+    fclose(out);
+
+    freeChunk(&chunk);
+    free(src);
+
+    if (!emitted) {
+        fprintf(stderr, "\"%s\" can't be compiled ahead of time\n", path);
+        exit(65);
+    }
+}
+
 int main(int argc, const char* argv[]) {
+    // the exits below skip `freeVM()`, which would flush it too
+    atexit(flushOutput);
+
+    // `--mem-stats` reports the allocator's books (and the...
+    // ... chunk cache's counters) at exit...
+    // ... `atexit()` makes sure the error exits report too
+    if (argc > 1 && strcmp(argv[1], "--mem-stats") == 0) {
+        atexit(printChunkCacheStats);
+        atexit(printMemStats);
+        argc--;
+        argv++;
+    }
+
+    // `--ir` compiles through the optimizing IR and reports...
+    // ... what each of its passes left at exit
+    if (argc > 1 && strcmp(argv[1], "--ir") == 0) {
+        setCompilerIr(true);
+        atexit(printIrStats);
+        argc--;
+        argv++;
+    }
+
     initVM();
 
+    // `--emit-c script.lox out.c` writes C to build instead
+    if (argc == 4 && strcmp(argv[1], "--emit-c") == 0) {
+        emitFile(argv[2], argv[3]);
+        freeVM();
+        return 0;
+    }
+
     if (argc == 1) {
         repl();
     }
@@ -84,7 +148,8 @@ int main(int argc, const char* argv[]) {
         runFile(argv[1]);
     }
     else {
-        fprintf(stderr, "usage: clox [path]\n");
+        fprintf(stderr, "usage: clox [--mem-stats] [--ir] [path]\n"
+            "       clox [--ir] --emit-c path out.c\n");
 
         // command-line usage error
         exit(64);
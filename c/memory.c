@@ -1,9 +1,53 @@
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "memory.h"
 #include "vm.h"
 
-void* reallocate(void* ptr, size_t oldSize, size_t newSize) {
+// the next cycle starts once the heap has grown by this factor
+#define GC_HEAP_GROW_FACTOR 2
+
+// `new_realloc()` hides the block's size in front of it...
+// ... the union keeps the block itself maximally aligned
+typedef union {
+    size_t size;
+    max_align_t align;
+} AllocHeader;
+
+static MemStats memStats;
+
+// brings the books up to date after a block of one...
+// ... category went from `oldSize` to `newSize` bytes
+static void account(MemCategory category, size_t oldSize,
+                    size_t newSize) {
+    MemCategoryStats* stats = &memStats.categories[category];
+
+    if (oldSize == 0 && newSize != 0)
+        stats -> allocations++;
+    else if (oldSize != 0 && newSize == 0)
+        stats -> frees++;
+    else if (oldSize != newSize)
+        stats -> reallocations++;
+
+    stats -> bytes = stats -> bytes - oldSize + newSize;
+    memStats.bytes = memStats.bytes - oldSize + newSize;
+
+    if (stats -> bytes > stats -> peakBytes)
+        stats -> peakBytes = stats -> bytes;
+    if (memStats.bytes > memStats.peakBytes)
+        memStats.peakBytes = memStats.bytes;
+
+    // growing past the threshold only starts a cycle...
+    // ... the work itself is done in slices by `run()`
+    if (newSize > oldSize && vm.gcPhase == GC_IDLE &&
+            memStats.bytes > vm.nextGC)
+        startGC();
+}
+
+void* reallocate(void* ptr, size_t oldSize, size_t newSize,
+                 MemCategory category) {
+    account(category, ptr == NULL ? 0 : oldSize, newSize);
+
     if (newSize == 0) {
         free(ptr);
         return NULL;
@@ -16,17 +60,24 @@ void* reallocate(void* ptr, size_t oldSize, size_t newSize) {
     return res;
 }
 
-void* new_realloc(void* ptr, size_t newSize) {
+void* new_realloc(void* ptr, size_t newSize, MemCategory category) {
+    // step back to the header, if there is a block at all
+    AllocHeader* header = ptr == NULL ? NULL : (AllocHeader*)ptr - 1;
+    size_t oldSize = header == NULL ? 0 : header -> size;
+
+    account(category, oldSize, newSize);
+
     if (newSize == 0) {
-        free(ptr);
+        free(header);
         return NULL;
     }
 
-    void* res = realloc(ptr, newSize);
-    if (res == NULL)
+    header = realloc(header, sizeof(AllocHeader) + newSize);
+    if (header == NULL)
         exit(1);
 
-    return res;
+    header -> size = newSize;
+    return header + 1;
 }
 
 static void freeObject(Obj* object) {
@@ -35,8 +86,9 @@ static void freeObject(Obj* object) {
             ObjString* str = (ObjString*)object;
 
             // free the char arr and then free the ObjString
-            FREE_ARRAY(char, str -> chars, str -> length + 1);
-            FREE(ObjString, object);
+            FREE_ARRAY(char, str -> chars, str -> length + 1,
+                MEM_STRINGS);
+            FREE(ObjString, object, MEM_STRINGS);
 
             break;
         }
@@ -52,4 +104,242 @@ void freeObjects(void) {
         freeObject(object);
         object = next;
     }
+
+    // the gray stack isn't on the books, see `markObject()`
+    free(vm.grayStack);
+    vm.grayStack = NULL;
+    vm.grayCount = 0;
+    vm.grayCapacity = 0;
+}
+
+// tri-color marking: an object is white while `isMarked`...
+// ... differs from `vm.markBit`, gray once marked and on the...
+// ... gray stack, and black once marked and popped off it;...
+// ... flipping `vm.markBit` turns every object white at once
+
+void markObject(Obj* object) {
+    if (object == NULL || object -> isMarked == vm.markBit)
+        return;
+
+    #ifdef DEBUG_LOG_GC
+    printf("%p mark ", (void*)object);
+    printValue(OBJ_VAL(object));
+    printf("\n");
+    #endif
+
+    object -> isMarked = vm.markBit;
+
+    // the gray stack uses the system `realloc()` so that...
+    // ... growing it can never start a cycle of its own
+    if (vm.grayCapacity < vm.grayCount + 1) {
+        vm.grayCapacity = GROW_CAPACITY(vm.grayCapacity);
+        vm.grayStack = (Obj**)realloc(vm.grayStack,
+            sizeof(Obj*) * vm.grayCapacity);
+
+        if (vm.grayStack == NULL)
+            exit(1);
+    }
+
+    vm.grayStack[vm.grayCount++] = object;
+}
+
+void markValue(Value value) {
+    if (IS_OBJ(value))
+        markObject(AS_OBJ(value));
+}
+
+void writeBarrier(Value value) {
+    // only a cycle that is marking can miss the store
+    if (vm.gcPhase == GC_MARK)
+        markValue(value);
+}
+
+// marks up to `budget` of the running chunk's constants and...
+// ... returns what's left of the budget; there can be millions...
+// ... of constants, so unlike the stack they are done in slices
+static int markConstants(int budget) {
+    // a different chunk is running, start over on it...
+    // ... (constants of a chunk compiled during the cycle...
+    // ... are black anyway, see `allocateObject()`)
+    if (vm.chunk != vm.rootChunk) {
+        vm.rootChunk = vm.chunk;
+        vm.rootCursor = 0;
+    }
+
+    if (vm.rootChunk == NULL)
+        return budget;
+
+    ValueArray* constants = &vm.rootChunk -> constants;
+    while (budget > 0 && vm.rootCursor < constants -> count) {
+        markValue(constants -> values[vm.rootCursor++]);
+        budget--;
+    }
+
+    return budget;
+}
+
+static bool constantsMarked(void) {
+    return vm.rootChunk == NULL ||
+        vm.rootCursor >= vm.rootChunk -> constants.count;
+}
+
+// marks everything a gray object refers to, making it black
+static void blackenObject(Obj* object) {
+    switch (object -> type) {
+        // strings don't refer to other objects
+        case OBJ_STRING:
+            break;
+    }
+}
+
+void startGC(void) {
+    #ifdef DEBUG_LOG_GC
+    printf("-- gc begin\n");
+    #endif
+
+    vm.markBit = !vm.markBit;
+    vm.grayCount = 0;
+    vm.gcPhase = GC_MARK;
+
+    // collector work only happens between instructions, so...
+    // ... the chunk being compiled is `vm.chunk` by the time...
+    // ... anything could be swept
+    vm.rootChunk = vm.chunk;
+    vm.rootCursor = 0;
+
+    // the VM's stack
+    for (int i = 0; i < vm.count; i++)
+        markValue(vm.dyn_stack[i]);
+
+    // the running program's inputs
+    for (int i = 0; i < vm.inputCount; i++)
+        markValue(vm.inputs[i]);
+
+    // compiled programs can be run again, so their constants...
+    // ... live as long as they do (they're few, unlike a...
+    // ... script's, so they aren't done in slices)
+    for (Program* program = vm.programs; program != NULL;
+            program = program -> next) {
+        ValueArray* constants = &program -> chunk.constants;
+        for (int i = 0; i < constants -> count; i++)
+            markValue(constants -> values[i]);
+    }
+}
+
+static void finishGC(void) {
+    vm.gcPhase = GC_IDLE;
+    vm.rootChunk = NULL;
+    vm.sweepLink = NULL;
+    vm.nextGC = memStats.bytes * GC_HEAP_GROW_FACTOR;
+
+    if (vm.nextGC < GC_INITIAL_NEXT_GC)
+        vm.nextGC = GC_INITIAL_NEXT_GC;
+
+    #ifdef DEBUG_LOG_GC
+    printf("-- gc end, next at %zu\n", vm.nextGC);
+    #endif
+}
+
+bool gcStep(void) {
+    int budget = vm.gcSliceBudget;
+
+    if (vm.gcPhase == GC_MARK) {
+        budget = markConstants(budget);
+
+        while (budget > 0 && vm.grayCount > 0) {
+            blackenObject(vm.grayStack[--vm.grayCount]);
+            budget--;
+        }
+
+        // the write barrier keeps new references gray, so an...
+        // ... empty gray stack means marking is done
+        if (vm.grayCount == 0 && constantsMarked()) {
+            vm.gcPhase = GC_SWEEP;
+            vm.sweepLink = &vm.objects;
+        }
+
+        return true;
+    }
+
+    if (vm.gcPhase == GC_SWEEP) {
+        // following the link, not an object, keeps this right...
+        // ... when new objects are pushed onto the list's head
+        while (budget > 0 && *vm.sweepLink != NULL) {
+            Obj* object = *vm.sweepLink;
+
+            if (object -> isMarked == vm.markBit)
+                vm.sweepLink = &object -> next;
+            else {
+                *vm.sweepLink = object -> next;
+                freeObject(object);
+            }
+
+            budget--;
+        }
+
+        if (*vm.sweepLink == NULL)
+            finishGC();
+
+        return vm.gcPhase != GC_IDLE;
+    }
+
+    return false;
+}
+
+void collectGarbage(void) {
+    // finish whatever cycle is already running first
+    while (gcStep())
+        ;
+
+    startGC();
+    while (gcStep())
+        ;
+}
+
+MemStats getMemStats(void) {
+    return memStats;
+}
+
+void resetMemStats(void) {
+    memStats = (MemStats){0};
+}
+
+const char* memCategoryName(MemCategory category) {
+    switch (category) {
+        case MEM_CHUNK_CODE:
+            return "chunk code";
+        case MEM_RLE_LINES:
+            return "rle lines";
+        case MEM_CONSTANTS:
+            return "constants";
+        case MEM_STACK:
+            return "stack";
+        case MEM_STRINGS:
+            return "strings";
+        case MEM_CACHE:
+            return "chunk cache";
+        case MEM_IR:
+            return "ir";
+
+        // in theory, unreachable
+        default:
+            return "unknown";
+    }
+}
+
+void printMemStats(void) {
+    fprintf(stderr, "==mem-stats==\n");
+    fprintf(stderr, "%-12s %12s %12s %8s %8s %8s\n", "category",
+        "live", "peak", "allocs", "reallocs", "frees");
+
+    for (int i = 0; i < MEM_CATEGORY_COUNT; i++) {
+        MemCategoryStats* stats = &memStats.categories[i];
+        fprintf(stderr, "%-12s %12zu %12zu %8zu %8zu %8zu\n",
+            memCategoryName((MemCategory)i), stats -> bytes,
+            stats -> peakBytes, stats -> allocations,
+            stats -> reallocations, stats -> frees);
+    }
+
+    fprintf(stderr, "%-12s %12zu %12zu\n", "total",
+        memStats.bytes, memStats.peakBytes);
 }
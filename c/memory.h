@@ -4,38 +4,112 @@
 #include "common.h"
 #include "object.h"
 
-#define ALLOCATE(type, count) \
-    (type*)reallocate(NULL, 0, sizeof(type) * (count))
+// what an allocation is for, so the books can be...
+// ... kept separately for each kind of data
+typedef enum {
+    MEM_CHUNK_CODE,
+    MEM_RLE_LINES,
+    MEM_CONSTANTS,
+    MEM_STACK,
+    MEM_STRINGS,
+    MEM_CACHE,
+    MEM_IR,
+    MEM_CATEGORY_COUNT
+} MemCategory;
 
-#define NEW_ALLOCATE(type, count) \
-    (type*)new_realloc(NULL, sizeof(type) * (count))
+// the books for a single category
+typedef struct {
+    size_t bytes;           // live bytes right now
+    size_t peakBytes;       // most live bytes ever seen
+    size_t allocations;     // fresh blocks handed out
+    size_t reallocations;   // existing blocks grown or shrunk
+    size_t frees;           // blocks given back
+} MemCategoryStats;
 
-#define FREE(type, ptr) reallocate(ptr, sizeof(type), 0)
+typedef struct {
+    MemCategoryStats categories[MEM_CATEGORY_COUNT];
 
-#define NEW_FREE(type, ptr) new_realloc(ptr, 0)
+    // totals across every category
+    size_t bytes;
+    size_t peakBytes;
+} MemStats;
+
+// where the incremental collector is in its cycle
+typedef enum {
+    GC_IDLE,
+    GC_MARK,
+    GC_SWEEP
+} GCPhase;
+
+#define ALLOCATE(type, count, category) \
+    (type*)reallocate(NULL, 0, sizeof(type) * (count), category)
+
+#define NEW_ALLOCATE(type, count, category) \
+    (type*)new_realloc(NULL, sizeof(type) * (count), category)
+
+#define FREE(type, ptr, category) \
+    reallocate(ptr, sizeof(type), 0, category)
+
+#define NEW_FREE(type, ptr, category) new_realloc(ptr, 0, category)
 
 #define GROW_CAPACITY(capacity) \
     ((capacity) < 8 ? 8 : (capacity) * 2)
 
 // pretties up `reallocate`, where the real work happens
-#define GROW_ARRAY(type, ptr, oldCount, newCount) \
+#define GROW_ARRAY(type, ptr, oldCount, newCount, category) \
     (type*)reallocate(ptr, sizeof(type) * (oldCount), \
-        sizeof(type) * (newCount))
+        sizeof(type) * (newCount), category)
 
 // pretties up `new_realloc`
-#define NEW_GROW_ARRAY(type, ptr, newCount) \
-    (type*)new_realloc(ptr, sizeof(type) * (newCount))
+#define NEW_GROW_ARRAY(type, ptr, newCount, category) \
+    (type*)new_realloc(ptr, sizeof(type) * (newCount), category)
 
-#define FREE_ARRAY(type, ptr, oldCount) \
-    reallocate(ptr, sizeof(type) * (oldCount), 0)
+#define FREE_ARRAY(type, ptr, oldCount, category) \
+    reallocate(ptr, sizeof(type) * (oldCount), 0, category)
 
-#define NEW_FREE_ARRAY(ptr) \
-    new_realloc(ptr, 0);
+#define NEW_FREE_ARRAY(ptr, category) \
+    new_realloc(ptr, 0, category);
 
-void* reallocate(void* ptr, size_t oldSize, size_t newSize);
+void* reallocate(void* ptr, size_t oldSize, size_t newSize,
+                 MemCategory category);
 
-void* new_realloc(void* ptr, size_t newSize);
+// doesn't need the old size, it keeps it in a...
+// ... small header in front of the block instead
+void* new_realloc(void* ptr, size_t newSize, MemCategory category);
 
 void freeObjects(void);
 
+// grays a reachable object...
+void markObject(Obj* object);
+
+// ... or the object inside a Value, if there is one
+void markValue(Value value);
+
+// must see every store of a Value into a location the...
+// ... collector may already have scanned (the stack, constants)
+void writeBarrier(Value value);
+
+// flips the mark bit and grays the stack, the constants...
+// ... are left to the slices
+void startGC(void);
+
+// does at most `vm.gcSliceBudget` units of marking or sweeping...
+// ... and returns false once the cycle is over
+bool gcStep(void);
+
+// runs a whole cycle (finishing the current one, if any)
+void collectGarbage(void);
+
+// a snapshot of the allocator's books
+MemStats getMemStats(void);
+
+// zeroes out the books
+void resetMemStats(void);
+
+// human-readable name of a category
+const char* memCategoryName(MemCategory category);
+
+// prints the books to stderr
+void printMemStats(void);
+
 #endif
@@ -0,0 +1,145 @@
+#include <stdio.h>
+
+#include "common.h"
+#include "chunk.h"
+#include "memory.h"
+#include "object.h"
+#include "vm.h"
+
+static int failures = 0;
+
+static void expect(const char* what, size_t actual, size_t expected) {
+    printf("%-40s %8zu (expected %zu)%s\n", what, actual, expected,
+        actual == expected ? "" : "  <-- FAILED");
+
+    if (actual != expected)
+        failures++;
+}
+
+void test_chunk_accounting(void) {
+    resetMemStats();
+
+    Chunk chunk;
+    initChunk(&chunk);
+
+    // 9 bytes on 9 lines forces one grow of the code array (8 -> 16)...
+    // ... and one grow of each of the two RLE arrays (8 -> 16)
+    for (int i = 0; i < 9; i++)
+        writeChunk(&chunk, OP_NIL, i + 1);
+
+    MemStats stats = getMemStats();
+    expect("chunk code live bytes",
+        stats.categories[MEM_CHUNK_CODE].bytes, 16);
+    expect("chunk code allocations",
+        stats.categories[MEM_CHUNK_CODE].allocations, 1);
+    expect("chunk code reallocations",
+        stats.categories[MEM_CHUNK_CODE].reallocations, 1);
+    expect("rle lines live bytes",
+        stats.categories[MEM_RLE_LINES].bytes, 2 * 16 * sizeof(int));
+
+    addConstant(&chunk, NUMBER_VAL(1.2));
+    stats = getMemStats();
+    expect("constants live bytes",
+        stats.categories[MEM_CONSTANTS].bytes, 8 * sizeof(Value));
+
+    freeChunk(&chunk);
+    stats = getMemStats();
+    expect("live bytes after freeChunk", stats.bytes, 0);
+    expect("peak bytes after freeChunk", stats.peakBytes,
+        16 + 2 * 16 * sizeof(int) + 8 * sizeof(Value));
+    expect("rle lines frees", stats.categories[MEM_RLE_LINES].frees, 2);
+}
+
+void test_new_realloc_accounting(void) {
+    resetMemStats();
+
+    // `new_realloc()` never sees the old size, so this checks...
+    // ... that it finds it on its own
+    int* values = NEW_GROW_ARRAY(int, NULL, 4, MEM_STACK);
+    values = NEW_GROW_ARRAY(int, values, 32, MEM_STACK);
+    values = NEW_GROW_ARRAY(int, values, 2, MEM_STACK);
+
+    MemStats stats = getMemStats();
+    expect("stack live bytes", stats.categories[MEM_STACK].bytes,
+        2 * sizeof(int));
+    expect("stack peak bytes", stats.categories[MEM_STACK].peakBytes,
+        32 * sizeof(int));
+
+    NEW_FREE_ARRAY(values, MEM_STACK);
+    stats = getMemStats();
+    expect("stack live bytes after free",
+        stats.categories[MEM_STACK].bytes, 0);
+    expect("stack frees", stats.categories[MEM_STACK].frees, 1);
+}
+
+void test_string_accounting(void) {
+    initVM();
+    resetMemStats();
+
+    copyString("hello", 5);
+
+    MemStats stats = getMemStats();
+    expect("strings live bytes", stats.categories[MEM_STRINGS].bytes,
+        sizeof(ObjString) + 6);
+
+    freeVM();
+    stats = getMemStats();
+    expect("strings live bytes after freeVM",
+        stats.categories[MEM_STRINGS].bytes, 0);
+}
+
+void test_collect_garbage(void) {
+    initVM();
+
+    Chunk chunk;
+    initChunk(&chunk);
+    vm.chunk = &chunk;
+
+    // one string the chunk keeps alive, one nothing refers to...
+    addConstant(&chunk, OBJ_VAL(copyString("live", 4)));
+    copyString("garbage", 7);
+
+    // ... and one on the stack, pushed in the middle of a cycle
+    startGC();
+    push(OBJ_VAL(copyString("pushed", 6)));
+    while (gcStep())
+        ;
+
+    MemStats stats = getMemStats();
+    expect("strings live bytes after a cycle",
+        stats.categories[MEM_STRINGS].bytes,
+        2 * sizeof(ObjString) + 5 + 7);
+
+    // popping the last reference makes it garbage
+    pop();
+    collectGarbage();
+    stats = getMemStats();
+    expect("strings live bytes after popping",
+        stats.categories[MEM_STRINGS].bytes, sizeof(ObjString) + 5);
+
+    vm.chunk = NULL;
+    freeChunk(&chunk);
+    freeVM();
+}
+
+int main(void) {
+    initVM();
+
+    printf("test_chunk_accounting:\n");
+    test_chunk_accounting();
+    printf("\n");
+
+    printf("test_new_realloc_accounting:\n");
+    test_new_realloc_accounting();
+    printf("\n");
+
+    printf("test_string_accounting:\n");
+    test_string_accounting();
+    printf("\n");
+
+    printf("test_collect_garbage:\n");
+    test_collect_garbage();
+    printf("\n");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -12,11 +12,15 @@
 // akin to an Obj constructor
 static Obj* allocateObject(size_t size, ObjType type) {
     // new Obj is created in the heap
-    Obj* object = (Obj*)reallocate(NULL, 0, size);
+    Obj* object = (Obj*)reallocate(NULL, 0, size, MEM_STRINGS);
 
     // field is initialized
     object -> type = type;
 
+    // allocated black: an object born during a cycle...
+    // ... survives it, the next flip turns it white
+    object -> isMarked = vm.markBit;
+
     // insert new Obj at the head...
     // ... or the tail depending on where you're looking
     object -> next = vm.objects;
@@ -45,7 +49,7 @@ ObjString* copyString(const char* chars, int length) {
     // allocate a new array on the heap big enough...
     // ... for the string's chars and a trailing...
     // ... terminator
-    char* heapChars = ALLOCATE(char, length + 1);
+    char* heapChars = ALLOCATE(char, length + 1, MEM_STRINGS);
 
     // copy over characters from the lexeme...
     // ... and terminates it...
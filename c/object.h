@@ -21,6 +21,11 @@ typedef enum {
 
 struct Obj {
     ObjType type;
+
+    // reached by the collector this cycle when it...
+    // ... equals `vm.markBit`, see memory.c
+    bool isMarked;
+
     struct Obj* next;
 };
 
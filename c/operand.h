@@ -0,0 +1,55 @@
+#ifndef clox_operand_h
+#define clox_operand_h
+
+#include "common.h"
+
+// variable-length operands: 7 bits per byte, low bits first,...
+// ... w/ the high bit set on every byte but the last...
+// ... 0-127 take one byte, up to 16383 two, up to 2^21 - 1...
+// ... three, and so on up to five bytes for a full uint32_t
+
+#define OPERAND_MAX_BYTES 5
+
+// # of bytes `operand` takes once encoded
+static inline int operandLength(uint32_t operand) {
+    int length = 1;
+    while (operand >= 0x80) {
+        operand >>= 7;
+        length++;
+    }
+    return length;
+}
+
+// encodes `operand` into `buffer`, which needs room for...
+// ... OPERAND_MAX_BYTES, and returns the # of bytes written
+static inline int encodeOperand(uint32_t operand, uint8_t* buffer) {
+    int length = 0;
+    while (operand >= 0x80) {
+        buffer[length++] = (uint8_t)(operand | 0x80);
+        operand >>= 7;
+    }
+    buffer[length++] = (uint8_t)operand;
+    return length;
+}
+
+// decodes the operand `*ip` pts at and leaves `*ip`...
+// ... pointing just past it
+static inline uint32_t decodeOperand(uint8_t** ip) {
+    uint8_t byte = *(*ip)++;
+
+    // the common case: a single byte
+    if (byte < 0x80)
+        return byte;
+
+    uint32_t operand = byte & 0x7f;
+    int shift = 7;
+    do {
+        byte = *(*ip)++;
+        operand |= (uint32_t)(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte >= 0x80);
+
+    return operand;
+}
+
+#endif
@@ -0,0 +1,111 @@
+// compares the variable-length constant operands against...
+// ... the old fixed three-byte OP_CONSTANT_LONG encoding...
+// ... usage: operand_bench [constants...]
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "common.h"
+#include "chunk.h"
+#include "memory.h"
+#include "operand.h"
+#include "vm.h"
+
+// how many times the operands are decoded per timing
+#define DECODE_PASSES 10
+
+static double nowNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// the bytes the old encoding needed for a chunk of...
+// ... `constants` loads: 1 + 1 below 256, else 1 + 3
+static size_t fixedCodeSize(int constants) {
+    size_t size = 0;
+    for (int i = 0; i < constants; i++)
+        size += i < 256 ? 2 : 4;
+    return size;
+}
+
+// the old encoding's operands, so they can be timed too
+static uint8_t* fixedOperands(int constants) {
+    uint8_t* bytes = malloc((size_t)constants * 3);
+    for (int i = 0; i < constants; i++) {
+        bytes[i * 3] = (uint8_t)(i >> 16);
+        bytes[i * 3 + 1] = (uint8_t)(i >> 8);
+        bytes[i * 3 + 2] = (uint8_t)i;
+    }
+    return bytes;
+}
+
+static void bench(int constants) {
+    Chunk chunk;
+    initChunk(&chunk);
+
+    for (int i = 0; i < constants; i++)
+        writeConstant(&chunk, NUMBER_VAL(i), 1);
+
+    size_t fixedSize = fixedCodeSize(constants);
+    uint8_t* fixed = fixedOperands(constants);
+
+    // decode every operand of the chunk...
+    uint64_t sum = 0;
+    double start = nowNanos();
+    for (int pass = 0; pass < DECODE_PASSES; pass++) {
+        uint8_t* ip = chunk.code;
+        uint8_t* end = chunk.code + chunk.count;
+        while (ip < end) {
+            if (*ip++ == OP_CONSTANT)
+                sum += *ip++;
+            else
+                sum += decodeOperand(&ip);
+        }
+    }
+    double varTime = nowNanos() - start;
+
+    // ... and the same operands in the old encoding
+    start = nowNanos();
+    for (int pass = 0; pass < DECODE_PASSES; pass++) {
+        for (int i = 0; i < constants; i++) {
+            uint8_t* bytes = &fixed[i * 3];
+            sum += ((uint32_t)bytes[0] << 16) | (bytes[1] << 8) |
+                bytes[2];
+        }
+    }
+    double fixedTime = nowNanos() - start;
+
+    double decodes = (double)constants * DECODE_PASSES;
+    printf("%9d %12zu %12d %8.2f%% %10.2f %10.2f   (%llu)\n", constants,
+        fixedSize, chunk.count,
+        100.0 * ((double)chunk.count - fixedSize) / fixedSize,
+        fixedTime / decodes, varTime / decodes,
+        (unsigned long long)sum);
+
+    free(fixed);
+    freeChunk(&chunk);
+}
+
+int main(int argc, const char* argv[]) {
+    initVM();
+
+    printf("%9s %12s %12s %9s %10s %10s\n", "constants", "fixed bytes",
+        "varint bytes", "change", "fixed ns", "varint ns");
+
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++)
+            bench(atoi(argv[i]));
+    }
+    else {
+        bench(10000);
+        bench(100000);
+        bench(1000000);
+    }
+
+    freeVM();
+    return 0;
+}
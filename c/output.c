@@ -0,0 +1,55 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "dtoa.h"
+#include "object.h"
+#include "output.h"
+
+static char buffer[OUTPUT_BUFFER_SIZE];
+static size_t length = 0;
+
+void flushOutput(void) {
+    if (length > 0)
+        fwrite(buffer, 1, length, stdout);
+    length = 0;
+
+    // so it's out before whatever's written next, stderr included
+    fflush(stdout);
+}
+
+void writeOutput(const char* chars, size_t count) {
+    if (length + count > OUTPUT_BUFFER_SIZE) {
+        flushOutput();
+
+        // too big to buffer at all, e.g. a long string
+        if (count > OUTPUT_BUFFER_SIZE) {
+            fwrite(chars, 1, count, stdout);
+            return;
+        }
+    }
+
+    memcpy(buffer + length, chars, count);
+    length += count;
+}
+
+void writeValue(Value value) {
+    switch (value.type) {
+        case VAL_BOOL:
+            if (AS_BOOL(value))
+                writeOutput("true", 4);
+            else
+                writeOutput("false", 5);
+            break;
+        case VAL_NIL:
+            writeOutput("nil", 3);
+            break;
+        case VAL_NUMBER:
+            if (length + NUMBER_MAX_CHARS > OUTPUT_BUFFER_SIZE)
+                flushOutput();
+            length += formatNumber(AS_NUMBER(value), buffer + length);
+            break;
+        case VAL_OBJ:
+            writeOutput(AS_CSTRING(value), AS_STRING(value) -> length);
+            break;
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef clox_output_h
+#define clox_output_h
+
+#include "common.h"
+#include "value.h"
+
+// bytes of stdout held before they're written out
+#define OUTPUT_BUFFER_SIZE (64 * 1024)
+
+// what a script prints goes through here, to stdout in blocks...
+// ... instead of a stdio call per value; it's written out when...
+// ... the buffer fills and at the flush points: before the REPL's...
+// ... prompt, before a runtime error is reported and on exit...
+// ... (`freeVM()`, or `atexit()` in main.c)
+
+void writeOutput(const char* chars, size_t length);
+
+// a value the way `printValue()` prints it, numbers being...
+// ... formatted straight into the buffer (see dtoa.h)
+void writeValue(Value value);
+
+void flushOutput(void);
+
+#endif
@@ -0,0 +1,126 @@
+// prints a few million numbers the way `interpret()` used to, w/ a...
+// ... printf("%g") per value, against printf("%.17g"), which...
+// ... round-trips, and against the output buffer, which does and...
+// ... is as short as it can be; first every number the buffer...
+// ... prints has to read back as exactly itself...
+// ... usage: output_bench [numbers] [seed] > /dev/null, the...
+// ... report goes to stderr
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common.h"
+#include "dtoa.h"
+#include "output.h"
+#include "value.h"
+
+static double nowNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// a result set: counts, prices and measurements, w/ every third...
+// ... number any double at all
+static double randomNumber(void) {
+    switch (rand() % 3) {
+        case 0:
+            return rand() % 100000;
+        case 1:
+            return (rand() % 100000) / 100.0;
+        default: {
+            uint64_t bits = ((uint64_t)rand() << 42) ^
+                ((uint64_t)rand() << 21) ^ (uint64_t)rand() ^
+                ((uint64_t)rand() << 62);
+            double number;
+            memcpy(&number, &bits, sizeof(number));
+
+            // no nan or inf
+            return number - number == 0 ? number : 1.0;
+        }
+    }
+}
+
+// how many of the numbers read back exactly from `format`
+static int roundTrips(const double* numbers, int count, const char* format) {
+    char buffer[64];
+    int exact = 0;
+
+    for (int i = 0; i < count; i++) {
+        snprintf(buffer, sizeof(buffer), format, numbers[i]);
+        double back = strtod(buffer, NULL);
+        exact += memcmp(&back, &numbers[i], sizeof(double)) == 0;
+    }
+    return exact;
+}
+
+static int checkFormatter(const double* numbers, int count) {
+    char buffer[NUMBER_MAX_CHARS + 1];
+    int failures = 0;
+
+    for (int i = 0; i < count; i++) {
+        int length = formatNumber(numbers[i], buffer);
+        buffer[length] = '\0';
+
+        double back = strtod(buffer, NULL);
+        if (memcmp(&back, &numbers[i], sizeof(double)) != 0) {
+            if (failures++ < 10)
+                fprintf(stderr, "MISMATCH: %.17g printed as %s\n",
+                    numbers[i], buffer);
+        }
+    }
+    return failures;
+}
+
+static double timePrintf(const double* numbers, int count,
+                         const char* format) {
+    double start = nowNanos();
+    for (int i = 0; i < count; i++)
+        printf(format, numbers[i]);
+    fflush(stdout);
+    return nowNanos() - start;
+}
+
+static double timeBuffer(const double* numbers, int count) {
+    double start = nowNanos();
+    for (int i = 0; i < count; i++) {
+        writeValue(NUMBER_VAL(numbers[i]));
+        writeOutput("\n", 1);
+    }
+    flushOutput();
+    return nowNanos() - start;
+}
+
+int main(int argc, const char* argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 3000000;
+    unsigned seed = argc > 2 ? (unsigned)atoi(argv[2]) : 1234;
+    if (count < 1) {
+        fprintf(stderr, "count must be at least 1\n");
+        return 64;
+    }
+    srand(seed);
+
+    double* numbers = malloc(sizeof(double) * count);
+    for (int i = 0; i < count; i++)
+        numbers[i] = randomNumber();
+
+    int failures = checkFormatter(numbers, count);
+    fprintf(stderr, "%d numbers, %d don't read back (%d w/ %%g)\n", count,
+        failures, count - roundTrips(numbers, count, "%g"));
+
+    double g = timePrintf(numbers, count, "%g\n");
+    double g17 = timePrintf(numbers, count, "%.17g\n");
+    double buffered = timeBuffer(numbers, count);
+
+    fprintf(stderr, "printf %%g     %8.1f ns/number\n", g / count);
+    fprintf(stderr, "printf %%.17g  %8.1f ns/number\n", g17 / count);
+    fprintf(stderr, "buffered      %8.1f ns/number  (%.2fx %%g, "
+        "%.2fx %%.17g)\n", buffered / count, g / buffered, g17 / buffered);
+
+    free(numbers);
+    return failures == 0 ? 0 : 1;
+}
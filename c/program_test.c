@@ -0,0 +1,243 @@
+// tests of the embedding API: `compileProgram()`, `runProgram()` and...
+// ... `freeProgram()`; inputs have to bind by position, a program...
+// ... that names an input it wasn't given mustn't compile, and a...
+// ... program's constants have to outlive a cycle started in the...
+// ... middle of a run, or in the middle of compiling them
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "common.h"
+#include "memory.h"
+#include "object.h"
+#include "value.h"
+#include "vm.h"
+
+static int failures = 0;
+
+static void expect(const char* what, bool ok) {
+    printf("%-52s %s\n", what, ok ? "ok" : "<-- FAILED");
+
+    if (!ok)
+        failures++;
+}
+
+static bool isNumber(Value value, double expected) {
+    return IS_NUMBER(value) && AS_NUMBER(value) == expected;
+}
+
+static bool isString(Value value, const char* expected) {
+    return IS_STRING(value) &&
+        AS_STRING(value) -> length == (int)strlen(expected) &&
+        memcmp(AS_STRING(value) -> chars, expected,
+            AS_STRING(value) -> length) == 0;
+}
+
+// whether the collector still has `object` in its list
+static bool isLive(Obj* object) {
+    for (Obj* live = vm.objects; live != NULL; live = live -> next)
+        if (live == object)
+            return true;
+    return false;
+}
+
+void test_input_binding(void) {
+    static const char* const names[] = {"x", "y"};
+    Value result;
+
+    Program* program = compileProgram("x * 10 - y", names, 2);
+    expect("compiles over two inputs", program != NULL);
+
+    Value first[] = {NUMBER_VAL(1), NUMBER_VAL(2)};
+    expect("x * 10 - y w/ (1, 2) is 8",
+        runProgram(program, first, &result) == INTERPRET_OK &&
+        isNumber(result, 8));
+
+    // the same program, rebound
+    Value second[] = {NUMBER_VAL(3), NUMBER_VAL(-4)};
+    expect("x * 10 - y w/ (3, -4) is 34",
+        runProgram(program, second, &result) == INTERPRET_OK &&
+        isNumber(result, 34));
+    freeProgram(program);
+
+    // inputs bind by position in `names`, not by order of use
+    program = compileProgram("y - x * x", names, 2);
+    expect("y - x * x w/ (3, -4) is -13",
+        runProgram(program, second, &result) == INTERPRET_OK &&
+        isNumber(result, -13));
+    freeProgram(program);
+
+    program = compileProgram("x + y", names, 2);
+    Value strings[] = {
+        OBJ_VAL(copyString("ab", 2)), OBJ_VAL(copyString("cd", 2))
+    };
+    expect("x + y w/ (\"ab\", \"cd\") is \"abcd\"",
+        runProgram(program, strings, &result) == INTERPRET_OK &&
+        isString(result, "abcd"));
+
+    // a runtime error leaves the VM fit to run again
+    Value mixed[] = {OBJ_VAL(copyString("ab", 2)), NUMBER_VAL(1)};
+    expect("x + y w/ (\"ab\", 1) is a runtime error",
+        runProgram(program, mixed, &result) == INTERPRET_RUNTIME_ERROR);
+    expect("... and the next run still works",
+        runProgram(program, first, &result) == INTERPRET_OK &&
+        isNumber(result, 3));
+    freeProgram(program);
+}
+
+void test_wrong_inputs(void) {
+    static const char* const names[] = {"x", "y"};
+    Program* before = vm.programs;
+
+    expect("an input that isn't named doesn't compile",
+        compileProgram("x + z", names, 2) == NULL);
+
+    // only the first `inputCount` names are bound
+    expect("fewer inputs than the program uses doesn't compile",
+        compileProgram("x + y", names, 1) == NULL);
+    expect("an input w/out any names doesn't compile",
+        compileProgram("x", NULL, 0) == NULL);
+
+    expect("a program that didn't compile isn't kept",
+        vm.programs == before);
+}
+
+static int compareAddresses(const void* a, const void* b) {
+    uintptr_t x = (uintptr_t)*(Obj* const*)a;
+    uintptr_t y = (uintptr_t)*(Obj* const*)b;
+    return (x > y) - (x < y);
+}
+
+// whether every one of the program's string constants is still...
+// ... live and its own object: a swept string's address can be...
+// ... reused by the next one, so liveness alone isn't enough
+static bool constantsLive(Program* program) {
+    ValueArray* constants = &program -> chunk.constants;
+    Obj** objects = malloc(sizeof(Obj*) * constants -> count);
+    int count = 0;
+    bool live = true;
+
+    for (int i = 0; i < constants -> count; i++) {
+        if (!IS_OBJ(constants -> values[i]))
+            continue;
+        objects[count] = AS_OBJ(constants -> values[i]);
+        live = live && isLive(objects[count++]);
+    }
+
+    qsort(objects, count, sizeof(Obj*), compareAddresses);
+    for (int i = 1; i < count; i++)
+        live = live && objects[i] != objects[i - 1];
+
+    free(objects);
+    return live;
+}
+
+void test_constants_survive_gc(void) {
+    static const char* const names[] = {"x"};
+    Value result;
+
+    Program* program = compileProgram("\"left\" + x + \"right\"", names, 1);
+    ValueArray* constants = &program -> chunk.constants;
+
+    // a cycle starts at the run's first allocation and goes on one...
+    // ... object per instruction, so it's still marking when the...
+    // ... run's over and the chunk's no longer `vm.chunk`
+    vm.gcSliceBudget = 1;
+    vm.nextGC = 0;
+
+    Value input[] = {OBJ_VAL(copyString("-mid-", 5))};
+    expect("runs while a cycle starts",
+        runProgram(program, input, &result) == INTERPRET_OK &&
+        isString(result, "left-mid-right"));
+    expect("... and the cycle's still going after it",
+        vm.gcPhase != GC_IDLE);
+
+    vm.gcSliceBudget = GC_DEFAULT_SLICE_BUDGET;
+    while (gcStep())
+        ;
+    collectGarbage();
+
+    bool live = true;
+    for (int i = 0; i < constants -> count; i++)
+        if (IS_OBJ(constants -> values[i]))
+            live = live && isLive(AS_OBJ(constants -> values[i]));
+    expect("its constants survive two cycles between runs", live);
+
+    Value again[] = {OBJ_VAL(copyString("+", 1))};
+    expect("... and it runs again after them",
+        runProgram(program, again, &result) == INTERPRET_OK &&
+        isString(result, "left+right"));
+
+    // once freed, nothing's left holding its strings
+    freeProgram(program);
+    collectGarbage();
+    expect("no strings left once it's freed and collected",
+        getMemStats().categories[MEM_STRINGS].bytes == 0);
+}
+
+void test_constants_added_mid_cycle(void) {
+    // enough strings that the constant pool grows a few times
+    static const char* const src = "\"a\" + \"b\" + \"c\" + \"d\" + "
+        "\"e\" + \"f\" + \"g\" + \"h\" + \"i\" + \"j\" + \"k\" + "
+        "\"l\" + \"m\" + \"n\" + \"o\" + \"p\" + \"q\"";
+
+    // another program, already compiled, for the cycle to mark too
+    Program* other = compileProgram("\"x\" + \"y\"", NULL, 0);
+
+    // what compiling it allocates, w/out a cycle starting
+    vm.nextGC = SIZE_MAX;
+    size_t before = getMemStats().bytes;
+    Program* program = compileProgram(src, NULL, 0);
+    size_t bytes = getMemStats().bytes - before;
+    freeProgram(program);
+
+    // a cycle starts at each byte of that in turn, so one of them...
+    // ... is the constant pool growing, after the barrier for the...
+    // ... constant that grew it would have run
+    bool live = true;
+    bool result = true;
+    for (size_t at = 0; at < bytes && live && result; at++) {
+        vm.nextGC = getMemStats().bytes + at;
+        program = compileProgram(src, NULL, 0);
+        while (gcStep())
+            ;
+
+        live = constantsLive(program) && constantsLive(other);
+
+        Value value;
+        result = runProgram(program, NULL, &value) == INTERPRET_OK &&
+            isString(value, "abcdefghijklmnopq");
+        freeProgram(program);
+    }
+
+    expect("constants added while a cycle starts survive it", live);
+    expect("... and the program still runs", result);
+
+    vm.nextGC = GC_INITIAL_NEXT_GC;
+    freeProgram(other);
+    collectGarbage();
+}
+
+int main(void) {
+    initVM();
+
+    printf("test_input_binding:\n");
+    test_input_binding();
+    printf("\n");
+
+    printf("test_wrong_inputs:\n");
+    test_wrong_inputs();
+    printf("\n");
+
+    printf("test_constants_survive_gc:\n");
+    test_constants_survive_gc();
+    printf("\n");
+
+    printf("test_constants_added_mid_cycle:\n");
+    test_constants_added_mid_cycle();
+
+    freeVM();
+    return failures == 0 ? 0 : 1;
+}
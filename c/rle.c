@@ -22,9 +22,9 @@ void writeRunLengthEncoding(RunLengthEncoding* rle, int value) {
         //     0, rle -> capacity);
 
         rle -> values = NEW_GROW_ARRAY(int, rle -> values,
-            rle -> capacity);
+            rle -> capacity, MEM_RLE_LINES);
         rle -> lengths = NEW_GROW_ARRAY(int, rle -> lengths,
-            rle -> capacity);
+            rle -> capacity, MEM_RLE_LINES);
 
         rle -> values[0] = value;
         rle -> lengths[0] = 1;
@@ -47,9 +47,9 @@ void writeRunLengthEncoding(RunLengthEncoding* rle, int value) {
             //                            oldCapacity, rle -> capacity);
 
             rle -> values = NEW_GROW_ARRAY(int, rle -> values,
-               rle -> capacity);
+               rle -> capacity, MEM_RLE_LINES);
             rle -> lengths = NEW_GROW_ARRAY(int, rle -> lengths,
-               rle -> capacity);
+               rle -> capacity, MEM_RLE_LINES);
 
         }
         rle -> values[rle -> count] = value;
@@ -63,8 +63,8 @@ void freeRunLengthEncoding(RunLengthEncoding* rle) {
     // FREE_ARRAY(int, rle -> values, rle -> capacity);
     // FREE_ARRAY(int, rle -> lengths, rle -> capacity);
 
-    NEW_FREE_ARRAY(rle -> values);
-    NEW_FREE_ARRAY(rle -> lengths);
+    NEW_FREE_ARRAY(rle -> values, MEM_RLE_LINES);
+    NEW_FREE_ARRAY(rle -> lengths, MEM_RLE_LINES);
 
     initRunLengthEncoding(rle);
 }
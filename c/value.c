@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "dtoa.h"
 #include "object.h"
 #include "memory.h"
 #include "value.h"
@@ -18,7 +19,8 @@ void writeValueArray(ValueArray* array, Value value) {
         int oldCapacity = array -> capacity;
         array -> capacity = GROW_CAPACITY(oldCapacity);
         array -> values = GROW_ARRAY(Value, array -> values,
-                                     oldCapacity, array -> capacity);
+                                     oldCapacity, array -> capacity,
+                                     MEM_CONSTANTS);
 
         // array -> values = NEW_GROW_ARRAY(Value, array -> values,
         //    array -> capacity);
@@ -30,7 +32,8 @@ void writeValueArray(ValueArray* array, Value value) {
 
 // free the ValueArray
 void freeValueArray(ValueArray* array) {
-    FREE_ARRAY(Value, array -> values, array -> capacity);
+    FREE_ARRAY(Value, array -> values, array -> capacity,
+        MEM_CONSTANTS);
     // NEW_FREE_ARRAY(array -> values);
 
     initValueArray(array);
@@ -45,9 +48,13 @@ void printValue(Value value) {
         case VAL_NIL:
             printf("nil");
             break;
-        case VAL_NUMBER:
-            printf("%g", AS_NUMBER(value));
+        case VAL_NUMBER: {
+            // the same digits `writeValue()` prints
+            char buffer[NUMBER_MAX_CHARS];
+            int length = formatNumber(AS_NUMBER(value), buffer);
+            printf("%.*s", length, buffer);
             break;
+        }
         case VAL_OBJ:
             printObject(value);
             break;
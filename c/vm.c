@@ -3,16 +3,22 @@
 #include <string.h>
 
 #include "common.h"
+#include "cache.h"
 #include "compiler.h"
 #include "debug.h"
 #include "object.h"
 #include "memory.h"
+#include "operand.h"
+#include "output.h"
 #include "vm.h"
 
 VM vm;
 
 // example of a variadic function
 static void runtimeError(const char* format,...) {
+    // what the script printed comes first
+    flushOutput();
+
     // `args` lets us pass an arbitrary...
     // ... # of args to runTime error
     va_list args;
@@ -36,17 +42,40 @@ void initVM(void) {
     vm.count = 0;
     vm.capacity = 0;
     vm.dyn_stack = NULL;
+    vm.chunk = NULL;
     vm.objects = NULL;
+
+    vm.programs = NULL;
+    vm.inputs = NULL;
+    vm.inputCount = 0;
+
+    vm.gcPhase = GC_IDLE;
+    vm.markBit = true;
+    vm.rootChunk = NULL;
+    vm.rootCursor = 0;
+    vm.sweepLink = NULL;
+    vm.grayCount = 0;
+    vm.grayCapacity = 0;
+    vm.grayStack = NULL;
+    vm.nextGC = GC_INITIAL_NEXT_GC;
+    vm.gcSliceBudget = GC_DEFAULT_SLICE_BUDGET;
+
+    initChunkCache();
 }
 
 // frees a VM
 void freeVM(void) {
+    freeChunkCache();
+    flushOutput();
+
     freeObjects();
+    vm.objects = NULL;
+    vm.gcPhase = GC_IDLE;
 
     vm.count = 0;
     vm.capacity = 0;
 
-    NEW_FREE_ARRAY(vm.dyn_stack);
+    NEW_FREE_ARRAY(vm.dyn_stack, MEM_STACK);
 }
 
 // pushes a Value to the stack
@@ -56,9 +85,13 @@ void push(Value value) {
         vm.capacity = GROW_CAPACITY(oldCapacity);
 
         vm.dyn_stack = NEW_GROW_ARRAY(Value, vm.dyn_stack,
-            vm.capacity);
+            vm.capacity, MEM_STACK);
     }
 
+    // the stack is scanned when a cycle starts, so...
+    // ... anything pushed after that needs the barrier
+    writeBarrier(value);
+
     vm.dyn_stack[vm.count] = value;
     vm.count++;
 }
@@ -89,7 +122,7 @@ static void concatenate(void) {
     int length = a -> length + b -> length;
 
     // allocate a char array
-    char* chars = ALLOCATE(char, length + 1);
+    char* chars = ALLOCATE(char, length + 1, MEM_STRINGS);
 
     // copy the two halves in and terminate the string
     memcpy(chars, a -> chars, a -> length);
@@ -103,7 +136,7 @@ static void concatenate(void) {
 
 // beating heart of VM..
 // ... interpreter spends ~90% of time here
-static InterpretResult run(void) {
+static InterpretResult run(Value* result) {
     // reads byte currently pointed @ by `ip`...
     // ... and then advances `ip`
     #define READ_BYTE() (*(vm.ip)++)
@@ -128,7 +161,16 @@ static InterpretResult run(void) {
             push(valueType(a op b)); \
         } while (false)
 
+    // slots are counted from where the stack was when the...
+    // ... program started, a caller's values can sit below it
+    int base = vm.count;
+
     for(;;) {
+        // a bounded slice of collector work between...
+        // ... instructions instead of one long pause
+        if (vm.gcPhase != GC_IDLE)
+            gcStep();
+
         // diagnostic logging for VM...
         // ... stack trace...
         // ... and disassembling instructions
@@ -154,13 +196,7 @@ static InterpretResult run(void) {
             }
 
             case OP_CONSTANT_LONG: {
-                int first_byte_index = READ_BYTE();
-                int second_byte_index = READ_BYTE();
-                int third_byte_index = READ_BYTE();
-                
-                int constant_index = (first_byte_index << 16) |
-                         (second_byte_index << 8) |
-                         (third_byte_index);
+                uint32_t constant_index = decodeOperand(&vm.ip);
 
                 Value constant = vm.chunk -> 
                     constants.values[constant_index];
@@ -244,9 +280,31 @@ static InterpretResult run(void) {
                 break;
             }
 
+            case OP_GET_INPUT: {
+                uint32_t input_index = decodeOperand(&vm.ip);
+                push(vm.inputs[input_index]);
+                break;
+            }
+
+            case OP_GET_LOCAL: {
+                uint32_t slot = decodeOperand(&vm.ip);
+                push(vm.dyn_stack[base + slot]);
+                break;
+            }
+
+            case OP_SET_LOCAL: {
+                // the value stays on the stack as well
+                uint32_t slot = decodeOperand(&vm.ip);
+                writeBarrier(peek(0));
+                vm.dyn_stack[base + slot] = peek(0);
+                break;
+            }
+
             case OP_RETURN: {
-                printValue(pop());
-                printf("\n");
+                *result = pop();
+
+                // drops the slots, if the program had any
+                vm.count = base;
                 return INTERPRET_OK;
             }
         }
@@ -258,24 +316,73 @@ static InterpretResult run(void) {
 }
 
 InterpretResult interpret(const char* src) {
-    // create an empty chunk that's passed...
-    // ... over to the compiler
-    Chunk chunk;
-    initChunk(&chunk);
-
-    // compiler fills up chunk with bytecode...
-    // ... unless there are compile errors
-    if (!compile(src, &chunk)) {
-        freeChunk(&chunk);
+    // the same source is only scanned and compiled once...
+    // ... for as long as the cache keeps it, see cache.c
+    Program* program = cachedProgram(src);
+    if (program == NULL)
         return INTERPRET_COMPILE_ERROR;
+
+    Value result;
+    InterpretResult res = runProgram(program, NULL, &result);
+
+    if (res == INTERPRET_OK) {
+        writeValue(result);
+        writeOutput("\n", 1);
+    }
+
+    return res;
+}
+
+static void unlinkProgram(Program* program) {
+    Program** link = &vm.programs;
+    while (*link != program)
+        link = &(*link) -> next;
+
+    *link = program -> next;
+}
+
+Program* compileProgram(const char* src, const char* const* inputNames,
+                        int inputCount) {
+    Program* program = ALLOCATE(Program, 1, MEM_CHUNK_CODE);
+    initChunk(&program -> chunk);
+    program -> inputCount = inputCount;
+
+    // linked in first, so a cycle started while compiling...
+    // ... already sees its constants
+    program -> next = vm.programs;
+    vm.programs = program;
+
+    if (!compileWithInputs(src, &program -> chunk, inputNames, inputCount)) {
+        freeProgram(program);
+        return NULL;
     }
 
-    vm.chunk = &chunk;
+    return program;
+}
+
+InterpretResult runProgram(Program* program, const Value* inputs,
+                           Value* result) {
+    // a cycle already marking won't rescan the inputs
+    for (int i = 0; i < program -> inputCount; i++)
+        writeBarrier(inputs[i]);
+
+    vm.inputs = inputs;
+    vm.inputCount = program -> inputCount;
+    vm.chunk = &program -> chunk;
     vm.ip = vm.chunk -> code;
 
-    InterpretResult res = run();
+    InterpretResult res = run(result);
+
+    // the chunk's constants are still roots through `vm.programs`
+    vm.chunk = NULL;
+    vm.inputs = NULL;
+    vm.inputCount = 0;
 
-    freeChunk(&chunk);
-    
     return res;
 }
+
+void freeProgram(Program* program) {
+    unlinkProgram(program);
+    freeChunk(&program -> chunk);
+    FREE(Program, program, MEM_CHUNK_CODE);
+}
@@ -7,6 +7,22 @@
 #define STACK_MAX 256
 #define STARTING_STACK_MAX 256
 
+// first cycle starts once this many bytes are live
+#define GC_INITIAL_NEXT_GC (1024 * 1024)
+
+// objects marked or swept per slice by default
+#define GC_DEFAULT_SLICE_BUDGET 64
+
+// an expression compiled once to be run many times, w/ its...
+// ... inputs bound afresh on each run (see `compileProgram()`)
+typedef struct Program {
+    Chunk chunk;
+    int inputCount;
+
+    // live programs are kept on a list, their constants are roots
+    struct Program* next;
+} Program;
+
 typedef struct {
     Chunk* chunk;
     
@@ -20,6 +36,22 @@ typedef struct {
 
     Value* dyn_stack;
     Obj* objects;
+
+    Program* programs;  // every program not yet freed
+    const Value* inputs;    // bound to the running program
+    int inputCount;
+
+    // incremental collector state
+    GCPhase gcPhase;
+    bool markBit;       // value of `isMarked` meaning "reached"
+    Chunk* rootChunk;   // chunk whose constants are being marked
+    int rootCursor;     // next of its constants to mark
+    Obj** sweepLink;    // link to the next object to sweep
+    int grayCount;
+    int grayCapacity;
+    Obj** grayStack;    // the gray worklist
+    size_t nextGC;      // live bytes that start the next cycle
+    int gcSliceBudget;  // objects marked or swept per slice
 } VM;
 
 // VM runs the chunk and then responds...
@@ -47,4 +79,18 @@ Value pop(void);
 // interprets a chunk of bytecode
 InterpretResult interpret(const char* src);
 
+// compiles an expression over the named inputs, NULL if it...
+// ... doesn't compile; the program stays until `freeProgram()`
+Program* compileProgram(const char* src, const char* const* inputNames,
+                        int inputCount);
+
+// runs a program w/ `inputs` bound to its input names in order...
+// ... and leaves its value in `result` instead of printing it;...
+// ... an object in `result` is only safe until the next run
+InterpretResult runProgram(Program* program, const Value* inputs,
+                           Value* result);
+
+// frees a program from `compileProgram()`
+void freeProgram(Program* program);
+
 #endif
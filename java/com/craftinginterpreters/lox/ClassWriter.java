@@ -0,0 +1,361 @@
+package com.craftinginterpreters.lox;
+
+import java.io.ByteArrayOutputStream;
+import java.io.DataOutputStream;
+import java.io.IOException;
+import java.io.UncheckedIOException;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+// a minimal class-file writer for JvmCompiler: a constant pool w/...
+// ... just the entry kinds it needs, and methods w/ a Code attribute
+//
+// it writes version 49 (Java 5) class files, which HotSpot still...
+// ... verifies by type inference, so there are no StackMapTable...
+// ... frames to compute
+class ClassWriter {
+    static final int ACC_PUBLIC = 0x0001;
+    static final int ACC_SUPER = 0x0020;
+
+    // the opcodes JvmCompiler emits
+    static final int ACONST_NULL = 0x01;
+    static final int ICONST_0 = 0x03;
+    static final int BIPUSH = 0x10;
+    static final int SIPUSH = 0x11;
+    static final int LDC_W = 0x13;
+    static final int ALOAD = 0x19;
+    static final int ALOAD_0 = 0x2a;
+    static final int AALOAD = 0x32;
+    static final int ASTORE = 0x3a;
+    static final int ASTORE_0 = 0x4b;
+    static final int AASTORE = 0x53;
+    static final int POP = 0x57;
+    static final int DUP = 0x59;
+    static final int IFEQ = 0x99;
+    static final int IFNE = 0x9a;
+    static final int GOTO = 0xa7;
+    static final int ARETURN = 0xb0;
+    static final int RETURN = 0xb1;
+    static final int INVOKESPECIAL = 0xb7;
+    static final int INVOKESTATIC = 0xb8;
+    static final int ANEWARRAY = 0xbd;
+    static final int WIDE = 0xc4;
+
+    private static final int CLASS_FILE_VERSION = 49;
+
+    private static final int CONSTANT_UTF8 = 1;
+    private static final int CONSTANT_INTEGER = 3;
+    private static final int CONSTANT_CLASS = 7;
+    private static final int CONSTANT_METHODREF = 10;
+    private static final int CONSTANT_NAME_AND_TYPE = 12;
+
+    private final ByteArrayOutputStream poolBytes = new ByteArrayOutputStream();
+    private final DataOutputStream pool = new DataOutputStream(poolBytes);
+
+    // dedupes pool entries, keyed by tag and contents
+    private final Map<String, Integer> entries = new HashMap<>();
+    private int poolCount = 1;
+
+    private final List<byte[]> methods = new ArrayList<>();
+
+    int utf8(String value) {
+        String key = "utf8 " + value;
+        Integer index = entries.get(key);
+        if (index != null)
+            return index;
+
+        try {
+            pool.writeByte(CONSTANT_UTF8);
+            pool.writeUTF(value);
+        } catch (IOException e) {
+            throw new UncheckedIOException(e);
+        }
+        return add(key);
+    }
+
+    int integer(int value) {
+        String key = "int " + value;
+        Integer index = entries.get(key);
+        if (index != null)
+            return index;
+
+        try {
+            pool.writeByte(CONSTANT_INTEGER);
+            pool.writeInt(value);
+        } catch (IOException e) {
+            throw new UncheckedIOException(e);
+        }
+        return add(key);
+    }
+
+    // `internalName` uses slashes, e.g. "java/lang/Object"
+    int classRef(String internalName) {
+        String key = "class " + internalName;
+        Integer index = entries.get(key);
+        if (index != null)
+            return index;
+
+        int name = utf8(internalName);
+        try {
+            pool.writeByte(CONSTANT_CLASS);
+            pool.writeShort(name);
+        } catch (IOException e) {
+            throw new UncheckedIOException(e);
+        }
+        return add(key);
+    }
+
+    int methodRef(String owner, String name, String descriptor) {
+        String key = "method " + owner + "." + name + descriptor;
+        Integer index = entries.get(key);
+        if (index != null)
+            return index;
+
+        int klass = classRef(owner);
+        int nameAndType = nameAndType(name, descriptor);
+        try {
+            pool.writeByte(CONSTANT_METHODREF);
+            pool.writeShort(klass);
+            pool.writeShort(nameAndType);
+        } catch (IOException e) {
+            throw new UncheckedIOException(e);
+        }
+        return add(key);
+    }
+
+    private int nameAndType(String name, String descriptor) {
+        String key = "nat " + name + descriptor;
+        Integer index = entries.get(key);
+        if (index != null)
+            return index;
+
+        int nameIndex = utf8(name);
+        int descriptorIndex = utf8(descriptor);
+        try {
+            pool.writeByte(CONSTANT_NAME_AND_TYPE);
+            pool.writeShort(nameIndex);
+            pool.writeShort(descriptorIndex);
+        } catch (IOException e) {
+            throw new UncheckedIOException(e);
+        }
+        return add(key);
+    }
+
+    private int add(String key) {
+        if (poolCount > 0xffff)
+            throw new IllegalStateException("constant pool overflow");
+
+        int index = poolCount++;
+        entries.put(key, index);
+        return index;
+    }
+
+    void method(int access, String name, String descriptor, Code code) {
+        if (code.length > 0xffff)
+            throw new IllegalStateException("method too large");
+
+        ByteArrayOutputStream bytes = new ByteArrayOutputStream();
+        DataOutputStream out = new DataOutputStream(bytes);
+        try {
+            out.writeShort(access);
+            out.writeShort(utf8(name));
+            out.writeShort(utf8(descriptor));
+
+            // one attribute: Code, w/ no exception table...
+            // ... and no attributes of its own
+            out.writeShort(1);
+            out.writeShort(utf8("Code"));
+            out.writeInt(12 + code.length);
+            out.writeShort(code.maxStack);
+            out.writeShort(code.maxLocals);
+            out.writeInt(code.length);
+            out.write(code.bytes, 0, code.length);
+            out.writeShort(0);
+            out.writeShort(0);
+        } catch (IOException e) {
+            throw new UncheckedIOException(e);
+        }
+        methods.add(bytes.toByteArray());
+    }
+
+    byte[] toBytes(String name, String superName, String[] interfaces) {
+        // every pool entry has to exist before the pool is written
+        int thisClass = classRef(name);
+        int superClass = classRef(superName);
+        int[] interfaceIndexes = new int[interfaces.length];
+        for (int i = 0; i < interfaces.length; i++)
+            interfaceIndexes[i] = classRef(interfaces[i]);
+
+        ByteArrayOutputStream bytes = new ByteArrayOutputStream();
+        DataOutputStream out = new DataOutputStream(bytes);
+        try {
+            out.writeInt(0xcafebabe);
+            out.writeShort(0);
+            out.writeShort(CLASS_FILE_VERSION);
+
+            out.writeShort(poolCount);
+            poolBytes.writeTo(out);
+
+            out.writeShort(ACC_PUBLIC | ACC_SUPER);
+            out.writeShort(thisClass);
+            out.writeShort(superClass);
+            out.writeShort(interfaceIndexes.length);
+            for (int index : interfaceIndexes)
+                out.writeShort(index);
+
+            // no fields
+            out.writeShort(0);
+
+            out.writeShort(methods.size());
+            for (byte[] method : methods)
+                out.write(method);
+
+            // no class attributes
+            out.writeShort(0);
+        } catch (IOException e) {
+            throw new UncheckedIOException(e);
+        }
+        return bytes.toByteArray();
+    }
+
+    // stack effect of an invokestatic w/ this descriptor: pops...
+    // ... the args and pushes the result, if any (no long/double)
+    static int stackDelta(String descriptor) {
+        int delta = 0;
+        int i = 1;
+        while (descriptor.charAt(i) != ')') {
+            while (descriptor.charAt(i) == '[')
+                i++;
+            if (descriptor.charAt(i) == 'L')
+                i = descriptor.indexOf(';', i);
+            i++;
+            delta--;
+        }
+
+        if (descriptor.charAt(i + 1) != 'V')
+            delta++;
+        return delta;
+    }
+
+    // a method body being emitted, tracking the operand stack...
+    // ... depth as it goes so max_stack comes out right
+    static class Code {
+        byte[] bytes = new byte[256];
+        int length = 0;
+
+        int stack = 0;
+        int maxStack = 0;
+        int maxLocals;
+
+        Code(int maxLocals) {
+            this.maxLocals = maxLocals;
+        }
+
+        int newLocal() {
+            return maxLocals++;
+        }
+
+        void op(int opcode, int stackDelta) {
+            u1(opcode);
+            stack += stackDelta;
+            if (stack > maxStack)
+                maxStack = stack;
+        }
+
+        void u1(int value) {
+            if (length == bytes.length)
+                bytes = Arrays.copyOf(bytes, bytes.length * 2);
+            bytes[length++] = (byte)value;
+        }
+
+        void u2(int value) {
+            u1(value >> 8);
+            u1(value);
+        }
+
+        void aload(int index) {
+            if (index < 4)
+                op(ALOAD_0 + index, 1);
+            else
+                local(ALOAD, index, 1);
+        }
+
+        void astore(int index) {
+            if (index < 4)
+                op(ASTORE_0 + index, -1);
+            else
+                local(ASTORE, index, -1);
+        }
+
+        private void local(int opcode, int index, int stackDelta) {
+            if (index < 256) {
+                op(opcode, stackDelta);
+                u1(index);
+            } else {
+                op(WIDE, stackDelta);
+                u1(opcode);
+                u2(index);
+            }
+        }
+
+        void pushInt(ClassWriter cw, int value) {
+            if (value >= -1 && value <= 5)
+                op(ICONST_0 + value, 1);
+            else if (value >= Byte.MIN_VALUE && value <= Byte.MAX_VALUE) {
+                op(BIPUSH, 1);
+                u1(value);
+            }
+            else if (value >= Short.MIN_VALUE && value <= Short.MAX_VALUE) {
+                op(SIPUSH, 1);
+                u2(value);
+            }
+            else {
+                op(LDC_W, 1);
+                u2(cw.integer(value));
+            }
+        }
+
+        // an instruction w/ a constant pool index operand
+        void op(int opcode, int stackDelta, int poolIndex) {
+            op(opcode, stackDelta);
+            u2(poolIndex);
+        }
+
+        void jump(int opcode, Label label, int stackDelta) {
+            int at = length;
+            op(opcode, stackDelta);
+            if (label.position >= 0) {
+                u2(offset(at, label.position));
+            } else {
+                label.fixups.add(at);
+                u2(0);
+            }
+        }
+
+        void mark(Label label) {
+            label.position = length;
+            for (int at : label.fixups) {
+                int offset = offset(at, length);
+                bytes[at + 1] = (byte)(offset >> 8);
+                bytes[at + 2] = (byte)offset;
+            }
+        }
+
+        private static int offset(int from, int to) {
+            int offset = to - from;
+            if (offset < Short.MIN_VALUE || offset > Short.MAX_VALUE)
+                throw new IllegalStateException("branch too far");
+            return offset;
+        }
+    }
+
+    static class Label {
+        int position = -1;
+
+        // where jumps to this label were emitted before it was marked
+        final List<Integer> fixups = new ArrayList<>();
+    }
+}
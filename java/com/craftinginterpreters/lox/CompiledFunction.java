@@ -0,0 +1,48 @@
+package com.craftinginterpreters.lox;
+
+// a LoxFunction whose body the closure engine already compiled...
+// ... it's still a LoxFunction so classes and instances can hold it
+class CompiledFunction extends LoxFunction {
+    private final StmtNode[] body;
+
+    CompiledFunction(Stmt.Function declaration, StmtNode[] body,
+                     Environment closure, boolean isInitializer) {
+        this(declaration, body, closure, isInitializer, null);
+    }
+
+    private CompiledFunction(Stmt.Function declaration, StmtNode[] body,
+                             Environment closure, boolean isInitializer,
+                             LoxInstance receiver) {
+        super(declaration, closure, isInitializer, receiver);
+        this.body = body;
+    }
+
+    @Override
+    Object execute(Interpreter interpreter, LoxInstance receiver,
+                   Object[] frame) {
+        calls++;
+
+        int count = declaration.params.size() + (receiver != null ? 1 : 0);
+        Environment env = new Environment(closure, frame, count);
+
+        Object result = null;
+        for (StmtNode stmt : body) {
+            Object completion = stmt.exec(env);
+            if (completion != StmtNode.NORMAL) {
+                result = completion;
+                break;
+            }
+        }
+
+        if (isInitializer)
+            return receiver;
+
+        return result;
+    }
+
+    @Override
+    LoxFunction bind(LoxInstance instance) {
+        return new CompiledFunction(declaration, body, closure,
+            isInitializer, instance);
+    }
+}
@@ -1,26 +1,70 @@
 package com.craftinginterpreters.lox;
 
-import java.util.HashMap;
-import java.util.Map;
+import java.util.Arrays;
 
 class Environment {
     final Environment enclosing;    // the scope
-    private final Map<String, Object> values = new HashMap<>();
+
+    // what a global that was never defined holds, nil being null
+    private static final Object UNDEFINED = new Object();
+
+    // only the global scope looks variables up by name, or rather...
+    // ... by the name's symbol ID (Symbols), which indexes `values`...
+    private Object[] values;
+
+    // ... local scopes keep them in an array, in the slots...
+    // ... the resolver numbered in declaration order
+    private Object[] slots;
+    private int count = 0;
 
     // global scope's environment
     Environment() {
         enclosing = null;
+        values = new Object[Math.max(64, Symbols.count())];
+        Arrays.fill(values, UNDEFINED);
+        slots = null;
     }
 
     // creates a new local scope nested inside the given outer one
     Environment(Environment enclosing) {
         this.enclosing = enclosing;
+        values = null;
+        slots = new Object[4];
     }
 
-    // variable definitions bind a new name to a value
-    void define(String name, Object value) {
-        // when we add key to the map, we don't check to see if it's already present
-        values.put(name, value);
+    // a function call's scope: `frame` is sized by the resolver...
+    // ... (FrameLayout) and its first `count` slots already hold...
+    // ... the receiver and args, so nothing is defined by name
+    Environment(Environment enclosing, Object[] frame, int count) {
+        this.enclosing = enclosing;
+        values = null;
+        slots = frame;
+        this.count = count;
+    }
+
+    // variable definitions bind a new name to a value...
+    // ... and return the slot it went in (-1 for a global)
+    int define(int symbol, Object value) {
+        if (values != null) {
+            // we don't check to see if it's already defined
+            if (symbol >= values.length) {
+                int length = values.length;
+                values = Arrays.copyOf(values, Math.max(symbol + 1,
+                    length * 2));
+                Arrays.fill(values, length, values.length, UNDEFINED);
+            }
+
+            values[symbol] = value;
+            return -1;
+        }
+
+        // locals are defined in the same order the resolver...
+        // ... declared them, so the next slot is the right one
+        if (count == slots.length)
+            slots = Arrays.copyOf(slots, Math.max(4, count * 2));
+
+        slots[count] = value;
+        return count++;
     }
 
     Environment ancestor(int distance) {
@@ -31,11 +75,14 @@ class Environment {
         return env;
     }
 
-    // looking up an existing variable
+    // looking up an existing global variable
     Object get(Token name) {
         // if variable is found, return the value bound to it
-        if (values.containsKey(name.lexeme))
-            return values.get(name.lexeme);
+        if (values != null) {
+            Object value = global(name.symbol);
+            if (value != UNDEFINED)
+                return value;
+        }
 
         // jump out to higher scope to check for variable
         if (enclosing != null)
@@ -46,14 +93,20 @@ class Environment {
             "undefined variable '" + name.lexeme + "'");
     }
 
-    Object getAt(int distance, String name) {
-        return ancestor(distance).values.get(name);
+    // a global's value, or UNDEFINED
+    private Object global(int symbol) {
+        return symbol < values.length ? values[symbol] : UNDEFINED;
+    }
+
+    // looking up a resolved local: an ancestor walk and an array index
+    Object getAt(int distance, int slot) {
+        return ancestor(distance).slots[slot];
     }
 
-    // not allowed to create a new variable
+    // not allowed to create a new global variable
     void assign(Token name, Object value) {
-        if (values.containsKey(name.lexeme)) {
-            values.put(name.lexeme, value);
+        if (values != null && global(name.symbol) != UNDEFINED) {
+            values[name.symbol] = value;
             return;
         }
 
@@ -68,7 +121,7 @@ class Environment {
             "undefined variable '" + name.lexeme + "'");
     }
 
-    void assignAt(int distance, Token name, Object value) {
-        ancestor(distance).values.put(name.lexeme, value);
+    void assignAt(int distance, int slot, Object value) {
+        ancestor(distance).slots[slot] = value;
     }
 }
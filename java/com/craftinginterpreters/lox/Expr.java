@@ -81,6 +81,7 @@ abstract class Expr {
 
 		final Expr object;
 		final Token name;
+		final PropertyCache cache = new PropertyCache();
 	}
 
 	static class Grouping extends Expr {
@@ -141,6 +142,7 @@ abstract class Expr {
 		final Expr object;
 		final Token name;
 		final Expr value;
+		final PropertyCache cache = new PropertyCache();
 	}
 
 	static class Super extends Expr {
@@ -0,0 +1,559 @@
+package com.craftinginterpreters.lox;
+
+// an expression compiled once by NodeCompiler into a tree of...
+// ... small executable nodes: one class per operator and per kind...
+// ... of variable access, w/ the resolved depth and slot baked in...
+// ... so there's no visitor dispatch or operator `switch` at runtime
+abstract class ExprNode {
+    abstract Object eval(Environment env);
+
+    // literals...
+
+    static class Constant extends ExprNode {
+        final Object value;
+
+        Constant(Object value) {
+            this.value = value;
+        }
+
+        @Override
+        Object eval(Environment env) {
+            return value;
+        }
+    }
+
+    // variable access...
+
+    // a local declared in the innermost scope
+    static class GetLocal0 extends ExprNode {
+        final int slot;
+
+        GetLocal0(int slot) {
+            this.slot = slot;
+        }
+
+        @Override
+        Object eval(Environment env) {
+            return env.getAt(0, slot);
+        }
+    }
+
+    // a local declared one scope out, e.g. a param read in a block
+    static class GetLocal1 extends ExprNode {
+        final int slot;
+
+        GetLocal1(int slot) {
+            this.slot = slot;
+        }
+
+        @Override
+        Object eval(Environment env) {
+            return env.enclosing.getAt(0, slot);
+        }
+    }
+
+    static class GetLocal extends ExprNode {
+        final int depth;
+        final int slot;
+
+        GetLocal(int depth, int slot) {
+            this.depth = depth;
+            this.slot = slot;
+        }
+
+        @Override
+        Object eval(Environment env) {
+            return env.getAt(depth, slot);
+        }
+    }
+
+    static class GetGlobal extends ExprNode {
+        final Environment globals;
+        final Token name;
+
+        GetGlobal(Environment globals, Token name) {
+            this.globals = globals;
+            this.name = name;
+        }
+
+        @Override
+        Object eval(Environment env) {
+            return globals.get(name);
+        }
+    }
+
+    static class SetLocal extends ExprNode {
+        final int depth;
+        final int slot;
+        final ExprNode value;
+
+        SetLocal(int depth, int slot, ExprNode value) {
+            this.depth = depth;
+            this.slot = slot;
+            this.value = value;
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object result = value.eval(env);
+            env.assignAt(depth, slot, result);
+            return result;
+        }
+    }
+
+    static class SetGlobal extends ExprNode {
+        final Environment globals;
+        final Token name;
+        final ExprNode value;
+
+        SetGlobal(Environment globals, Token name, ExprNode value) {
+            this.globals = globals;
+            this.name = name;
+            this.value = value;
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object result = value.eval(env);
+            globals.assign(name, result);
+            return result;
+        }
+    }
+
+    // binary operators...
+    // ... both operands are always evaluated first, left to right
+
+    abstract static class Binary extends ExprNode {
+        final ExprNode left;
+        final Token operator;
+        final ExprNode right;
+
+        Binary(ExprNode left, Token operator, ExprNode right) {
+            this.left = left;
+            this.operator = operator;
+            this.right = right;
+        }
+    }
+
+    static class Comma extends Binary {
+        Comma(ExprNode left, Token operator, ExprNode right) {
+            super(left, operator, right);
+        }
+
+        @Override
+        Object eval(Environment env) {
+            left.eval(env);
+            return right.eval(env);
+        }
+    }
+
+    static class Equal extends Binary {
+        Equal(ExprNode left, Token operator, ExprNode right) {
+            super(left, operator, right);
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object l = left.eval(env);
+            Object r = right.eval(env);
+            return Interpreter.isEqual(l, r);
+        }
+    }
+
+    static class NotEqual extends Binary {
+        NotEqual(ExprNode left, Token operator, ExprNode right) {
+            super(left, operator, right);
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object l = left.eval(env);
+            Object r = right.eval(env);
+            return !Interpreter.isEqual(l, r);
+        }
+    }
+
+    static class Greater extends Binary {
+        Greater(ExprNode left, Token operator, ExprNode right) {
+            super(left, operator, right);
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object l = left.eval(env);
+            Object r = right.eval(env);
+            Interpreter.checkNumberOperands(operator, l, r);
+            return (double)l > (double)r;
+        }
+    }
+
+    static class GreaterEqual extends Binary {
+        GreaterEqual(ExprNode left, Token operator, ExprNode right) {
+            super(left, operator, right);
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object l = left.eval(env);
+            Object r = right.eval(env);
+            Interpreter.checkNumberOperands(operator, l, r);
+            return (double)l >= (double)r;
+        }
+    }
+
+    static class Less extends Binary {
+        Less(ExprNode left, Token operator, ExprNode right) {
+            super(left, operator, right);
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object l = left.eval(env);
+            Object r = right.eval(env);
+            Interpreter.checkNumberOperands(operator, l, r);
+            return (double)l < (double)r;
+        }
+    }
+
+    static class LessEqual extends Binary {
+        LessEqual(ExprNode left, Token operator, ExprNode right) {
+            super(left, operator, right);
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object l = left.eval(env);
+            Object r = right.eval(env);
+            Interpreter.checkNumberOperands(operator, l, r);
+            return (double)l <= (double)r;
+        }
+    }
+
+    static class Add extends Binary {
+        Add(ExprNode left, Token operator, ExprNode right) {
+            super(left, operator, right);
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object l = left.eval(env);
+            Object r = right.eval(env);
+
+            // the common case first
+            if (l instanceof Double && r instanceof Double)
+                return (double)l + (double)r;
+            if (l instanceof String && r instanceof String)
+                return (String)l + (String)r;
+
+            // one or the other is a String
+            if (l instanceof String && r instanceof Double)
+                return (String)l + Interpreter.stringify(r);
+            if (l instanceof Double && r instanceof String)
+                return Interpreter.stringify(l) + (String)r;
+
+            throw new RuntimeError(operator,
+                "operands must numbers or strings");
+        }
+    }
+
+    static class Subtract extends Binary {
+        Subtract(ExprNode left, Token operator, ExprNode right) {
+            super(left, operator, right);
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object l = left.eval(env);
+            Object r = right.eval(env);
+            Interpreter.checkNumberOperands(operator, l, r);
+            return (double)l - (double)r;
+        }
+    }
+
+    static class Multiply extends Binary {
+        Multiply(ExprNode left, Token operator, ExprNode right) {
+            super(left, operator, right);
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object l = left.eval(env);
+            Object r = right.eval(env);
+            Interpreter.checkNumberOperands(operator, l, r);
+            return (double)l * (double)r;
+        }
+    }
+
+    static class Divide extends Binary {
+        Divide(ExprNode left, Token operator, ExprNode right) {
+            super(left, operator, right);
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object l = left.eval(env);
+            Object r = right.eval(env);
+            Interpreter.checkNumberOperands(operator, l, r);
+            if ((double)r == 0)
+                throw new RuntimeError(operator,
+                    "divisor (right operand) must be non-zero");
+            return (double)l / (double)r;
+        }
+    }
+
+    // logical operators short-circuit...
+
+    static class And extends ExprNode {
+        final ExprNode left;
+        final ExprNode right;
+
+        And(ExprNode left, ExprNode right) {
+            this.left = left;
+            this.right = right;
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object l = left.eval(env);
+            if (!Interpreter.isTruthy(l))
+                return l;
+            return right.eval(env);
+        }
+    }
+
+    static class Or extends ExprNode {
+        final ExprNode left;
+        final ExprNode right;
+
+        Or(ExprNode left, ExprNode right) {
+            this.left = left;
+            this.right = right;
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object l = left.eval(env);
+            if (Interpreter.isTruthy(l))
+                return l;
+            return right.eval(env);
+        }
+    }
+
+    // ... but the ternary doesn't: all three operands are...
+    // ... evaluated, just like the visitor does
+    static class Ternary extends ExprNode {
+        final ExprNode left;
+        final ExprNode mid;
+        final ExprNode right;
+
+        Ternary(ExprNode left, ExprNode mid, ExprNode right) {
+            this.left = left;
+            this.mid = mid;
+            this.right = right;
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object l = left.eval(env);
+            Object m = mid.eval(env);
+            Object r = right.eval(env);
+            return Interpreter.isTruthy(l) ? m : r;
+        }
+    }
+
+    // unary operators...
+
+    static class Negate extends ExprNode {
+        final Token operator;
+        final ExprNode right;
+
+        Negate(Token operator, ExprNode right) {
+            this.operator = operator;
+            this.right = right;
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object r = right.eval(env);
+            Interpreter.checkNumberOperand(operator, r);
+            return -(double)r;
+        }
+    }
+
+    static class Not extends ExprNode {
+        final ExprNode right;
+
+        Not(ExprNode right) {
+            this.right = right;
+        }
+
+        @Override
+        Object eval(Environment env) {
+            return !Interpreter.isTruthy(right.eval(env));
+        }
+    }
+
+    // calls and properties...
+
+    static class Call extends ExprNode {
+        // natives and classes take the interpreter as a param
+        final Interpreter interpreter;
+        final ExprNode callee;
+        final Token paren;
+        final ExprNode[] args;
+
+        Call(Interpreter interpreter, ExprNode callee, Token paren,
+             ExprNode[] args) {
+            this.interpreter = interpreter;
+            this.callee = callee;
+            this.paren = paren;
+            this.args = args;
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object function = callee.eval(env);
+            return call(interpreter, function, paren, evalArgs(args, env));
+        }
+    }
+
+    // `obj.method(args)`, see Interpreter.invoke()
+    static class Invoke extends ExprNode {
+        final Interpreter interpreter;
+        final ExprNode object;
+        final Token name;
+        final Token paren;
+        final ExprNode[] args;
+        final PropertyCache cache = new PropertyCache();
+
+        Invoke(Interpreter interpreter, ExprNode object, Token name,
+               Token paren, ExprNode[] args) {
+            this.interpreter = interpreter;
+            this.object = object;
+            this.name = name;
+            this.paren = paren;
+            this.args = args;
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object obj = object.eval(env);
+            if (!(obj instanceof LoxInstance))
+                throw new RuntimeError(name, "only instances have properties");
+
+            LoxInstance instance = (LoxInstance)obj;
+            LoxFunction method = cache.method(instance, name);
+
+            // a field that holds something callable
+            if (method == null) {
+                Object function = cache.get(instance, name);
+                return call(interpreter, function, paren, evalArgs(args, env));
+            }
+
+            if (args.length != method.arity()) {
+                evalArgs(args, env);
+                throw new RuntimeError(paren, "expected " +
+                    method.arity() + " arguments but got " + args.length);
+            }
+
+            // the args go straight into the method's frame, after "this"
+            Object[] frame = method.newFrame(instance);
+            for (int i = 0; i < args.length; i++)
+                frame[i + 1] = args[i].eval(env);
+
+            return method.execute(interpreter, instance, frame);
+        }
+    }
+
+    private static Object[] evalArgs(ExprNode[] args, Environment env) {
+        Object[] arguments = new Object[args.length];
+        for (int i = 0; i < args.length; i++)
+            arguments[i] = args[i].eval(env);
+        return arguments;
+    }
+
+    private static Object call(Interpreter interpreter, Object function,
+                               Token paren, Object[] arguments) {
+        if (!(function instanceof LoxCallable)) {
+            throw new RuntimeError(paren,
+                "can only call functions and classes");
+        }
+
+        LoxCallable callable = (LoxCallable)function;
+        if (arguments.length != callable.arity()) {
+            throw new RuntimeError(paren, "expected " +
+                callable.arity() + " arguments but got " +
+                arguments.length);
+        }
+
+        return callable.call(interpreter, arguments);
+    }
+
+    static class GetProperty extends ExprNode {
+        final ExprNode object;
+        final Token name;
+        final PropertyCache cache = new PropertyCache();
+
+        GetProperty(ExprNode object, Token name) {
+            this.object = object;
+            this.name = name;
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object obj = object.eval(env);
+            if (obj instanceof LoxInstance)
+                return cache.get((LoxInstance)obj, name);
+
+            throw new RuntimeError(name, "only instances have properties");
+        }
+    }
+
+    static class SetProperty extends ExprNode {
+        final ExprNode object;
+        final Token name;
+        final ExprNode value;
+        final PropertyCache cache = new PropertyCache();
+
+        SetProperty(ExprNode object, Token name, ExprNode value) {
+            this.object = object;
+            this.name = name;
+            this.value = value;
+        }
+
+        @Override
+        Object eval(Environment env) {
+            Object obj = object.eval(env);
+            if (!(obj instanceof LoxInstance))
+                throw new RuntimeError(name, "only instances have fields");
+
+            Object result = value.eval(env);
+            cache.set((LoxInstance)obj, name, result);
+            return result;
+        }
+    }
+
+    // "super" is slot 0 at `depth`, "this" is slot 0 one scope in
+    static class Super extends ExprNode {
+        final int depth;
+        final Token method;
+
+        Super(int depth, Token method) {
+            this.depth = depth;
+            this.method = method;
+        }
+
+        @Override
+        Object eval(Environment env) {
+            LoxClass superclass = (LoxClass)env.getAt(depth, 0);
+            LoxInstance obj = (LoxInstance)env.getAt(depth - 1, 0);
+
+            LoxFunction found = superclass.findMethod(method.symbol);
+            if (found == null)
+                throw new RuntimeError(method,
+                    "undefined property '" + method.lexeme + "'");
+
+            return found.bind(obj);
+        }
+    }
+}
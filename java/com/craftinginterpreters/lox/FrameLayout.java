@@ -0,0 +1,8 @@
+package com.craftinginterpreters.lox;
+
+// how many slots a call to a function needs: "this" (for a method)...
+// ... then the params, then every local its body declares at the...
+// ... top level; the resolver counts them once per declaration
+class FrameLayout {
+    int size = 0;
+}
@@ -0,0 +1,76 @@
+package com.craftinginterpreters.lox;
+
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.concurrent.Callable;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ForkJoinPool;
+import java.util.concurrent.Future;
+
+// scans, parses and resolves many files at once, one task per file...
+// ... on a ForkJoinPool; each task has its own Scanner, Parser and...
+// ... Resolver, and nothing they touch is shared between files
+//
+// a file's errors are collected instead of printed (see...
+// ... Lox.collectErrors()) and its locals go in its own table, so...
+// ... the results come back in the order the files were given...
+// ... no matter which finished first
+class FrontEnd {
+    // one file, ready to run unless it has errors
+    static class Result {
+        final String name;
+        final List<Stmt> stmts;
+        final Map<Expr, Slot> locals;
+        final List<String> errors;
+
+        Result(String name, List<Stmt> stmts, Map<Expr, Slot> locals,
+               List<String> errors) {
+            this.name = name;
+            this.stmts = stmts;
+            this.locals = locals;
+            this.errors = errors;
+        }
+    }
+
+    static List<Result> process(List<String> names, List<String> sources,
+                                ForkJoinPool pool) {
+        List<Callable<Result>> tasks = new ArrayList<>();
+        for (int i = 0; i < names.size(); i++) {
+            String name = names.get(i);
+            String src = sources.get(i);
+            tasks.add(() -> process(name, src));
+        }
+
+        List<Result> results = new ArrayList<>();
+        try {
+            for (Future<Result> result : pool.invokeAll(tasks))
+                results.add(result.get());
+        } catch (InterruptedException e) {
+            Thread.currentThread().interrupt();
+            throw new IllegalStateException("interrupted", e);
+        } catch (ExecutionException e) {
+            throw new IllegalStateException(e.getCause());
+        }
+        return results;
+    }
+
+    private static Result process(String name, String src) {
+        List<String> errors = new ArrayList<>();
+        Map<Expr, Slot> locals = new HashMap<>();
+
+        Lox.collectErrors(errors);
+        try {
+            List<Stmt> stmts = new Parser(new Scanner(src).scanTokens()).parse();
+
+            // like Lox.run(), syntax errors skip resolving
+            if (errors.isEmpty())
+                new Resolver(locals).resolve(stmts);
+
+            return new Result(name, stmts, locals, errors);
+        } finally {
+            Lox.collectErrors(null);
+        }
+    }
+}
@@ -0,0 +1,102 @@
+package com.craftinginterpreters.lox;
+
+import java.io.IOException;
+import java.lang.management.ManagementFactory;
+import java.nio.charset.Charset;
+import java.nio.file.Files;
+import java.nio.file.Paths;
+import java.util.List;
+
+// times scanning + parsing a large source and reports how much...
+// ... heap the token stream and AST hold on to afterwards
+//
+// usage: FrontEndBench [megabytes | script] [reps]
+//        (generates 50 MB of Lox by default)
+public class FrontEndBench {
+    // repeated to build the generated input
+    private static final String SNIPPET =
+        "// a chunk of typical jlox code\n" +
+        "class Point < Base {\n" +
+        "    init(x, y) {\n" +
+        "        this.x = x;\n" +
+        "        this.y = y;\n" +
+        "    }\n" +
+        "    length() {\n" +
+        "        return this.x * this.x + this.y * this.y;\n" +
+        "    }\n" +
+        "}\n" +
+        "fun scale(point, factor) {\n" +
+        "    var result = Point(point.x * factor, point.y * factor);\n" +
+        "    if (factor > 1.5 and !nil) print \"growing \" + factor;\n" +
+        "    for (var i = 0; i < 10; i = i + 1) result.x = result.x - 0.25;\n" +
+        "    return result.length() >= 100 ? result : point;\n" +
+        "}\n";
+
+    public static void main(String[] args) throws IOException {
+        String src;
+        if (args.length > 0 && !args[0].matches("\\d+")) {
+            byte[] bytes = Files.readAllBytes(Paths.get(args[0]));
+            src = new String(bytes, Charset.defaultCharset());
+        } else {
+            int megabytes = args.length > 0 ? Integer.parseInt(args[0]) : 50;
+            src = generate(megabytes * 1024L * 1024L);
+        }
+        int reps = args.length > 1 ? Integer.parseInt(args[1]) : 5;
+
+        System.out.printf("source: %.1f MB%n", src.length() / 1048576.0);
+
+        long best = Long.MAX_VALUE;
+        for (int i = 0; i < reps; i++) {
+            long start = System.nanoTime();
+            List<Stmt> stmts = new Parser(new Scanner(src).scanTokens()).parse();
+            long elapsed = System.nanoTime() - start;
+
+            best = Math.min(best, elapsed);
+            System.out.printf("rep %d: %.1f ms (%d statements)%n",
+                i + 1, elapsed / 1e6, stmts.size());
+        }
+        System.out.printf("best scan+parse: %.1f ms (%.1f MB/s)%n",
+            best / 1e6, src.length() / 1048576.0 / (best / 1e9));
+
+        // what one pass allocates, and what stays reachable after it
+        long baseline = usedHeap();
+        long allocatedBefore = allocatedBytes();
+
+        TokenStream tokens = new Scanner(src).scanTokens();
+        long afterScan = usedHeap();
+        List<Stmt> stmts = new Parser(tokens).parse();
+        long allocated = allocatedBytes() - allocatedBefore;
+        long afterParse = usedHeap();
+
+        System.out.printf("tokens: %d, retained %.1f MB%n",
+            tokens.size(), (afterScan - baseline) / 1048576.0);
+        System.out.printf("tokens + AST retained: %.1f MB%n",
+            (afterParse - baseline) / 1048576.0);
+        System.out.printf("allocated by scan+parse: %.1f MB%n",
+            allocated / 1048576.0);
+
+        // keep both alive through the measurements above
+        if (stmts.isEmpty() && tokens.size() < 0)
+            System.out.println();
+    }
+
+    static String generate(long chars) {
+        StringBuilder builder = new StringBuilder((int)chars + SNIPPET.length());
+        while (builder.length() < chars)
+            builder.append(SNIPPET);
+        return builder.toString();
+    }
+
+    private static long usedHeap() {
+        Runtime runtime = Runtime.getRuntime();
+        for (int i = 0; i < 3; i++)
+            System.gc();
+        return runtime.totalMemory() - runtime.freeMemory();
+    }
+
+    private static long allocatedBytes() {
+        com.sun.management.ThreadMXBean threads =
+            (com.sun.management.ThreadMXBean)ManagementFactory.getThreadMXBean();
+        return threads.getThreadAllocatedBytes(Thread.currentThread().getId());
+    }
+}
@@ -0,0 +1,77 @@
+package com.craftinginterpreters.lox;
+
+import java.io.IOException;
+import java.nio.charset.Charset;
+import java.nio.file.Files;
+import java.nio.file.Paths;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.ForkJoinPool;
+
+// times FrontEnd over the same set of files w/ 1, 2, 4, ... up to...
+// ... every core, and reports the speedup over a single thread
+//
+// usage: FrontEndScaling [files [kilobytes-per-file]] [reps]
+//        FrontEndScaling script.lox ... (the given scripts)
+//        (64 generated files of 512 KB each by default)
+public class FrontEndScaling {
+    public static void main(String[] args) throws IOException {
+        List<String> names = new ArrayList<>();
+        List<String> sources = new ArrayList<>();
+        int reps = 5;
+
+        if (args.length > 0 && !args[0].matches("\\d+")) {
+            for (String path : args) {
+                names.add(path);
+                byte[] bytes = Files.readAllBytes(Paths.get(path));
+                sources.add(new String(bytes, Charset.defaultCharset()));
+            }
+        } else {
+            int files = args.length > 0 ? Integer.parseInt(args[0]) : 64;
+            int kilobytes = args.length > 1 ? Integer.parseInt(args[1]) : 512;
+            if (args.length > 2)
+                reps = Integer.parseInt(args[2]);
+
+            String src = FrontEndBench.generate(kilobytes * 1024L);
+            for (int i = 0; i < files; i++) {
+                names.add("generated" + i + ".lox");
+                sources.add(src);
+            }
+        }
+
+        long chars = 0;
+        for (String src : sources)
+            chars += src.length();
+        System.out.printf("%d files, %.1f MB%n", names.size(), chars / 1048576.0);
+
+        int cores = Runtime.getRuntime().availableProcessors();
+        List<Integer> counts = new ArrayList<>();
+        for (int threads = 1; threads < cores; threads *= 2)
+            counts.add(threads);
+        counts.add(cores);
+
+        double single = 0;
+        for (int threads : counts) {
+            ForkJoinPool pool = new ForkJoinPool(threads);
+            long best = Long.MAX_VALUE;
+            try {
+                // the first pass warms up the JIT and the pool
+                for (int i = 0; i <= reps; i++) {
+                    long start = System.nanoTime();
+                    FrontEnd.process(names, sources, pool);
+                    long elapsed = System.nanoTime() - start;
+                    if (i > 0)
+                        best = Math.min(best, elapsed);
+                }
+            } finally {
+                pool.shutdown();
+            }
+
+            double ms = best / 1e6;
+            if (threads == 1)
+                single = ms;
+            System.out.printf("%2d threads: %8.1f ms (%.1f MB/s, %.2fx)%n",
+                threads, ms, chars / 1048576.0 / (ms / 1e3), single / ms);
+        }
+    }
+}
@@ -1,6 +1,5 @@
 package com.craftinginterpreters.lox;
 
-import java.util.ArrayList;
 import java.util.HashMap;
 import java.util.List;
 import java.util.Map;
@@ -12,18 +11,17 @@ class Interpreter implements Expr.Visitor<Object>,
     
     final Environment globals = new Environment();
     private Environment env = globals;
-    private final Map<Expr, Integer> locals = new HashMap<>();
+    final Map<Expr, Slot> locals = new HashMap<>();
 
     Interpreter() {
-        globals.define("clock", new LoxCallable() {
+        globals.define(Symbols.intern("clock"), new LoxCallable() {
             @Override
             public int arity() {
                 return 0;
             }
 
             @Override
-            public Object call(Interpreter interpreter,
-                               List<Object> args) {
+            public Object call(Interpreter interpreter, Object[] args) {
                 return (double)System.currentTimeMillis() / 1000.0;
             }
 
@@ -44,6 +42,18 @@ class Interpreter implements Expr.Visitor<Object>,
         }
     }
 
+    // runs a program the closure engine compiled...
+    // ... top-level code executes directly in the globals
+    public void interpret(StmtNode[] program) {
+        try {
+            for (StmtNode stmt : program)
+                stmt.exec(globals);
+        }
+        catch(RuntimeError error) {
+            Lox.runtimeError(error);
+        }
+    }
+
     public void interpret1(Expr expr) {
         try {
             evaluate(expr);
@@ -68,8 +78,9 @@ class Interpreter implements Expr.Visitor<Object>,
             if (!(superclass instanceof LoxClass))
                 throw new RuntimeError(stmt.superclass.name, "superclass must be a class");
         }
-        // declaring class's name in current env
-        env.define(stmt.name.lexeme, null);
+        // declaring class's name in current env...
+        // ... and remembering its slot to store the class in later
+        int slot = env.define(stmt.name.symbol, null);
 
         // evaluating a subclass def...
         // ... results in a new env
@@ -78,17 +89,17 @@ class Interpreter implements Expr.Visitor<Object>,
 
             // store a ref to the actual LoxClass obj...
             // ... for the superclass which is now in runtime
-            env.define("super", superclass);
+            env.define(Symbols.SUPER, superclass);
         }
 
         // turning method declarations into a LoxFunction object (runtime representation)
-        Map<String, LoxFunction> methods = new HashMap<>();
+        SymbolMap<LoxFunction> methods = new SymbolMap<>();
         for (Stmt.Function method : stmt.methods) {
             LoxFunction function = new LoxFunction(
                 method, env, 
-                method.name.lexeme.equals("init")
+                method.name.symbol == Symbols.INIT
             );
-            methods.put(method.name.lexeme, function);
+            methods.put(method.name.symbol, function);
         }
 
         // turn class syntax node into a LoxClass...
@@ -100,7 +111,10 @@ class Interpreter implements Expr.Visitor<Object>,
             env = env.enclosing;
 
         // store class object in previously defined variable
-        env.assign(stmt.name, klass);
+        if (slot < 0)
+            env.assign(stmt.name, klass);
+        else
+            env.assignAt(0, slot, klass);
 
         return null;
     }
@@ -117,7 +131,7 @@ class Interpreter implements Expr.Visitor<Object>,
         // ... also for actual function declarations `isInitializer`
         LoxFunction function = new LoxFunction(stmt, env, false);
 
-        env.define(stmt.name.lexeme, function);
+        env.define(stmt.name.symbol, function);
         return null;
     }
 
@@ -143,7 +157,9 @@ class Interpreter implements Expr.Visitor<Object>,
         if (stmt.value != null)
             value = evaluate(stmt.value);
         
-        throw new Return(value);
+        returning = true;
+        returnValue = value;
+        return null;
     }
 
     @Override
@@ -155,15 +171,18 @@ class Interpreter implements Expr.Visitor<Object>,
             value = evaluate(stmt.initializer);
         
         // set it to nil if it comes w/ no initializer
-        env.define(stmt.name.lexeme, value);
+        env.define(stmt.name.symbol, value);
 
         return null;
     }
 
     @Override
     public Void visitWhileStmt(Stmt.While stmt) {
-        while (isTruthy(evaluate(stmt.condition)))
+        while (isTruthy(evaluate(stmt.condition))) {
             execute(stmt.body);
+            if (returning)
+                break;
+        }
         
         return null;
     }
@@ -173,9 +192,9 @@ class Interpreter implements Expr.Visitor<Object>,
     public Object visitAssignExpr(Expr.Assign expr) {
         Object value = evaluate(expr.value);
         
-        Integer distance = locals.get(expr);
-        if (distance != null)
-            env.assignAt(distance, expr.name, value);
+        Slot slot = locals.get(expr);
+        if (slot != null)
+            env.assignAt(slot.depth, slot.index, value);
         else
             globals.assign(expr.name, value);
 
@@ -184,10 +203,35 @@ class Interpreter implements Expr.Visitor<Object>,
 
     @Override
     public Object visitBinaryExpr(Expr.Binary expr) {
+        switch (expr.operator.type) {
+            // numeric operators take the typed path and...
+            // ... box their result just once, here
+            case MINUS:
+            case PLUS:
+            case SLASH:
+            case STAR: {
+                double value = arithmetic(expr);
+                if (unboxFailed)
+                    return takeFailedValue();
+                return value;
+            }
+
+            case GREATER:
+            case GREATER_EQUAL:
+            case LESS:
+            case LESS_EQUAL:
+                return comparison(expr);
+        }
+
         Object left = evaluate(expr.left);
         Object right = evaluate(expr.right);
+        return binary(expr.operator, left, right);
+    }
 
-        switch(expr.operator.type) {
+    // the generic operators on boxed values, which is also...
+    // ... where the typed path falls back to on a non-number
+    static Object binary(Token operator, Object left, Object right) {
+        switch(operator.type) {
             // "expression" (?) operator
             case COMMA:
                 return right;
@@ -202,24 +246,24 @@ class Interpreter implements Expr.Visitor<Object>,
 
             // comparison operators:
             case GREATER:
-                checkNumberOperands(expr.operator, left, right);
+                checkNumberOperands(operator, left, right);
                 return (double)left > (double)right;
 
             case GREATER_EQUAL:
-                checkNumberOperands(expr.operator, left, right);
+                checkNumberOperands(operator, left, right);
                 return (double)left >= (double)right;
 
             case LESS:
-            checkNumberOperands(expr.operator, left, right);
+                checkNumberOperands(operator, left, right);
                 return (double)left < (double)right;
 
             case LESS_EQUAL:
-            checkNumberOperands(expr.operator, left, right);
+                checkNumberOperands(operator, left, right);
                 return (double)left <= (double)right;
 
             // arithmetic operators:
             case MINUS:
-                checkNumberOperands(expr.operator, left, right);
+                checkNumberOperands(operator, left, right);
                 return (double)left - (double)right;
 
             case PLUS:
@@ -233,18 +277,18 @@ class Interpreter implements Expr.Visitor<Object>,
                     return (double)left + (double)right;
                 if (left instanceof String && right instanceof String)
                     return (String)left + (String)right;
-                throw new RuntimeError(expr.operator,
+                throw new RuntimeError(operator,
                     "operands must numbers or strings");
             
             case SLASH:
-                checkNumberOperands(expr.operator, left, right);
+                checkNumberOperands(operator, left, right);
                 if ((double)right == 0)
-                    throw new RuntimeError(expr.operator,
+                    throw new RuntimeError(operator,
                         "divisor (right operand) must be non-zero");
                 return (double)left / (double)right;
             
             case STAR:
-                checkNumberOperands(expr.operator, left, right);
+                checkNumberOperands(operator, left, right);
                 return (double)left * (double)right;
         }
 
@@ -252,7 +296,120 @@ class Interpreter implements Expr.Visitor<Object>,
         return null;
     }
 
-    private boolean isEqual(Object a, Object b) {
+    // the typed path: evaluateDouble() computes arithmetic on...
+    // ... primitive doubles instead of boxing every intermediate...
+    // ... result, speculating that operands are numbers
+    //
+    // when one isn't, unbox() leaves it in `failedValue` and sets...
+    // ... `unboxFailed`; the caller then redoes that operator w/...
+    // ... binary(), so evaluation order and errors are unchanged
+    private boolean unboxFailed = false;
+    private Object failedValue = null;
+
+    private double evaluateDouble(Expr expr) {
+        if (expr instanceof Expr.Binary) {
+            Expr.Binary binary = (Expr.Binary)expr;
+            switch (binary.operator.type) {
+                case MINUS:
+                case PLUS:
+                case SLASH:
+                case STAR:
+                    return arithmetic(binary);
+            }
+        }
+        else if (expr instanceof Expr.Grouping)
+            return evaluateDouble(((Expr.Grouping)expr).expression);
+        else if (expr instanceof Expr.Unary) {
+            Expr.Unary unary = (Expr.Unary)expr;
+            if (unary.operator.type == TokenType.MINUS)
+                return negate(unary);
+        }
+
+        return unbox(evaluate(expr));
+    }
+
+    private double unbox(Object value) {
+        if (value instanceof Double)
+            return (double)value;
+
+        unboxFailed = true;
+        failedValue = value;
+        return 0;
+    }
+
+    private Object takeFailedValue() {
+        Object value = failedValue;
+        unboxFailed = false;
+        failedValue = null;
+        return value;
+    }
+
+    private double arithmetic(Expr.Binary expr) {
+        double left = evaluateDouble(expr.left);
+        if (unboxFailed) {
+            Object boxed = takeFailedValue();
+            return unbox(binary(expr.operator, boxed, evaluate(expr.right)));
+        }
+
+        double right = evaluateDouble(expr.right);
+        if (unboxFailed)
+            return unbox(binary(expr.operator, left, takeFailedValue()));
+
+        switch (expr.operator.type) {
+            case MINUS:
+                return left - right;
+            case PLUS:
+                return left + right;
+            case STAR:
+                return left * right;
+            case SLASH:
+                if (right == 0)
+                    throw new RuntimeError(expr.operator,
+                        "divisor (right operand) must be non-zero");
+                return left / right;
+        }
+
+        // unreachable
+        return 0;
+    }
+
+    private Object comparison(Expr.Binary expr) {
+        double left = evaluateDouble(expr.left);
+        if (unboxFailed) {
+            Object boxed = takeFailedValue();
+            return binary(expr.operator, boxed, evaluate(expr.right));
+        }
+
+        double right = evaluateDouble(expr.right);
+        if (unboxFailed)
+            return binary(expr.operator, left, takeFailedValue());
+
+        switch (expr.operator.type) {
+            case GREATER:
+                return left > right;
+            case GREATER_EQUAL:
+                return left >= right;
+            case LESS:
+                return left < right;
+            case LESS_EQUAL:
+                return left <= right;
+        }
+
+        // unreachable
+        return null;
+    }
+
+    private double negate(Expr.Unary expr) {
+        double right = evaluateDouble(expr.right);
+
+        // always throws: the operand isn't a number
+        if (unboxFailed)
+            checkNumberOperand(expr.operator, takeFailedValue());
+
+        return -right;
+    }
+
+    static boolean isEqual(Object a, Object b) {
         if (a == null && b == null)
             return true;
         if (a == null)
@@ -263,11 +420,46 @@ class Interpreter implements Expr.Visitor<Object>,
     
     @Override
     public Object visitCallExpr(Expr.Call expr) {
-        Object callee = evaluate(expr.callee);
+        if (expr.callee instanceof Expr.Get)
+            return invoke(expr, (Expr.Get)expr.callee);
 
-        List<Object> args = new ArrayList<>();
-        for (Expr arg : expr.args)
-            args.add(evaluate(arg));
+        return finishCall(expr, evaluate(expr.callee));
+    }
+
+    // `obj.method(args)` calls the method w/ `obj` as "this"...
+    // ... directly, w/out binding it to a new LoxFunction first
+    private Object invoke(Expr.Call expr, Expr.Get get) {
+        Object obj = evaluate(get.object);
+        if (!(obj instanceof LoxInstance))
+            throw new RuntimeError(get.name, "only instances have properties");
+
+        LoxInstance instance = (LoxInstance)obj;
+        LoxFunction method = get.cache.method(instance, get.name);
+
+        // a field that holds something callable
+        if (method == null)
+            return finishCall(expr, get.cache.get(instance, get.name));
+
+        if (expr.args.size() != method.arity())
+            throw arityError(expr, method.arity());
+
+        return method.execute(this, instance, frame(expr, method, instance));
+    }
+
+    private Object finishCall(Expr.Call expr, Object callee) {
+        // a function's args are evaluated straight into its frame
+        if (callee instanceof LoxFunction) {
+            LoxFunction function = (LoxFunction)callee;
+            if (expr.args.size() != function.arity())
+                throw arityError(expr, function.arity());
+
+            return function.execute(this, function.receiver,
+                frame(expr, function, function.receiver));
+        }
+
+        Object[] args = new Object[expr.args.size()];
+        for (int i = 0; i < args.length; i++)
+            args[i] = evaluate(expr.args.get(i));
         
         if (!(callee instanceof LoxCallable)) {
             throw new RuntimeError(expr.paren, 
@@ -275,14 +467,34 @@ class Interpreter implements Expr.Visitor<Object>,
         }
         
         LoxCallable function = (LoxCallable) callee;
-        if (args.size() != function.arity()) {
+        if (args.length != function.arity()) {
             throw new RuntimeError(expr.paren, "expected " +
                 function.arity() + " arguments but got " +
-                args.size());
+                args.length);
         }
 
         return function.call(this, args);
     }
+
+    // evaluates the args into a new frame for `function`, after...
+    // ... the receiver; nothing else is allocated for the call
+    private Object[] frame(Expr.Call expr, LoxFunction function,
+                           LoxInstance receiver) {
+        Object[] frame = function.newFrame(receiver);
+        int slot = receiver != null ? 1 : 0;
+        for (Expr arg : expr.args)
+            frame[slot++] = evaluate(arg);
+        return frame;
+    }
+
+    // the args are still evaluated, for their side effects
+    private RuntimeError arityError(Expr.Call expr, int arity) {
+        for (Expr arg : expr.args)
+            evaluate(arg);
+
+        return new RuntimeError(expr.paren, "expected " + arity +
+            " arguments but got " + expr.args.size());
+    }
     
     @Override
     public Object visitGetExpr(Expr.Get expr) {
@@ -291,7 +503,7 @@ class Interpreter implements Expr.Visitor<Object>,
 
         // look up the property
         if (obj instanceof LoxInstance)
-            return ((LoxInstance) obj).get(expr.name);
+            return expr.cache.get((LoxInstance)obj, expr.name);
         
         throw new RuntimeError(expr.name, "only instances have properties");
     }
@@ -338,21 +550,22 @@ class Interpreter implements Expr.Visitor<Object>,
         Object value = evaluate(expr.value);
 
         // ...and store it on the instance
-        ((LoxInstance)obj).set(expr.name, value);
+        expr.cache.set((LoxInstance)obj, expr.name, value);
 
         return value;
     }
 
     @Override
     public Object visitSuperExpr(Expr.Super expr) {
-        // look up "super" in the proper env
-        int distance = locals.get(expr);
-        LoxClass superclass = (LoxClass)env.getAt(distance, "super");
+        // look up "super" in the proper env...
+        // ... it's always the only slot there
+        int distance = locals.get(expr).depth;
+        LoxClass superclass = (LoxClass)env.getAt(distance, 0);
 
         // offsetting distance by 1 looks up "this" in inner env
-        LoxInstance obj = (LoxInstance)env.getAt(distance - 1, "this");
+        LoxInstance obj = (LoxInstance)env.getAt(distance - 1, 0);
 
-        LoxFunction method = superclass.findMethod(expr.method.lexeme);
+        LoxFunction method = superclass.findMethod(expr.method.symbol);
         
         // in case of failure to find the method...
         if (method == null)
@@ -384,6 +597,9 @@ class Interpreter implements Expr.Visitor<Object>,
     
     @Override
     public Object visitUnaryExpr(Expr.Unary expr) {
+        if (expr.operator.type == TokenType.MINUS)
+            return negate(expr);
+
         // bc unary expressions are right associative...
         // ... we first evaluate the operand expression
         Object right = evaluate(expr.right);
@@ -410,6 +626,21 @@ class Interpreter implements Expr.Visitor<Object>,
         return lookUpVariable(expr.name, expr);
     }
 
+    // `return` doesn't throw: it leaves its value here and sets...
+    // ... `returning`, which stops every statement list and loop...
+    // ... it's inside of until the function call takes the value
+    private boolean returning = false;
+    private Object returnValue = null;
+
+    // the value the last `return` left, nil if the body ran off...
+    // ... its end; clears the signal for the caller to carry on
+    Object takeReturnValue() {
+        Object value = returnValue;
+        returning = false;
+        returnValue = null;
+        return value;
+    }
+
     void executeBlock(List<Stmt> stmts,
                       Environment env) {
         
@@ -418,8 +649,11 @@ class Interpreter implements Expr.Visitor<Object>,
             this.env = env;
 
             // executing list of Stmt in the context of a given env
-            for (Stmt stmt : stmts)
+            for (Stmt stmt : stmts) {
                 execute(stmt);
+                if (returning)
+                    break;
+            }
         } finally {
             this.env = previous;
         }
@@ -433,11 +667,28 @@ class Interpreter implements Expr.Visitor<Object>,
         return expr.accept(this);
     }
 
-    void resolve(Expr expr, int depth) {
-        locals.put(expr, depth);
+    // evaluates `expr` in `env`, for code JvmCompiler hands back
+    Object evaluate(Expr expr, Environment env) {
+        Environment previous = this.env;
+        try {
+            this.env = env;
+            return evaluate(expr);
+        } finally {
+            this.env = previous;
+        }
+    }
+
+    // adds the locals of a file resolved on its own (see FrontEnd)
+    void resolve(Map<Expr, Slot> resolved) {
+        locals.putAll(resolved);
+    }
+
+    // where the resolver put a variable, or null for a global
+    Slot slotOf(Expr expr) {
+        return locals.get(expr);
     }
 
-    private boolean isTruthy(Object obj) {
+    static boolean isTruthy(Object obj) {
         if (obj == null)
             return false;
         if (obj instanceof Boolean)
@@ -445,21 +696,21 @@ class Interpreter implements Expr.Visitor<Object>,
         return true;
     }
 
-    private void checkNumberOperand(Token operator, Object operand) {
+    static void checkNumberOperand(Token operator, Object operand) {
         if (operand instanceof Double)
             return;
 
         throw new RuntimeError(operator, "operand must be a number");
     }
 
-    private void checkNumberOperands(Token op, Object left, Object right) {
+    static void checkNumberOperands(Token op, Object left, Object right) {
         if (left instanceof Double && right instanceof Double)
             return;
 
         throw new RuntimeError(op, "operands must be numbers");
     }
 
-    private String stringify(Object obj) {
+    static String stringify(Object obj) {
         if (obj == null)
             return "nil";
         
@@ -474,9 +725,9 @@ class Interpreter implements Expr.Visitor<Object>,
     }
 
     private Object lookUpVariable(Token name, Expr expr) {
-        Integer distance = locals.get(expr);
-        if (distance != null)
-            return env.getAt(distance, name.lexeme);
+        Slot slot = locals.get(expr);
+        if (slot != null)
+            return env.getAt(slot.depth, slot.index);
         else
             return globals.get(name);
     }
@@ -0,0 +1,11 @@
+package com.craftinginterpreters.lox;
+
+// what every class JvmCompiler generates implements: runs one...
+// ... function body (or top-level program) in `env`, w/ the...
+// ... Lox values, tokens and caches it refers to in `constants`
+//
+// public, like JvmRuntime, since the generated classes live in...
+// ... their own class loader and so can't see package-private types
+public interface JvmCode {
+    Object exec(Object env, Object[] constants);
+}
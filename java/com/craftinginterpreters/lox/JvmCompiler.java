@@ -0,0 +1,486 @@
+package com.craftinginterpreters.lox;
+
+import java.util.ArrayList;
+import java.util.IdentityHashMap;
+import java.util.List;
+import java.util.Map;
+
+import static com.craftinginterpreters.lox.ClassWriter.*;
+
+// turns resolved top-level code and function bodies into JVM...
+// ... classes (one per body) so HotSpot can JIT them like any...
+// ... other Java code
+//
+// each class implements JvmCode; its exec() keeps the current...
+// ... Environment in a JVM local and does all the work through...
+// ... JvmRuntime calls, w/ control flow as real JVM branches
+//
+// classes and `super` aren't compiled: those statements and...
+// ... expressions are handed back to the Interpreter in place,...
+// ... and a body that fails to compile or load at all runs on...
+// ... the Interpreter (or as a plain LoxFunction) instead
+class JvmCompiler implements Expr.Visitor<Void>, Stmt.Visitor<Void> {
+    private static final String RUNTIME = "com/craftinginterpreters/lox/JvmRuntime";
+    private static final String CODE = "com/craftinginterpreters/lox/JvmCode";
+    private static final String OBJECT = "java/lang/Object";
+
+    // JVM locals of exec()
+    private static final int THIS = 0;
+    private static final int ENV = 1;
+    private static final int CONSTANTS = 2;
+
+    // a compiled body and the constants its code indexes into
+    static class Unit {
+        final JvmCode code;
+        final Object[] constants;
+
+        Unit(JvmCode code, Object[] constants) {
+            this.code = code;
+            this.constants = constants;
+        }
+    }
+
+    private static class Loader extends ClassLoader {
+        Loader() {
+            super(JvmCompiler.class.getClassLoader());
+        }
+
+        Class<?> define(String name, byte[] bytes) {
+            return defineClass(name, bytes, 0, bytes.length);
+        }
+    }
+
+    private static final Loader loader = new Loader();
+    private static int unitCount = 0;
+
+    private final Interpreter interpreter;
+    private final ClassWriter cw = new ClassWriter();
+    private final ClassWriter.Code code = new ClassWriter.Code(3);
+
+    private final List<Object> constants = new ArrayList<>();
+    private final Map<Object, Integer> constantIndexes = new IdentityHashMap<>();
+
+    // the JVM local holding the current Environment
+    private int env = ENV;
+
+    private JvmCompiler(Interpreter interpreter) {
+        this.interpreter = interpreter;
+    }
+
+    // runs a program, compiled if possible
+    static void interpret(Interpreter interpreter, List<Stmt> stmts) {
+        Unit unit = compile(interpreter, stmts);
+        if (unit == null) {
+            interpreter.interpret(stmts);
+            return;
+        }
+
+        try {
+            unit.code.exec(interpreter.globals, unit.constants);
+        }
+        catch(RuntimeError error) {
+            Lox.runtimeError(error);
+        }
+    }
+
+    // null when the body couldn't be turned into a class
+    static Unit compile(Interpreter interpreter, List<Stmt> body) {
+        try {
+            return new JvmCompiler(interpreter).compileUnit(body);
+        } catch (RuntimeException | LinkageError |
+                 ReflectiveOperationException e) {
+            return null;
+        }
+    }
+
+    private Unit compileUnit(List<Stmt> body)
+            throws ReflectiveOperationException {
+        for (Stmt stmt : body)
+            stmt.accept(this);
+
+        // falling off the end returns nil
+        code.op(ACONST_NULL, 1);
+        code.op(ARETURN, -1);
+
+        ClassWriter.Code init = new ClassWriter.Code(1);
+        init.aload(THIS);
+        init.op(INVOKESPECIAL, -1, cw.methodRef(OBJECT, "<init>", "()V"));
+        init.op(RETURN, 0);
+
+        cw.method(ACC_PUBLIC, "<init>", "()V", init);
+        cw.method(ACC_PUBLIC, "exec", descriptor("(O[O)O"), code);
+
+        String name;
+        synchronized (loader) {
+            name = "loxgen/Unit" + unitCount++;
+        }
+        byte[] bytes = cw.toBytes(name, OBJECT, new String[] { CODE });
+
+        // verification happens here too, when the class is linked
+        Class<?> klass = loader.define(name.replace('/', '.'), bytes);
+        JvmCode instance = (JvmCode)klass.getDeclaredConstructor().newInstance();
+        return new Unit(instance, constants.toArray());
+    }
+
+    // descriptors below are written w/ "O" for java/lang/Object
+    private static String descriptor(String shorthand) {
+        return shorthand.replace("O", "L" + OBJECT + ";");
+    }
+
+    private void runtime(String method, String shorthand) {
+        String descriptor = descriptor(shorthand);
+        code.op(INVOKESTATIC, ClassWriter.stackDelta(descriptor),
+            cw.methodRef(RUNTIME, method, descriptor));
+    }
+
+    // pushes `value` from the constants array
+    private void constant(Object value) {
+        Integer index = constantIndexes.get(value);
+        if (index == null) {
+            index = constants.size();
+            constants.add(value);
+            constantIndexes.put(value, index);
+        }
+
+        code.aload(CONSTANTS);
+        code.pushInt(cw, index);
+        code.op(AALOAD, -1);
+    }
+
+    private void compile(Expr expr) {
+        expr.accept(this);
+    }
+
+    private void compile(Stmt stmt) {
+        stmt.accept(this);
+    }
+
+    // pushes the args as an Object[]
+    private void args(List<Expr> args) {
+        code.pushInt(cw, args.size());
+        code.op(ANEWARRAY, 0, cw.classRef(OBJECT));
+        for (int i = 0; i < args.size(); i++) {
+            code.op(DUP, 1);
+            code.pushInt(cw, i);
+            compile(args.get(i));
+            code.op(AASTORE, -3);
+        }
+    }
+
+    // has the Interpreter run what isn't compiled, in the current env
+    private void fallback(Stmt stmt) {
+        constant(interpreter);
+        constant(stmt);
+        code.aload(env);
+        runtime("execute", "(OOO)V");
+    }
+
+    private void fallback(Expr expr) {
+        constant(interpreter);
+        constant(expr);
+        code.aload(env);
+        runtime("evaluate", "(OOO)O");
+    }
+
+    @Override
+    public Void visitBlockStmt(Stmt.Block stmt) {
+        int enclosing = env;
+
+        code.aload(env);
+        runtime("scope", "(O)O");
+        env = code.newLocal();
+        code.astore(env);
+
+        for (Stmt inner : stmt.statements)
+            compile(inner);
+
+        env = enclosing;
+        return null;
+    }
+
+    @Override
+    public Void visitClassStmt(Stmt.Class stmt) {
+        fallback(stmt);
+        return null;
+    }
+
+    @Override
+    public Void visitExpressionStmt(Stmt.Expression stmt) {
+        compile(stmt.expression);
+        code.op(POP, -1);
+        return null;
+    }
+
+    @Override
+    public Void visitFunctionStmt(Stmt.Function stmt) {
+        Unit body = compile(interpreter, stmt.body);
+
+        Object template = stmt;
+        if (body != null)
+            template = new JvmFunction(stmt, body, null, false, null);
+
+        code.aload(env);
+        constant(template);
+        runtime("function", "(OO)V");
+        return null;
+    }
+
+    @Override
+    public Void visitIfStmt(Stmt.If stmt) {
+        ClassWriter.Label elseBranch = new ClassWriter.Label();
+        ClassWriter.Label end = new ClassWriter.Label();
+
+        compile(stmt.condition);
+        runtime("isTruthy", "(O)Z");
+        code.jump(IFEQ, elseBranch, -1);
+
+        compile(stmt.thenBranch);
+        code.jump(GOTO, end, 0);
+
+        code.mark(elseBranch);
+        if (stmt.elseBranch != null)
+            compile(stmt.elseBranch);
+        code.mark(end);
+        return null;
+    }
+
+    @Override
+    public Void visitPrintStmt(Stmt.Print stmt) {
+        compile(stmt.expression);
+        runtime("print", "(O)V");
+        return null;
+    }
+
+    @Override
+    public Void visitReturnStmt(Stmt.Return stmt) {
+        if (stmt.value != null)
+            compile(stmt.value);
+        else
+            code.op(ACONST_NULL, 1);
+
+        code.op(ARETURN, -1);
+        return null;
+    }
+
+    @Override
+    public Void visitVarStmt(Stmt.Var stmt) {
+        code.aload(env);
+        constant(stmt.name);
+
+        if (stmt.initializer != null)
+            compile(stmt.initializer);
+        else
+            code.op(ACONST_NULL, 1);
+
+        runtime("define", "(OOO)V");
+        return null;
+    }
+
+    @Override
+    public Void visitWhileStmt(Stmt.While stmt) {
+        ClassWriter.Label start = new ClassWriter.Label();
+        ClassWriter.Label end = new ClassWriter.Label();
+
+        code.mark(start);
+        compile(stmt.condition);
+        runtime("isTruthy", "(O)Z");
+        code.jump(IFEQ, end, -1);
+
+        compile(stmt.body);
+        code.jump(GOTO, start, 0);
+        code.mark(end);
+        return null;
+    }
+
+    @Override
+    public Void visitAssignExpr(Expr.Assign expr) {
+        Slot slot = interpreter.slotOf(expr);
+        if (slot == null) {
+            constant(interpreter.globals);
+            constant(expr.name);
+            compile(expr.value);
+            runtime("setGlobal", "(OOO)O");
+        } else {
+            code.aload(env);
+            code.pushInt(cw, slot.depth);
+            code.pushInt(cw, slot.index);
+            compile(expr.value);
+            runtime("setLocal", "(OIIO)O");
+        }
+        return null;
+    }
+
+    @Override
+    public Void visitBinaryExpr(Expr.Binary expr) {
+        compile(expr.left);
+
+        if (expr.operator.type == TokenType.COMMA) {
+            code.op(POP, -1);
+            compile(expr.right);
+            return null;
+        }
+
+        compile(expr.right);
+        switch (expr.operator.type) {
+            case BANG_EQUAL:
+                runtime("notEqual", "(OO)O");
+                return null;
+            case EQUAL_EQUAL:
+                runtime("equal", "(OO)O");
+                return null;
+        }
+
+        constant(expr.operator);
+        switch (expr.operator.type) {
+            case GREATER:       runtime("greater", "(OOO)O"); break;
+            case GREATER_EQUAL: runtime("greaterEqual", "(OOO)O"); break;
+            case LESS:          runtime("less", "(OOO)O"); break;
+            case LESS_EQUAL:    runtime("lessEqual", "(OOO)O"); break;
+            case MINUS:         runtime("subtract", "(OOO)O"); break;
+            case PLUS:          runtime("add", "(OOO)O"); break;
+            case SLASH:         runtime("divide", "(OOO)O"); break;
+            case STAR:          runtime("multiply", "(OOO)O"); break;
+            default:
+                throw new IllegalStateException("unknown operator");
+        }
+        return null;
+    }
+
+    @Override
+    public Void visitCallExpr(Expr.Call expr) {
+        if (expr.callee instanceof Expr.Get) {
+            Expr.Get get = (Expr.Get)expr.callee;
+
+            // [obj, obj] -> [obj, target] -> [obj, target, args]
+            compile(get.object);
+            code.op(DUP, 1);
+            constant(get.name);
+            constant(get.cache);
+            runtime("invokeTarget", "(OOO)O");
+
+            args(expr.args);
+            constant(interpreter);
+            constant(expr.paren);
+            runtime("invoke", "(OO[OOO)O");
+            return null;
+        }
+
+        compile(expr.callee);
+        args(expr.args);
+        constant(interpreter);
+        constant(expr.paren);
+        runtime("call", "(O[OOO)O");
+        return null;
+    }
+
+    @Override
+    public Void visitGetExpr(Expr.Get expr) {
+        compile(expr.object);
+        constant(expr.name);
+        constant(expr.cache);
+        runtime("get", "(OOO)O");
+        return null;
+    }
+
+    @Override
+    public Void visitGroupingExpr(Expr.Grouping expr) {
+        compile(expr.expression);
+        return null;
+    }
+
+    @Override
+    public Void visitLiteralExpr(Expr.Literal expr) {
+        if (expr.value == null)
+            code.op(ACONST_NULL, 1);
+        else
+            constant(expr.value);
+        return null;
+    }
+
+    @Override
+    public Void visitLogicalExpr(Expr.Logical expr) {
+        ClassWriter.Label end = new ClassWriter.Label();
+
+        // the left operand stays on the stack as the result...
+        // ... if it short-circuits
+        compile(expr.left);
+        code.op(DUP, 1);
+        runtime("isTruthy", "(O)Z");
+        if (expr.operator.type == TokenType.OR)
+            code.jump(IFNE, end, -1);
+        else
+            code.jump(IFEQ, end, -1);
+
+        code.op(POP, -1);
+        compile(expr.right);
+        code.mark(end);
+        return null;
+    }
+
+    @Override
+    public Void visitSetExpr(Expr.Set expr) {
+        compile(expr.object);
+        constant(expr.name);
+        runtime("instance", "(OO)O");
+
+        constant(expr.name);
+        constant(expr.cache);
+        compile(expr.value);
+        runtime("set", "(OOOO)O");
+        return null;
+    }
+
+    @Override
+    public Void visitSuperExpr(Expr.Super expr) {
+        fallback(expr);
+        return null;
+    }
+
+    @Override
+    public Void visitTernaryExpr(Expr.Ternary expr) {
+        compile(expr.left);
+        compile(expr.mid);
+        compile(expr.right);
+        runtime("ternary", "(OOO)O");
+        return null;
+    }
+
+    @Override
+    public Void visitThisExpr(Expr.This expr) {
+        variable(expr.keyword, expr);
+        return null;
+    }
+
+    @Override
+    public Void visitUnaryExpr(Expr.Unary expr) {
+        compile(expr.right);
+
+        if (expr.operator.type == TokenType.BANG) {
+            runtime("not", "(O)O");
+        } else {
+            constant(expr.operator);
+            runtime("negate", "(OO)O");
+        }
+        return null;
+    }
+
+    @Override
+    public Void visitVariableExpr(Expr.Variable expr) {
+        variable(expr.name, expr);
+        return null;
+    }
+
+    private void variable(Token name, Expr expr) {
+        Slot slot = interpreter.slotOf(expr);
+        if (slot == null) {
+            constant(interpreter.globals);
+            constant(name);
+            runtime("getGlobal", "(OO)O");
+        } else {
+            code.aload(env);
+            code.pushInt(cw, slot.depth);
+            code.pushInt(cw, slot.index);
+            runtime("getLocal", "(OII)O");
+        }
+    }
+}
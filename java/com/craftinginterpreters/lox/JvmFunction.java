@@ -0,0 +1,41 @@
+package com.craftinginterpreters.lox;
+
+// a function whose body JvmCompiler turned into a JVM class
+class JvmFunction extends LoxFunction {
+    private final JvmCompiler.Unit body;
+
+    JvmFunction(Stmt.Function declaration, JvmCompiler.Unit body,
+                Environment closure, boolean isInitializer,
+                LoxInstance receiver) {
+        super(declaration, closure, isInitializer, receiver);
+        this.body = body;
+    }
+
+    // the body is compiled once per declaration; each time the...
+    // ... declaration runs it closes over that run's env
+    JvmFunction closeOver(Environment env) {
+        return new JvmFunction(declaration, body, env, isInitializer, receiver);
+    }
+
+    @Override
+    Object execute(Interpreter interpreter, LoxInstance receiver,
+                   Object[] frame) {
+        calls++;
+
+        int count = declaration.params.size() + (receiver != null ? 1 : 0);
+        Environment env = new Environment(closure, frame, count);
+
+        // compiled `return`s just return
+        Object result = body.code.exec(env, body.constants);
+
+        if (isInitializer)
+            return receiver;
+        return result;
+    }
+
+    @Override
+    LoxFunction bind(LoxInstance instance) {
+        return new JvmFunction(declaration, body, closure, isInitializer,
+            instance);
+    }
+}
@@ -0,0 +1,241 @@
+package com.craftinginterpreters.lox;
+
+import java.util.Arrays;
+
+// the operations code generated by JvmCompiler calls into: every...
+// ... Lox operator, variable access and call is an invokestatic...
+// ... of one of these, which HotSpot inlines into the caller
+//
+// they're public and typed as Object (the generated classes are...
+// ... in another class loader, so they can't name package-private...
+// ... types) and mirror the Interpreter's semantics and messages
+public final class JvmRuntime {
+    private JvmRuntime() {}
+
+    // environments...
+
+    public static Object scope(Object env) {
+        return new Environment((Environment)env);
+    }
+
+    public static Object getLocal(Object env, int depth, int slot) {
+        return ((Environment)env).getAt(depth, slot);
+    }
+
+    public static Object setLocal(Object env, int depth, int slot,
+                                  Object value) {
+        ((Environment)env).assignAt(depth, slot, value);
+        return value;
+    }
+
+    public static Object getGlobal(Object globals, Object name) {
+        return ((Environment)globals).get((Token)name);
+    }
+
+    public static Object setGlobal(Object globals, Object name,
+                                   Object value) {
+        ((Environment)globals).assign((Token)name, value);
+        return value;
+    }
+
+    public static void define(Object env, Object name, Object value) {
+        ((Environment)env).define(((Token)name).symbol, value);
+    }
+
+    // `template` is a JvmFunction w/ no closure yet, or the...
+    // ... declaration itself when its body couldn't be compiled
+    public static void function(Object env, Object template) {
+        Environment closure = (Environment)env;
+
+        LoxFunction function;
+        if (template instanceof JvmFunction)
+            function = ((JvmFunction)template).closeOver(closure);
+        else
+            function = new LoxFunction((Stmt.Function)template, closure, false);
+
+        closure.define(function.declaration.name.symbol, function);
+    }
+
+    // operators...
+
+    public static boolean isTruthy(Object value) {
+        return Interpreter.isTruthy(value);
+    }
+
+    public static Object not(Object value) {
+        return !Interpreter.isTruthy(value);
+    }
+
+    public static Object negate(Object value, Object operator) {
+        Interpreter.checkNumberOperand((Token)operator, value);
+        return -(double)value;
+    }
+
+    public static Object equal(Object left, Object right) {
+        return Interpreter.isEqual(left, right);
+    }
+
+    public static Object notEqual(Object left, Object right) {
+        return !Interpreter.isEqual(left, right);
+    }
+
+    public static Object greater(Object left, Object right, Object operator) {
+        Interpreter.checkNumberOperands((Token)operator, left, right);
+        return (double)left > (double)right;
+    }
+
+    public static Object greaterEqual(Object left, Object right,
+                                      Object operator) {
+        Interpreter.checkNumberOperands((Token)operator, left, right);
+        return (double)left >= (double)right;
+    }
+
+    public static Object less(Object left, Object right, Object operator) {
+        Interpreter.checkNumberOperands((Token)operator, left, right);
+        return (double)left < (double)right;
+    }
+
+    public static Object lessEqual(Object left, Object right,
+                                   Object operator) {
+        Interpreter.checkNumberOperands((Token)operator, left, right);
+        return (double)left <= (double)right;
+    }
+
+    public static Object add(Object left, Object right, Object operator) {
+        if (left instanceof Double && right instanceof Double)
+            return (double)left + (double)right;
+        if (left instanceof String && right instanceof String)
+            return (String)left + (String)right;
+        if (left instanceof String && right instanceof Double)
+            return (String)left + Interpreter.stringify(right);
+        if (left instanceof Double && right instanceof String)
+            return Interpreter.stringify(left) + (String)right;
+
+        throw new RuntimeError((Token)operator,
+            "operands must numbers or strings");
+    }
+
+    public static Object subtract(Object left, Object right, Object operator) {
+        Interpreter.checkNumberOperands((Token)operator, left, right);
+        return (double)left - (double)right;
+    }
+
+    public static Object multiply(Object left, Object right, Object operator) {
+        Interpreter.checkNumberOperands((Token)operator, left, right);
+        return (double)left * (double)right;
+    }
+
+    public static Object divide(Object left, Object right, Object operator) {
+        Interpreter.checkNumberOperands((Token)operator, left, right);
+        if ((double)right == 0)
+            throw new RuntimeError((Token)operator,
+                "divisor (right operand) must be non-zero");
+        return (double)left / (double)right;
+    }
+
+    // all three operands have already been evaluated, like the visitor
+    public static Object ternary(Object left, Object mid, Object right) {
+        return Interpreter.isTruthy(left) ? mid : right;
+    }
+
+    // calls...
+
+    public static Object call(Object callee, Object[] args,
+                              Object interpreter, Object paren) {
+        if (!(callee instanceof LoxCallable)) {
+            throw new RuntimeError((Token)paren,
+                "can only call functions and classes");
+        }
+
+        LoxCallable function = (LoxCallable)callee;
+        if (args.length != function.arity()) {
+            throw new RuntimeError((Token)paren, "expected " +
+                function.arity() + " arguments but got " + args.length);
+        }
+
+        return function.call((Interpreter)interpreter, args);
+    }
+
+    // `obj.name(args)` is invokeTarget() before the args are...
+    // ... evaluated, then invoke(), so a method is called w/out...
+    // ... being bound (see Interpreter.invoke())
+
+    // a field holding the callee, told apart from a method
+    private static final class FieldValue {
+        final Object value;
+
+        FieldValue(Object value) {
+            this.value = value;
+        }
+    }
+
+    public static Object invokeTarget(Object obj, Object name, Object cache) {
+        Token token = (Token)name;
+        if (!(obj instanceof LoxInstance))
+            throw new RuntimeError(token, "only instances have properties");
+
+        LoxInstance instance = (LoxInstance)obj;
+        PropertyCache properties = (PropertyCache)cache;
+
+        LoxFunction method = properties.method(instance, token);
+        if (method != null)
+            return method;
+        return new FieldValue(properties.get(instance, token));
+    }
+
+    public static Object invoke(Object obj, Object target, Object[] args,
+                                Object interpreter, Object paren) {
+        if (target instanceof FieldValue)
+            return call(((FieldValue)target).value, args, interpreter, paren);
+
+        LoxFunction method = (LoxFunction)target;
+        if (args.length != method.arity()) {
+            throw new RuntimeError((Token)paren, "expected " +
+                method.arity() + " arguments but got " + args.length);
+        }
+
+        return method.invoke((Interpreter)interpreter, (LoxInstance)obj,
+            args);
+    }
+
+    // properties...
+
+    public static Object get(Object obj, Object name, Object cache) {
+        if (obj instanceof LoxInstance)
+            return ((PropertyCache)cache).get((LoxInstance)obj, (Token)name);
+
+        throw new RuntimeError((Token)name, "only instances have properties");
+    }
+
+    // checked before the value of a set is evaluated
+    public static Object instance(Object obj, Object name) {
+        if (!(obj instanceof LoxInstance))
+            throw new RuntimeError((Token)name, "only instances have fields");
+        return obj;
+    }
+
+    public static Object set(Object obj, Object name, Object cache,
+                             Object value) {
+        ((PropertyCache)cache).set((LoxInstance)obj, (Token)name, value);
+        return value;
+    }
+
+    // statements...
+
+    public static void print(Object value) {
+        System.out.println(Interpreter.stringify(value));
+    }
+
+    // fallbacks for what JvmCompiler doesn't compile...
+
+    public static Object evaluate(Object interpreter, Object expr,
+                                  Object env) {
+        return ((Interpreter)interpreter).evaluate((Expr)expr,
+            (Environment)env);
+    }
+
+    public static void execute(Object interpreter, Object stmt, Object env) {
+        ((Interpreter)interpreter).executeBlock(Arrays.asList((Stmt)stmt),
+            (Environment)env);
+    }
+}
@@ -3,10 +3,15 @@ package com.craftinginterpreters.lox;
 import java.io.BufferedReader;
 import java.io.IOException;
 import java.io.InputStreamReader;
+import java.lang.management.ManagementFactory;
 import java.nio.charset.Charset;
 import java.nio.file.Files;
 import java.nio.file.Paths;
+import java.util.ArrayList;
+import java.util.Arrays;
 import java.util.List;
+import java.util.Map;
+import java.util.concurrent.ForkJoinPool;
 
 
 public class Lox {
@@ -14,23 +19,167 @@ public class Lox {
     static boolean hadError = false;
     static boolean hadRuntimeError = false;
 
+    // how a resolved program gets executed: walking the AST w/ the...
+    // ... Interpreter visitor, compiling it to ExprNode/StmtNode...
+    // ... closures first (see NodeCompiler), to JVM classes (see...
+    // ... JvmCompiler), or to StackCode run w/out Java recursion...
+    // ... (see StackMachine)
+    private enum Engine { VISITOR, CLOSURE, JVM, STACK }
+    private static Engine engine = Engine.VISITOR;
+
+    // `--alloc-stats`: report calls/s and bytes allocated per Lox...
+    // ... call on exit
+    private static boolean allocStats = false;
+
+    // `--optimize`: run the AST through the Optimizer between...
+    // ... resolving and executing it, and report how many nodes...
+    // ... that saved on exit
+    private static boolean optimize = false;
+
+    // `--threads=N`: how many files' front ends run at once when...
+    // ... there are several scripts
+    private static int threads = Runtime.getRuntime().availableProcessors();
+
     public static void main(String[] args) throws IOException {
-        if (args.length > 1) {
-            System.out.println("usage: jlox [script]");
+        // options come before the script
+        int first = 0;
+        while (first < args.length && args[first].startsWith("--")) {
+            if (!parseOption(args[first]))
+                usage();
+            first++;
+        }
 
-            // command used incorrectly (UNIX "sysexits.h" header)
-            System.exit(64);
+        if (allocStats) {
+            allocatedAtStart = allocatedBytes();
+            startedAt = System.nanoTime();
         }
-        else if (args.length == 1)
-            runFile(args[0]);
+
+        if (args.length - first > 1)
+            runFiles(Arrays.asList(args).subList(first, args.length));
+        else if (args.length - first == 1)
+            runFile(args[first]);
         else
             runPrompt();
     }
 
+    private static void usage() {
+        System.out.println(
+            "usage: jlox [--engine=visitor|closure|jvm|stack] [--alloc-stats] " +
+            "[--optimize] [--threads=N] [script ...]");
+
+        // command used incorrectly (UNIX "sysexits.h" header)
+        System.exit(64);
+    }
+
+    private static boolean parseOption(String arg) {
+        if (arg.equals("--engine=visitor"))
+            engine = Engine.VISITOR;
+        else if (arg.equals("--engine=closure"))
+            engine = Engine.CLOSURE;
+        else if (arg.equals("--engine=jvm"))
+            engine = Engine.JVM;
+        else if (arg.equals("--engine=stack"))
+            engine = Engine.STACK;
+        else if (arg.equals("--alloc-stats"))
+            allocStats = true;
+        else if (arg.equals("--optimize"))
+            optimize = true;
+        else if (arg.startsWith("--threads=")) {
+            try {
+                threads = Integer.parseInt(arg.substring("--threads=".length()));
+            } catch (NumberFormatException e) {
+                return false;
+            }
+            return threads > 0;
+        }
+        else
+            return false;
+        return true;
+    }
+
+    private static long allocatedAtStart;
+    private static long startedAt;
+
+    // uses HotSpot's per-thread allocation counter, which is...
+    // ... fine since the main thread runs everything (only looked...
+    // ... up w/ `--alloc-stats`, loading JMX slows down startup)
+    private static long allocatedBytes() {
+        com.sun.management.ThreadMXBean threads =
+            (com.sun.management.ThreadMXBean)ManagementFactory.getThreadMXBean();
+        return threads.getThreadAllocatedBytes(Thread.currentThread().getId());
+    }
+
+    private static void reportAllocations() {
+        long bytes = allocatedBytes() - allocatedAtStart;
+        long calls = LoxFunction.calls;
+
+        double seconds = (System.nanoTime() - startedAt) / 1e9;
+
+        System.err.printf("allocated %d bytes over %d calls", bytes, calls);
+        if (calls > 0)
+            System.err.printf(" (%.1f bytes/call)", (double)bytes / calls);
+        System.err.printf(" in %.3fs (%.0f calls/s)%n", seconds, calls / seconds);
+    }
+
+    private static String read(String path) throws IOException {
+        byte[] bytes = Files.readAllBytes(Paths.get(path));
+        return new String(bytes, Charset.defaultCharset());
+    }
+
     // reads file and executes
     private static void runFile(String path) throws IOException {
-        byte[] bytes = Files.readAllBytes(Paths.get(path));
-        run(new String(bytes, Charset.defaultCharset()));
+        run(read(path));
+        exit();
+    }
+
+    // several scripts: their front ends run in parallel (see...
+    // ... FrontEnd), then they execute one after another, in...
+    // ... argument order, in the same interpreter like one program
+    private static void runFiles(List<String> paths) throws IOException {
+        List<String> sources = new ArrayList<>();
+        for (String path : paths)
+            sources.add(read(path));
+
+        ForkJoinPool pool = new ForkJoinPool(threads);
+        List<FrontEnd.Result> files;
+        try {
+            files = FrontEnd.process(paths, sources, pool);
+        } finally {
+            pool.shutdown();
+        }
+
+        // every file's errors, in argument order; if any file has...
+        // ... one, none of them run
+        for (FrontEnd.Result file : files) {
+            for (String error : file.errors)
+                System.err.println(file.name + ": " + error);
+            if (!file.errors.isEmpty())
+                hadError = true;
+        }
+
+        if (!hadError) {
+            for (FrontEnd.Result file : files) {
+                runningFile = file.name;
+                List<Stmt> stmts = file.stmts;
+                if (optimize)
+                    stmts = optimize(stmts, file.locals);
+
+                interpreter.resolve(file.locals);
+                execute(stmts);
+
+                if (hadRuntimeError)
+                    break;
+            }
+        }
+
+        exit();
+    }
+
+    private static void exit() {
+        if (allocStats)
+            reportAllocations();
+        if (optimize)
+            Optimizer.report();
 
         // input data is incorrect (UNIX "sysexits.h" header)
         if (hadError)
@@ -63,12 +212,17 @@ public class Lox {
             // just report the error, don't stop REPL
             hadError = false;
         }
+
+        if (allocStats)
+            reportAllocations();
+        if (optimize)
+            Optimizer.report();
     }
 
     private static void run(String src) {
         // (1) scanning
         Scanner scanner = new Scanner(src);
-        List<Token> tokens = scanner.scanTokens();
+        TokenStream tokens = scanner.scanTokens();
 
         // (2) parsing
         Parser parser = new Parser(tokens);
@@ -85,19 +239,63 @@ public class Lox {
         // stop if there was a resolution error
         if (hadError)
             return;
+
+        // (4) optimizing, if asked to
+        if (optimize)
+            stmts = optimize(stmts, interpreter.locals);
         
-        // (4) lastly, but not the least of all...
+        // (5) lastly, but not the least of all...
         // ... interpreting
-        interpreter.interpret(stmts);
+        execute(stmts);
+    }
+
+    // the optimized program is resolved again into the same table:...
+    // ... the nodes it kept get their slots overwritten (hoisting...
+    // ... adds scopes, so they can move), and the new ones get theirs
+    private static List<Stmt> optimize(List<Stmt> stmts,
+                                       Map<Expr, Slot> locals) {
+        List<Stmt> optimized = new Optimizer().optimize(stmts);
+        new Resolver(locals).resolve(optimized);
+        return optimized;
+    }
+
+    private static void execute(List<Stmt> stmts) {
+        if (engine == Engine.CLOSURE)
+            interpreter.interpret(new NodeCompiler(interpreter).compile(stmts));
+        else if (engine == Engine.JVM)
+            JvmCompiler.interpret(interpreter, stmts);
+        else if (engine == Engine.STACK)
+            StackMachine.interpret(interpreter, stmts);
+        else
+            interpreter.interpret(stmts);
     }
 
     static void error(int line, String msg) {
         report(line, "", msg);
     }
 
+    // while FrontEnd works on a file, that file's errors are added...
+    // ... to its own list (one per pool thread) instead of printed
+    private static final ThreadLocal<List<String>> collected =
+        new ThreadLocal<>();
+
+    static void collectErrors(List<String> errors) {
+        if (errors == null)
+            collected.remove();
+        else
+            collected.set(errors);
+    }
+
     private static void report(int line, String where, String msg) {
-        System.err.println("[line " + line + "] error" +
-            where + ": " + msg);
+        String error = "[line " + line + "] error" + where + ": " + msg;
+
+        List<String> errors = collected.get();
+        if (errors != null) {
+            errors.add(error);
+            return;
+        }
+
+        System.err.println(error);
         hadError = true;
     }
 
@@ -109,12 +307,16 @@ public class Lox {
             report(token.line, " at '" + token.lexeme + "'", msg);
     }
 
+    // which of several scripts is executing, for runtime errors
+    private static String runningFile = null;
+
     static void runtimeError(RuntimeError error) {
         // token associated w/ error tells user...
         // ... the line of code executing when...
         // ... the error occurred
+        String where = runningFile == null ? "" : runningFile + ": ";
         System.err.println(error.getMessage() +
-            "\n[line " + error.token.line + "]");
+            "\n" + where + "[line " + error.token.line + "]");
         
         hadRuntimeError = true;
     }
@@ -1,8 +1,9 @@
 package com.craftinginterpreters.lox;
 
-import java.util.List;
-
 interface LoxCallable {
     int arity();
-    Object call(Interpreter interpreter, List<Object> args);
+
+    // `args` is the callee's to keep: a function may adopt it...
+    // ... as its frame instead of copying it
+    Object call(Interpreter interpreter, Object[] args);
 }
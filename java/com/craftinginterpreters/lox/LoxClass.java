@@ -1,52 +1,63 @@
 package com.craftinginterpreters.lox;
 
-import java.util.List;
-import java.util.Map;
-
 class LoxClass implements LoxCallable{
     final String name;
     final LoxClass superclass;
-    private final Map<String, LoxFunction> methods;
+    private final SymbolMap<LoxFunction> methods;
+
+    // `methods` merged w/ every superclass's, built on first...
+    // ... lookup; classes never change once declared, so...
+    // ... finding an inherited method is a single hash lookup
+    private SymbolMap<LoxFunction> methodTable = null;
+
+    // every instance starts out w/ this shape, so shapes...
+    // ... (and the caches keyed on them) are never shared by classes
+    final Shape rootShape = new Shape();
 
-    LoxClass(String name, LoxClass superclass, Map<String, LoxFunction> methods) {
+    LoxClass(String name, LoxClass superclass, SymbolMap<LoxFunction> methods) {
         this.name = name;
         this.superclass = superclass;
         this.methods = methods;
     }
 
-    LoxFunction findMethod(String name) {
-        if (methods.containsKey(name))
-            return methods.get(name);
+    // `symbol` is the method name's ID in Symbols
+    LoxFunction findMethod(int symbol) {
+        return methodTable().get(symbol);
+    }
 
-        // recurse up the superclass chain...
-        // ... to loop for the method def
-        if (superclass != null)
-            return superclass.findMethod(name);
-        
-        return null;
+    private SymbolMap<LoxFunction> methodTable() {
+        if (methodTable == null) {
+            methodTable = new SymbolMap<>();
+
+            // inherited methods first so overrides replace them
+            if (superclass != null)
+                methodTable.putAll(superclass.methodTable());
+            methodTable.putAll(methods);
+        }
+        return methodTable;
     }
 
     // calling a class instantiates a new LoxInstance...
     // ...for the called class and returns it
     @Override
-    public Object call(Interpreter interpreter, List<Object> args) {
+    public Object call(Interpreter interpreter, Object[] args) {
         LoxInstance instance = new LoxInstance(this);
 
         // calling a class (after creating the LoxInstance)...
         // ... we look for an "init" method
-        LoxFunction initializer = findMethod("init");
+        LoxFunction initializer = findMethod(Symbols.INIT);
 
         // if we find an "init" method, we immediately...
-        // ... bind and invoke it just like a method call
+        // ... invoke it just like a method call
         if (initializer != null)
-            initializer.bind(instance).call(interpreter, args);
+            initializer.invoke(interpreter, instance, args);
         
         return instance;
     }
 
     @Override
     public int arity() {
-        LoxFunction initializer = findMethod("init");
+        LoxFunction initializer = findMethod(Symbols.INIT);
         
         if (initializer == null)
             return 0;
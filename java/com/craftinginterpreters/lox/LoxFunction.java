@@ -1,17 +1,27 @@
 package com.craftinginterpreters.lox;
 
-import java.util.List;
-
 class LoxFunction implements LoxCallable {
-    private final Stmt.Function declaration;
-    private final Environment closure;
-    private final boolean isInitializer;
+    final Stmt.Function declaration;
+    final Environment closure;
+    final boolean isInitializer;
+
+    // the instance a method was bound to (null for plain functions)
+    final LoxInstance receiver;
+
+    // Lox function calls made so far, for `--alloc-stats`
+    static long calls = 0;
     
     LoxFunction(Stmt.Function declaration, Environment closure,
                 boolean isInitializer) {
+        this(declaration, closure, isInitializer, null);
+    }
+
+    LoxFunction(Stmt.Function declaration, Environment closure,
+                boolean isInitializer, LoxInstance receiver) {
         this.isInitializer = isInitializer;
         this.declaration = declaration;
         this.closure = closure;
+        this.receiver = receiver;
     }
 
     @Override
@@ -20,32 +30,56 @@ class LoxFunction implements LoxCallable {
     }
 
     @Override
-    public Object call(Interpreter interpreter,
-                       List<Object> arguments) {
+    public Object call(Interpreter interpreter, Object[] arguments) {
+        return invoke(interpreter, receiver, arguments);
+    }
 
-        // each function call gets its own environment
-        Environment env = new Environment(closure);
+    // calls the function w/ `receiver` as "this"...
+    // ... which is how a method gets called w/out binding it first
+    Object invoke(Interpreter interpreter, LoxInstance receiver,
+                  Object[] arguments) {
+        // a plain function whose body declares no locals can run...
+        // ... in the args array itself
+        Object[] frame = arguments;
+        if (receiver != null || arguments.length != declaration.frame.size) {
+            frame = newFrame(receiver);
+            System.arraycopy(arguments, 0, frame, receiver != null ? 1 : 0,
+                arguments.length);
+        }
+
+        return execute(interpreter, receiver, frame);
+    }
+
+    // an array for a call's env w/ the receiver (if any) in slot 0...
+    // ... and room for the args after it and the body's locals
+    Object[] newFrame(LoxInstance receiver) {
+        Object[] frame = new Object[declaration.frame.size];
+        if (receiver != null)
+            frame[0] = receiver;
+        return frame;
+    }
+
+    // runs the body over a frame that already holds the receiver...
+    // ... and args, see newFrame()
+    Object execute(Interpreter interpreter, LoxInstance receiver,
+                   Object[] frame) {
+        calls++;
+
+        // each call gets its own env, over the frame
+        int count = declaration.params.size() + (receiver != null ? 1 : 0);
+        Environment env = new Environment(closure, frame, count);
 
-        // define each param and bind arg value to it
-        for(int i = 0; i < declaration.params.size(); i++)
-            env.define(declaration.params.get(i).lexeme, arguments.get(i));
-        
         // discards function-local env and restores the...
         // ... previous one that was active back at the callsite
-        try {
-            interpreter.executeBlock(declaration.body, env);
-        } catch (Return returnValue) {
-            if (isInitializer)
-                return closure.getAt(0, "this");
-            return returnValue.value;
-        }
+        interpreter.executeBlock(declaration.body, env);
+        Object result = interpreter.takeReturnValue();
 
         // if the function is an initializer...
         // ... we override the actual return value and forcibly return "this"
         if (isInitializer)
-            return closure.getAt(0, "this");
+            return receiver;
 
-        return null;
+        return result;
     }
 
     @Override
@@ -53,14 +87,9 @@ class LoxFunction implements LoxCallable {
         return "<fn " + declaration.name.lexeme + ">";
     }
 
+    // only needed when a method is used as a value, e.g....
+    // ... `var f = obj.method;`, calls go straight to invoke()
     LoxFunction bind(LoxInstance instance) {
-        // new env nested inside the method's original closure...
-        // ...sort of a closure w/in a closure
-        Environment env = new Environment(closure);
-
-        // declare "this" as a var in that env and bind it to...
-        // ...given instance
-        env.define("this", instance);
-        return new LoxFunction(declaration, env, isInitializer);
+        return new LoxFunction(declaration, closure, isInitializer, instance);
     }
 }
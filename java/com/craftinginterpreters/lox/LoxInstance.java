@@ -2,25 +2,28 @@
 
 package com.craftinginterpreters.lox;
 
-import java.util.HashMap;
-import java.util.Map;
+import java.util.Arrays;
 
 class LoxInstance {
-    private LoxClass klass;
+    final LoxClass klass;
 
-    // each key in the map is a property name and the...
-    // ...corresponding value is the property's value
-    private final Map<String, Object> fields = new HashMap<>();
+    // the shape maps each property name's symbol to its index...
+    // ... in `fields`, which holds the property values
+    Shape shape;
+    Object[] fields;
 
     LoxInstance(LoxClass klass) {
         this.klass = klass;
+        this.shape = klass.rootShape;
+        this.fields = new Object[4];
     }
 
     Object get(Token name) {
-        if (fields.containsKey(name.lexeme))
-            return fields.get(name.lexeme);
+        int index = shape.indexOf(name.symbol);
+        if (index >= 0)
+            return fields[index];
         
-        LoxFunction method = klass.findMethod(name.lexeme);
+        LoxFunction method = klass.findMethod(name.symbol);
         if (method != null)
             return method.bind(this);
 
@@ -29,7 +32,19 @@ class LoxInstance {
     }
 
     void set(Token name, Object value) {
-        fields.put(name.lexeme, value);
+        int index = shape.indexOf(name.symbol);
+        if (index < 0) {
+            index = shape.size;
+            transition(shape.with(name.symbol));
+        }
+        fields[index] = value;
+    }
+
+    // moves to a shape w/ one more field, making room for it
+    void transition(Shape next) {
+        if (next.size > fields.length)
+            fields = Arrays.copyOf(fields, fields.length * 2);
+        shape = next;
     }
 
     @Override
@@ -0,0 +1,228 @@
+package com.craftinginterpreters.lox;
+
+import java.util.List;
+
+// walks the resolved AST once and turns it into ExprNode/StmtNode...
+// ... trees; every decision the visitor makes on each evaluation...
+// ... (operator type, local vs global, depth and slot) is made here
+class NodeCompiler implements Expr.Visitor<ExprNode>,
+                              Stmt.Visitor<StmtNode> {
+    private final Interpreter interpreter;
+
+    NodeCompiler(Interpreter interpreter) {
+        this.interpreter = interpreter;
+    }
+
+    StmtNode[] compile(List<Stmt> stmts) {
+        StmtNode[] nodes = new StmtNode[stmts.size()];
+        for (int i = 0; i < nodes.length; i++)
+            nodes[i] = compile(stmts.get(i));
+        return nodes;
+    }
+
+    private StmtNode compile(Stmt stmt) {
+        return stmt.accept(this);
+    }
+
+    private ExprNode compile(Expr expr) {
+        return expr.accept(this);
+    }
+
+    @Override
+    public StmtNode visitBlockStmt(Stmt.Block stmt) {
+        return new StmtNode.Block(compile(stmt.statements));
+    }
+
+    @Override
+    public StmtNode visitClassStmt(Stmt.Class stmt) {
+        ExprNode superclass = null;
+        Token superclassName = null;
+        if (stmt.superclass != null) {
+            superclass = compile(stmt.superclass);
+            superclassName = stmt.superclass.name;
+        }
+
+        StmtNode.Function[] methods = new StmtNode.Function[stmt.methods.size()];
+        for (int i = 0; i < methods.length; i++)
+            methods[i] = function(stmt.methods.get(i));
+
+        return new StmtNode.Class(stmt.name, superclass, superclassName, methods);
+    }
+
+    @Override
+    public StmtNode visitExpressionStmt(Stmt.Expression stmt) {
+        return new StmtNode.Expression(compile(stmt.expression));
+    }
+
+    @Override
+    public StmtNode visitFunctionStmt(Stmt.Function stmt) {
+        return function(stmt);
+    }
+
+    @Override
+    public StmtNode visitIfStmt(Stmt.If stmt) {
+        StmtNode elseBranch = null;
+        if (stmt.elseBranch != null)
+            elseBranch = compile(stmt.elseBranch);
+
+        return new StmtNode.If(compile(stmt.condition),
+            compile(stmt.thenBranch), elseBranch);
+    }
+
+    @Override
+    public StmtNode visitPrintStmt(Stmt.Print stmt) {
+        return new StmtNode.Print(compile(stmt.expression));
+    }
+
+    @Override
+    public StmtNode visitReturnStmt(Stmt.Return stmt) {
+        ExprNode value = null;
+        if (stmt.value != null)
+            value = compile(stmt.value);
+
+        return new StmtNode.Return(value);
+    }
+
+    @Override
+    public StmtNode visitVarStmt(Stmt.Var stmt) {
+        ExprNode initializer = null;
+        if (stmt.initializer != null)
+            initializer = compile(stmt.initializer);
+
+        return new StmtNode.Var(stmt.name.symbol, initializer);
+    }
+
+    @Override
+    public StmtNode visitWhileStmt(Stmt.While stmt) {
+        return new StmtNode.While(compile(stmt.condition), compile(stmt.body));
+    }
+
+    @Override
+    public ExprNode visitAssignExpr(Expr.Assign expr) {
+        ExprNode value = compile(expr.value);
+
+        Slot slot = interpreter.slotOf(expr);
+        if (slot == null)
+            return new ExprNode.SetGlobal(interpreter.globals, expr.name, value);
+        return new ExprNode.SetLocal(slot.depth, slot.index, value);
+    }
+
+    @Override
+    public ExprNode visitBinaryExpr(Expr.Binary expr) {
+        ExprNode left = compile(expr.left);
+        ExprNode right = compile(expr.right);
+        Token op = expr.operator;
+
+        switch (op.type) {
+            case COMMA:         return new ExprNode.Comma(left, op, right);
+            case BANG_EQUAL:    return new ExprNode.NotEqual(left, op, right);
+            case EQUAL_EQUAL:   return new ExprNode.Equal(left, op, right);
+            case GREATER:       return new ExprNode.Greater(left, op, right);
+            case GREATER_EQUAL: return new ExprNode.GreaterEqual(left, op, right);
+            case LESS:          return new ExprNode.Less(left, op, right);
+            case LESS_EQUAL:    return new ExprNode.LessEqual(left, op, right);
+            case MINUS:         return new ExprNode.Subtract(left, op, right);
+            case PLUS:          return new ExprNode.Add(left, op, right);
+            case SLASH:         return new ExprNode.Divide(left, op, right);
+            case STAR:          return new ExprNode.Multiply(left, op, right);
+        }
+
+        // unreachable
+        return new ExprNode.Constant(null);
+    }
+
+    @Override
+    public ExprNode visitCallExpr(Expr.Call expr) {
+        ExprNode[] args = new ExprNode[expr.args.size()];
+        for (int i = 0; i < args.length; i++)
+            args[i] = compile(expr.args.get(i));
+
+        if (expr.callee instanceof Expr.Get) {
+            Expr.Get get = (Expr.Get)expr.callee;
+            return new ExprNode.Invoke(interpreter, compile(get.object),
+                get.name, expr.paren, args);
+        }
+
+        return new ExprNode.Call(interpreter, compile(expr.callee),
+            expr.paren, args);
+    }
+
+    @Override
+    public ExprNode visitGetExpr(Expr.Get expr) {
+        return new ExprNode.GetProperty(compile(expr.object), expr.name);
+    }
+
+    // groupings only exist for the parser's sake
+    @Override
+    public ExprNode visitGroupingExpr(Expr.Grouping expr) {
+        return compile(expr.expression);
+    }
+
+    @Override
+    public ExprNode visitLiteralExpr(Expr.Literal expr) {
+        return new ExprNode.Constant(expr.value);
+    }
+
+    @Override
+    public ExprNode visitLogicalExpr(Expr.Logical expr) {
+        ExprNode left = compile(expr.left);
+        ExprNode right = compile(expr.right);
+
+        if (expr.operator.type == TokenType.OR)
+            return new ExprNode.Or(left, right);
+        return new ExprNode.And(left, right);
+    }
+
+    @Override
+    public ExprNode visitSetExpr(Expr.Set expr) {
+        return new ExprNode.SetProperty(compile(expr.object), expr.name,
+            compile(expr.value));
+    }
+
+    @Override
+    public ExprNode visitSuperExpr(Expr.Super expr) {
+        return new ExprNode.Super(interpreter.slotOf(expr).depth, expr.method);
+    }
+
+    @Override
+    public ExprNode visitTernaryExpr(Expr.Ternary expr) {
+        return new ExprNode.Ternary(compile(expr.left), compile(expr.mid),
+            compile(expr.right));
+    }
+
+    @Override
+    public ExprNode visitThisExpr(Expr.This expr) {
+        return variable(expr.keyword, expr);
+    }
+
+    @Override
+    public ExprNode visitUnaryExpr(Expr.Unary expr) {
+        ExprNode right = compile(expr.right);
+
+        if (expr.operator.type == TokenType.BANG)
+            return new ExprNode.Not(right);
+        return new ExprNode.Negate(expr.operator, right);
+    }
+
+    @Override
+    public ExprNode visitVariableExpr(Expr.Variable expr) {
+        return variable(expr.name, expr);
+    }
+
+    private StmtNode.Function function(Stmt.Function stmt) {
+        return new StmtNode.Function(stmt, compile(stmt.body));
+    }
+
+    // picks the cheapest node that can reach the variable
+    private ExprNode variable(Token name, Expr expr) {
+        Slot slot = interpreter.slotOf(expr);
+        if (slot == null)
+            return new ExprNode.GetGlobal(interpreter.globals, name);
+
+        switch (slot.depth) {
+            case 0:  return new ExprNode.GetLocal0(slot.index);
+            case 1:  return new ExprNode.GetLocal1(slot.index);
+            default: return new ExprNode.GetLocal(slot.depth, slot.index);
+        }
+    }
+}
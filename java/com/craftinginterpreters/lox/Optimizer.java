@@ -0,0 +1,900 @@
+package com.craftinginterpreters.lox;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.IdentityHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+import java.util.Stack;
+
+// rewrites a resolved program before it runs (`--optimize`): folds...
+// ... operators on literals, prunes branches whose condition folded...
+// ... to a literal, drops the left operand of a comma when it can't...
+// ... do anything, and hoists loop-invariant expressions out of...
+// ... while loops into locals computed once
+//
+// nothing moves or goes away unless evaluating it can neither have...
+// ... a side effect nor fail, so output and runtime errors are...
+// ... unchanged; whatever would fail is left in place to fail at...
+// ... runtime like before
+//
+// the result has new nodes, and hoisting adds scopes, so it has to...
+// ... be resolved again before it runs (see Lox.optimize())
+class Optimizer {
+    // totals over every program optimized, for the report on exit
+    static int nodesBefore = 0;
+    static int nodesAfter = 0;
+    static int hoisted = 0;
+
+    // a local variable (or parameter, or "this"), the same object for...
+    // ... its declaration and every use of it
+    private static class Binding {
+        // how many functions deep it's declared
+        final int function;
+
+        // only ever holds a number: it's initialized to one and every...
+        // ... value assigned to it is one (see inferNumbers())
+        boolean number = false;
+        final List<Expr> values = new ArrayList<>();
+
+        // assigned from inside a function nested in its own, so any...
+        // ... call might change it
+        boolean closureAssigned = false;
+
+        // one of ours, holding a hoisted expression
+        boolean temp = false;
+
+        Binding(int function) {
+            this.function = function;
+        }
+    }
+
+    // what a while loop does to the variables outside it, over its...
+    // ... condition and body, functions declared in it included
+    private static class Loop {
+        final Set<Binding> assigned =
+            Collections.newSetFromMap(new IdentityHashMap<>());
+        final Set<Binding> declared =
+            Collections.newSetFromMap(new IdentityHashMap<>());
+        boolean calls = false;
+    }
+
+    // keyed on the name token of a declaration, an assignment or a...
+    // ... variable (and on "this"), since tokens are never rebuilt;...
+    // ... globals aren't in it
+    private final Map<Token, Binding> bindings = new IdentityHashMap<>();
+    private final Map<Stmt.While, Loop> loops = new IdentityHashMap<>();
+
+    private int temps = 0;
+
+    List<Stmt> optimize(List<Stmt> stmts) {
+        Analysis analysis = new Analysis();
+        analysis.count(stmts);
+        inferNumbers();
+
+        List<Stmt> optimized = new Folder().rewrite(stmts);
+
+        // counted w/ a fresh Analysis, whose bindings go unused
+        nodesBefore += analysis.nodes;
+        nodesAfter += new Analysis().count(optimized);
+        return optimized;
+    }
+
+    static void report() {
+        System.err.printf("optimized %d nodes to %d", nodesBefore, nodesAfter);
+        if (nodesBefore > 0)
+            System.err.printf(" (%.1f%% fewer)",
+                100.0 * (nodesBefore - nodesAfter) / nodesBefore);
+        System.err.printf(", %d expression(s) hoisted out of loops%n", hoisted);
+    }
+
+    // every variable starts out a number if its initializer is one,...
+    // ... until one of its values turns out not to be
+    private void inferNumbers() {
+        boolean changed = true;
+        while (changed) {
+            changed = false;
+            for (Binding binding : bindings.values()) {
+                if (!binding.number)
+                    continue;
+
+                for (Expr value : binding.values) {
+                    if (!isNumber(value)) {
+                        binding.number = false;
+                        changed = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // whether `expr` gives a number whenever it doesn't fail
+    private boolean isNumber(Expr expr) {
+        if (expr instanceof Expr.Literal)
+            return ((Expr.Literal)expr).value instanceof Double;
+
+        if (expr instanceof Expr.Variable) {
+            Binding binding = bindings.get(((Expr.Variable)expr).name);
+            return binding != null && binding.number;
+        }
+
+        if (expr instanceof Expr.Grouping)
+            return isNumber(((Expr.Grouping)expr).expression);
+
+        if (expr instanceof Expr.Assign)
+            return isNumber(((Expr.Assign)expr).value);
+
+        if (expr instanceof Expr.Unary)
+            return ((Expr.Unary)expr).operator.type == TokenType.MINUS;
+
+        if (expr instanceof Expr.Binary) {
+            Expr.Binary binary = (Expr.Binary)expr;
+            switch (binary.operator.type) {
+                case MINUS:
+                case SLASH:
+                case STAR:
+                    return true;
+                case PLUS:
+                    return isNumber(binary.left) && isNumber(binary.right);
+                case COMMA:
+                    return isNumber(binary.right);
+                default:
+                    return false;
+            }
+        }
+
+        // either operand is the result
+        if (expr instanceof Expr.Logical) {
+            Expr.Logical logical = (Expr.Logical)expr;
+            return isNumber(logical.left) && isNumber(logical.right);
+        }
+
+        if (expr instanceof Expr.Ternary) {
+            Expr.Ternary ternary = (Expr.Ternary)expr;
+            return isNumber(ternary.mid) && isNumber(ternary.right);
+        }
+
+        return false;
+    }
+
+    // evaluating `expr` can't do anything but give a value: no...
+    // ... assignment or call, no global (it might not be defined)...
+    // ... and no operator that might get the wrong types
+    private boolean isSafe(Expr expr) {
+        if (expr instanceof Expr.Literal || expr instanceof Expr.This)
+            return true;
+
+        if (expr instanceof Expr.Variable)
+            return bindings.containsKey(((Expr.Variable)expr).name);
+
+        if (expr instanceof Expr.Grouping)
+            return isSafe(((Expr.Grouping)expr).expression);
+
+        if (expr instanceof Expr.Unary) {
+            Expr.Unary unary = (Expr.Unary)expr;
+            if (!isSafe(unary.right))
+                return false;
+            return unary.operator.type == TokenType.BANG ||
+                isNumber(unary.right);
+        }
+
+        if (expr instanceof Expr.Binary) {
+            Expr.Binary binary = (Expr.Binary)expr;
+            if (!isSafe(binary.left) || !isSafe(binary.right))
+                return false;
+
+            switch (binary.operator.type) {
+                case BANG_EQUAL:
+                case COMMA:
+                case EQUAL_EQUAL:
+                    return true;
+
+                // dividing by zero is an error too
+                case SLASH:
+                    if (!(binary.right instanceof Expr.Literal) ||
+                            !isNumber(binary.right) ||
+                            (double)((Expr.Literal)binary.right).value == 0)
+                        return false;
+                    return isNumber(binary.left);
+
+                default:
+                    return isNumber(binary.left) && isNumber(binary.right);
+            }
+        }
+
+        if (expr instanceof Expr.Logical) {
+            Expr.Logical logical = (Expr.Logical)expr;
+            return isSafe(logical.left) && isSafe(logical.right);
+        }
+
+        if (expr instanceof Expr.Ternary) {
+            Expr.Ternary ternary = (Expr.Ternary)expr;
+            return isSafe(ternary.left) && isSafe(ternary.mid) &&
+                isSafe(ternary.right);
+        }
+
+        return false;
+    }
+
+    // for a safe expression: every variable in it has the same value...
+    // ... on every iteration of `loop`, and means the same variable...
+    // ... just outside of it
+    private boolean isInvariant(Expr expr, Loop loop) {
+        if (expr instanceof Expr.Variable) {
+            Binding binding = bindings.get(((Expr.Variable)expr).name);
+            return !binding.temp && !loop.assigned.contains(binding) &&
+                !loop.declared.contains(binding) &&
+                !(loop.calls && binding.closureAssigned);
+        }
+
+        if (expr instanceof Expr.Grouping)
+            return isInvariant(((Expr.Grouping)expr).expression, loop);
+
+        if (expr instanceof Expr.Unary)
+            return isInvariant(((Expr.Unary)expr).right, loop);
+
+        if (expr instanceof Expr.Binary) {
+            Expr.Binary binary = (Expr.Binary)expr;
+            return isInvariant(binary.left, loop) &&
+                isInvariant(binary.right, loop);
+        }
+
+        if (expr instanceof Expr.Logical) {
+            Expr.Logical logical = (Expr.Logical)expr;
+            return isInvariant(logical.left, loop) &&
+                isInvariant(logical.right, loop);
+        }
+
+        if (expr instanceof Expr.Ternary) {
+            Expr.Ternary ternary = (Expr.Ternary)expr;
+            return isInvariant(ternary.left, loop) &&
+                isInvariant(ternary.mid, loop) &&
+                isInvariant(ternary.right, loop);
+        }
+
+        // literals and "this"
+        return true;
+    }
+
+    private static boolean isConstant(Expr expr) {
+        return expr instanceof Expr.Literal;
+    }
+
+    private static Object valueOf(Expr expr) {
+        return ((Expr.Literal)expr).value;
+    }
+
+    // copies a tree, rebuilding only the nodes whose children changed,...
+    // ... so unchanged subtrees come back as the very same objects;...
+    // ... a statement rewritten to null is gone
+    private abstract static class Rewriter
+            implements Expr.Visitor<Expr>, Stmt.Visitor<Stmt> {
+        Expr rewrite(Expr expr) {
+            return expr.accept(this);
+        }
+
+        Stmt rewrite(Stmt stmt) {
+            return stmt.accept(this);
+        }
+
+        List<Stmt> rewrite(List<Stmt> stmts) {
+            List<Stmt> rewritten = new ArrayList<>();
+            boolean changed = false;
+            for (Stmt stmt : stmts) {
+                Stmt result = rewrite(stmt);
+                if (result != null)
+                    rewritten.add(result);
+                changed |= result != stmt;
+            }
+            return changed ? rewritten : stmts;
+        }
+
+        // where a statement has to stay a statement
+        Stmt branch(Stmt stmt) {
+            Stmt result = rewrite(stmt);
+            return result != null ? result : new Stmt.Block(new ArrayList<>());
+        }
+
+        private List<Expr> rewriteAll(List<Expr> exprs) {
+            List<Expr> rewritten = new ArrayList<>();
+            boolean changed = false;
+            for (Expr expr : exprs) {
+                Expr result = rewrite(expr);
+                rewritten.add(result);
+                changed |= result != expr;
+            }
+            return changed ? rewritten : exprs;
+        }
+
+        @Override
+        public Stmt visitBlockStmt(Stmt.Block stmt) {
+            List<Stmt> statements = rewrite(stmt.statements);
+            return statements == stmt.statements ? stmt :
+                new Stmt.Block(statements);
+        }
+
+        @Override
+        public Stmt visitClassStmt(Stmt.Class stmt) {
+            List<Stmt.Function> methods = new ArrayList<>();
+            boolean changed = false;
+            for (Stmt.Function method : stmt.methods) {
+                Stmt.Function result = (Stmt.Function)rewrite(method);
+                methods.add(result);
+                changed |= result != method;
+            }
+            return !changed ? stmt :
+                new Stmt.Class(stmt.name, stmt.superclass, methods);
+        }
+
+        @Override
+        public Stmt visitExpressionStmt(Stmt.Expression stmt) {
+            Expr expression = rewrite(stmt.expression);
+            return expression == stmt.expression ? stmt :
+                new Stmt.Expression(expression);
+        }
+
+        @Override
+        public Stmt visitFunctionStmt(Stmt.Function stmt) {
+            List<Stmt> body = rewrite(stmt.body);
+            return body == stmt.body ? stmt :
+                new Stmt.Function(stmt.name, stmt.params, body);
+        }
+
+        @Override
+        public Stmt visitIfStmt(Stmt.If stmt) {
+            Expr condition = rewrite(stmt.condition);
+            Stmt thenBranch = branch(stmt.thenBranch);
+            Stmt elseBranch = stmt.elseBranch == null ? null :
+                branch(stmt.elseBranch);
+
+            if (condition == stmt.condition &&
+                    thenBranch == stmt.thenBranch &&
+                    elseBranch == stmt.elseBranch)
+                return stmt;
+            return new Stmt.If(condition, thenBranch, elseBranch);
+        }
+
+        @Override
+        public Stmt visitPrintStmt(Stmt.Print stmt) {
+            Expr expression = rewrite(stmt.expression);
+            return expression == stmt.expression ? stmt :
+                new Stmt.Print(expression);
+        }
+
+        @Override
+        public Stmt visitReturnStmt(Stmt.Return stmt) {
+            if (stmt.value == null)
+                return stmt;
+
+            Expr value = rewrite(stmt.value);
+            return value == stmt.value ? stmt :
+                new Stmt.Return(stmt.keyword, value);
+        }
+
+        @Override
+        public Stmt visitVarStmt(Stmt.Var stmt) {
+            if (stmt.initializer == null)
+                return stmt;
+
+            Expr initializer = rewrite(stmt.initializer);
+            return initializer == stmt.initializer ? stmt :
+                new Stmt.Var(stmt.name, initializer);
+        }
+
+        @Override
+        public Stmt visitWhileStmt(Stmt.While stmt) {
+            Expr condition = rewrite(stmt.condition);
+            Stmt body = branch(stmt.body);
+
+            if (condition == stmt.condition && body == stmt.body)
+                return stmt;
+            return new Stmt.While(condition, body);
+        }
+
+        @Override
+        public Expr visitAssignExpr(Expr.Assign expr) {
+            Expr value = rewrite(expr.value);
+            return value == expr.value ? expr :
+                new Expr.Assign(expr.name, value);
+        }
+
+        @Override
+        public Expr visitBinaryExpr(Expr.Binary expr) {
+            Expr left = rewrite(expr.left);
+            Expr right = rewrite(expr.right);
+
+            if (left == expr.left && right == expr.right)
+                return expr;
+            return new Expr.Binary(left, expr.operator, right);
+        }
+
+        @Override
+        public Expr visitCallExpr(Expr.Call expr) {
+            Expr callee = rewrite(expr.callee);
+            List<Expr> args = rewriteAll(expr.args);
+
+            if (callee == expr.callee && args == expr.args)
+                return expr;
+            return new Expr.Call(callee, expr.paren, args);
+        }
+
+        @Override
+        public Expr visitGetExpr(Expr.Get expr) {
+            Expr object = rewrite(expr.object);
+            return object == expr.object ? expr :
+                new Expr.Get(object, expr.name);
+        }
+
+        @Override
+        public Expr visitGroupingExpr(Expr.Grouping expr) {
+            Expr expression = rewrite(expr.expression);
+            return expression == expr.expression ? expr :
+                new Expr.Grouping(expression);
+        }
+
+        @Override
+        public Expr visitLiteralExpr(Expr.Literal expr) {
+            return expr;
+        }
+
+        @Override
+        public Expr visitLogicalExpr(Expr.Logical expr) {
+            Expr left = rewrite(expr.left);
+            Expr right = rewrite(expr.right);
+
+            if (left == expr.left && right == expr.right)
+                return expr;
+            return new Expr.Logical(left, expr.operator, right);
+        }
+
+        @Override
+        public Expr visitSetExpr(Expr.Set expr) {
+            Expr object = rewrite(expr.object);
+            Expr value = rewrite(expr.value);
+
+            if (object == expr.object && value == expr.value)
+                return expr;
+            return new Expr.Set(object, expr.name, value);
+        }
+
+        @Override
+        public Expr visitSuperExpr(Expr.Super expr) {
+            return expr;
+        }
+
+        @Override
+        public Expr visitTernaryExpr(Expr.Ternary expr) {
+            Expr left = rewrite(expr.left);
+            Expr mid = rewrite(expr.mid);
+            Expr right = rewrite(expr.right);
+
+            if (left == expr.left && mid == expr.mid && right == expr.right)
+                return expr;
+            return new Expr.Ternary(left, expr.op1, mid, expr.op2, right);
+        }
+
+        @Override
+        public Expr visitThisExpr(Expr.This expr) {
+            return expr;
+        }
+
+        @Override
+        public Expr visitUnaryExpr(Expr.Unary expr) {
+            Expr right = rewrite(expr.right);
+            return right == expr.right ? expr :
+                new Expr.Unary(expr.operator, right);
+        }
+
+        @Override
+        public Expr visitVariableExpr(Expr.Variable expr) {
+            return expr;
+        }
+    }
+
+    // the pass itself, bottom up, so by the time a loop is looked at...
+    // ... everything in it is folded and its inner loops are done
+    private class Folder extends Rewriter {
+        // a grouping only matters to the parser
+        @Override
+        public Expr visitGroupingExpr(Expr.Grouping expr) {
+            return rewrite(expr.expression);
+        }
+
+        @Override
+        public Expr visitBinaryExpr(Expr.Binary expr) {
+            Expr.Binary binary = (Expr.Binary)super.visitBinaryExpr(expr);
+
+            if (binary.operator.type == TokenType.COMMA && isSafe(binary.left))
+                return binary.right;
+
+            if (!isConstant(binary.left) || !isConstant(binary.right))
+                return binary;
+
+            // same operators as at runtime, which leaves what fails...
+            // ... to fail there
+            try {
+                return new Expr.Literal(Interpreter.binary(binary.operator,
+                    valueOf(binary.left), valueOf(binary.right)));
+            } catch (RuntimeError error) {
+                return binary;
+            }
+        }
+
+        @Override
+        public Expr visitUnaryExpr(Expr.Unary expr) {
+            Expr.Unary unary = (Expr.Unary)super.visitUnaryExpr(expr);
+            if (!isConstant(unary.right))
+                return unary;
+
+            Object right = valueOf(unary.right);
+            if (unary.operator.type == TokenType.BANG)
+                return new Expr.Literal(!Interpreter.isTruthy(right));
+            if (right instanceof Double)
+                return new Expr.Literal(-(double)right);
+            return unary;
+        }
+
+        // "or" gives its left operand if that's truthy, "and" if...
+        // ... it's falsey, and the right one otherwise
+        @Override
+        public Expr visitLogicalExpr(Expr.Logical expr) {
+            Expr.Logical logical = (Expr.Logical)super.visitLogicalExpr(expr);
+            if (!isConstant(logical.left))
+                return logical;
+
+            boolean truthy = Interpreter.isTruthy(valueOf(logical.left));
+            boolean isOr = logical.operator.type == TokenType.OR;
+            return truthy == isOr ? logical.left : logical.right;
+        }
+
+        // all three operands are evaluated, so the one not taken can...
+        // ... only go if it's safe
+        @Override
+        public Expr visitTernaryExpr(Expr.Ternary expr) {
+            Expr.Ternary ternary = (Expr.Ternary)super.visitTernaryExpr(expr);
+            if (!isConstant(ternary.left))
+                return ternary;
+
+            if (Interpreter.isTruthy(valueOf(ternary.left)))
+                return isSafe(ternary.right) ? ternary.mid : ternary;
+            return isSafe(ternary.mid) ? ternary.right : ternary;
+        }
+
+        @Override
+        public Stmt visitIfStmt(Stmt.If stmt) {
+            Expr condition = rewrite(stmt.condition);
+            if (isConstant(condition)) {
+                if (Interpreter.isTruthy(valueOf(condition)))
+                    return rewrite(stmt.thenBranch);
+                return stmt.elseBranch == null ? null :
+                    rewrite(stmt.elseBranch);
+            }
+
+            Stmt thenBranch = branch(stmt.thenBranch);
+            Stmt elseBranch = stmt.elseBranch == null ? null :
+                branch(stmt.elseBranch);
+
+            if (condition == stmt.condition &&
+                    thenBranch == stmt.thenBranch &&
+                    elseBranch == stmt.elseBranch)
+                return stmt;
+            return new Stmt.If(condition, thenBranch, elseBranch);
+        }
+
+        @Override
+        public Stmt visitWhileStmt(Stmt.While stmt) {
+            Loop loop = loops.get(stmt);
+            Stmt.While folded = (Stmt.While)super.visitWhileStmt(stmt);
+
+            if (isConstant(folded.condition) &&
+                    !Interpreter.isTruthy(valueOf(folded.condition)))
+                return null;
+
+            // the hoisted expressions go in locals in a block of their...
+            // ... own around the loop
+            Hoister hoister = new Hoister(loop);
+            Expr condition = hoister.rewrite(folded.condition);
+            Stmt body = hoister.branch(folded.body);
+            if (hoister.vars.isEmpty())
+                return folded;
+
+            List<Stmt> block = new ArrayList<>(hoister.vars);
+            block.add(new Stmt.While(condition, body));
+            return new Stmt.Block(block);
+        }
+    }
+
+    // replaces each largest invariant expression in one loop w/ a...
+    // ... local declared ahead of it; functions declared in the loop...
+    // ... are left alone, they run in a scope of their own
+    private class Hoister extends Rewriter {
+        private final Loop loop;
+        final List<Stmt> vars = new ArrayList<>();
+
+        Hoister(Loop loop) {
+            this.loop = loop;
+        }
+
+        @Override
+        Expr rewrite(Expr expr) {
+            if (!isHoistable(expr))
+                return super.rewrite(expr);
+
+            String name = "(hoisted " + temps++ + ")";
+            Token token = new Token(TokenType.IDENTIFIER, name, null, 0,
+                Symbols.intern(name));
+
+            Binding binding = new Binding(-1);
+            binding.temp = true;
+            binding.number = isNumber(expr);
+            bindings.put(token, binding);
+
+            vars.add(new Stmt.Var(token, expr));
+            hoisted++;
+            return new Expr.Variable(token);
+        }
+
+        // anything bigger than reading one variable
+        private boolean isHoistable(Expr expr) {
+            if (expr instanceof Expr.Literal || expr instanceof Expr.Variable ||
+                    expr instanceof Expr.This)
+                return false;
+            return isSafe(expr) && isInvariant(expr, loop);
+        }
+
+        @Override
+        public Stmt visitClassStmt(Stmt.Class stmt) {
+            return stmt;
+        }
+
+        @Override
+        public Stmt visitFunctionStmt(Stmt.Function stmt) {
+            return stmt;
+        }
+    }
+
+    // walks the program the way the Resolver does, to find the...
+    // ... binding behind every name and what each loop does, and...
+    // ... counts the nodes on the way
+    private class Analysis implements Expr.Visitor<Void>, Stmt.Visitor<Void> {
+        private final Stack<SymbolMap<Binding>> scopes = new Stack<>();
+        private final List<Loop> enclosing = new ArrayList<>();
+        private int function = 0;
+        int nodes = 0;
+
+        int count(List<Stmt> stmts) {
+            for (Stmt stmt : stmts)
+                visit(stmt);
+            return nodes;
+        }
+
+        private void visit(Stmt stmt) {
+            nodes++;
+            stmt.accept(this);
+        }
+
+        private void visit(Expr expr) {
+            nodes++;
+            expr.accept(this);
+        }
+
+        // globals get no binding
+        private Binding declare(Token name) {
+            if (scopes.isEmpty())
+                return null;
+
+            Binding binding = new Binding(function);
+            scopes.peek().put(name.symbol, binding);
+            bindings.put(name, binding);
+            for (Loop loop : enclosing)
+                loop.declared.add(binding);
+
+            return binding;
+        }
+
+        private Binding lookUp(Token name) {
+            for (int i = scopes.size() - 1; i >= 0; i--) {
+                Binding binding = scopes.get(i).get(name.symbol);
+                if (binding != null) {
+                    bindings.put(name, binding);
+                    return binding;
+                }
+            }
+            return null;
+        }
+
+        private void function(Stmt.Function stmt, boolean method) {
+            function++;
+            scopes.push(new SymbolMap<>());
+
+            if (method)
+                scopes.peek().put(Symbols.THIS, new Binding(function));
+            for (Token param : stmt.params)
+                declare(param);
+            count(stmt.body);
+
+            scopes.pop();
+            function--;
+        }
+
+        @Override
+        public Void visitBlockStmt(Stmt.Block stmt) {
+            scopes.push(new SymbolMap<>());
+            count(stmt.statements);
+            scopes.pop();
+            return null;
+        }
+
+        @Override
+        public Void visitClassStmt(Stmt.Class stmt) {
+            declare(stmt.name);
+            if (stmt.superclass != null)
+                visit(stmt.superclass);
+
+            for (Stmt.Function method : stmt.methods) {
+                nodes++;
+                function(method, true);
+            }
+            return null;
+        }
+
+        @Override
+        public Void visitExpressionStmt(Stmt.Expression stmt) {
+            visit(stmt.expression);
+            return null;
+        }
+
+        @Override
+        public Void visitFunctionStmt(Stmt.Function stmt) {
+            declare(stmt.name);
+            function(stmt, false);
+            return null;
+        }
+
+        @Override
+        public Void visitIfStmt(Stmt.If stmt) {
+            visit(stmt.condition);
+            visit(stmt.thenBranch);
+            if (stmt.elseBranch != null)
+                visit(stmt.elseBranch);
+            return null;
+        }
+
+        @Override
+        public Void visitPrintStmt(Stmt.Print stmt) {
+            visit(stmt.expression);
+            return null;
+        }
+
+        @Override
+        public Void visitReturnStmt(Stmt.Return stmt) {
+            if (stmt.value != null)
+                visit(stmt.value);
+            return null;
+        }
+
+        // declared first, like the Resolver does
+        @Override
+        public Void visitVarStmt(Stmt.Var stmt) {
+            Binding binding = declare(stmt.name);
+            if (stmt.initializer != null)
+                visit(stmt.initializer);
+
+            if (binding != null && stmt.initializer != null) {
+                binding.number = true;
+                binding.values.add(stmt.initializer);
+            }
+            return null;
+        }
+
+        @Override
+        public Void visitWhileStmt(Stmt.While stmt) {
+            Loop loop = new Loop();
+            loops.put(stmt, loop);
+
+            enclosing.add(loop);
+            visit(stmt.condition);
+            visit(stmt.body);
+            enclosing.remove(enclosing.size() - 1);
+            return null;
+        }
+
+        @Override
+        public Void visitAssignExpr(Expr.Assign expr) {
+            visit(expr.value);
+
+            Binding binding = lookUp(expr.name);
+            if (binding == null)
+                return null;
+
+            binding.values.add(expr.value);
+            if (function > binding.function)
+                binding.closureAssigned = true;
+            for (Loop loop : enclosing)
+                loop.assigned.add(binding);
+            return null;
+        }
+
+        @Override
+        public Void visitBinaryExpr(Expr.Binary expr) {
+            visit(expr.left);
+            visit(expr.right);
+            return null;
+        }
+
+        @Override
+        public Void visitCallExpr(Expr.Call expr) {
+            visit(expr.callee);
+            for (Expr arg : expr.args)
+                visit(arg);
+
+            for (Loop loop : enclosing)
+                loop.calls = true;
+            return null;
+        }
+
+        @Override
+        public Void visitGetExpr(Expr.Get expr) {
+            visit(expr.object);
+            return null;
+        }
+
+        @Override
+        public Void visitGroupingExpr(Expr.Grouping expr) {
+            visit(expr.expression);
+            return null;
+        }
+
+        @Override
+        public Void visitLiteralExpr(Expr.Literal expr) {
+            return null;
+        }
+
+        @Override
+        public Void visitLogicalExpr(Expr.Logical expr) {
+            visit(expr.left);
+            visit(expr.right);
+            return null;
+        }
+
+        @Override
+        public Void visitSetExpr(Expr.Set expr) {
+            visit(expr.value);
+            visit(expr.object);
+            return null;
+        }
+
+        @Override
+        public Void visitSuperExpr(Expr.Super expr) {
+            return null;
+        }
+
+        @Override
+        public Void visitTernaryExpr(Expr.Ternary expr) {
+            visit(expr.left);
+            visit(expr.mid);
+            visit(expr.right);
+            return null;
+        }
+
+        @Override
+        public Void visitThisExpr(Expr.This expr) {
+            lookUp(expr.keyword);
+            return null;
+        }
+
+        @Override
+        public Void visitUnaryExpr(Expr.Unary expr) {
+            visit(expr.right);
+            return null;
+        }
+
+        @Override
+        public Void visitVariableExpr(Expr.Variable expr) {
+            lookUp(expr.name);
+            return null;
+        }
+    }
+}
@@ -8,10 +8,12 @@ class Parser {
     // simple sentinel class used to unwind the parser
     private static class ParseError extends RuntimeException {}
 
-    private final List<Token> tokens;
+    // a cursor into the packed tokens: Token objects are only...
+    // ... materialized for the ones the AST (or an error) keeps
+    private final TokenStream tokens;
     private int current = 0;
 
-    Parser(List<Token> tokens) {
+    Parser(TokenStream tokens) {
         this.tokens = tokens;
     }
     
@@ -511,7 +513,7 @@ class Parser {
             return new Expr.Literal(null);
 
         if (match(TokenType.NUMBER, TokenType.STRING))
-            return new Expr.Literal(previous().literal);
+            return new Expr.Literal(tokens.literal(current - 1));
         
         if (match(TokenType.SUPER)) {
             Token keyword = previous();
@@ -557,36 +559,37 @@ class Parser {
     private boolean check(TokenType type) {
         if (isAtEnd())
             return false;
-        return peek().type == type;
+        return tokens.type(current) == type;
     }
 
-    private Token advance() {
+    private void advance() {
         if (!isAtEnd())
             current++;
-        return previous();
     }
 
     // returns the most recently consumed token
     private Token previous() {
-        return tokens.get(current - 1);
+        return tokens.token(current - 1);
     }
 
     // check if we've run out of tokens to parse
     private boolean isAtEnd() {
-        return peek().type == TokenType.EOF;
+        return tokens.type(current) == TokenType.EOF;
     }
 
     // returns current token we have YET to consume
     private Token peek() {
-        return tokens.get(current);
+        return tokens.token(current);
     }
 
     // checks if next token is of the expected type
     private Token consume(TokenType type, String msg) {
 
         // next token is expected so token is consumed and everything is "groovy"
-        if (check(type))
-            return advance();
+        if (check(type)) {
+            advance();
+            return previous();
+        }
         
         throw error(peek(), msg);
     }
@@ -604,11 +607,11 @@ class Parser {
         while(!isAtEnd()) {
 
             // discard tokens...
-            if (previous().type == TokenType.SEMICOLON)
+            if (tokens.type(current - 1) == TokenType.SEMICOLON)
                 return;
             
             // ... until we've reached a statement boundary
-            switch (peek().type) {
+            switch (tokens.type(current)) {
                 case CLASS:
                 case FUN:
                 case VAR:
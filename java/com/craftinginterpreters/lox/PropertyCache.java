@@ -0,0 +1,98 @@
+package com.craftinginterpreters.lox;
+
+// an inline cache for one property access site (an Expr.Get or...
+// ... Expr.Set, or the closure engine's node for one): remembers...
+// ... the shapes seen there and where the field lives in each...
+// ... so repeat accesses are an identity compare + array index
+//
+// invoke sites (a call whose callee is a Get) also cache the...
+// ... method a shape resolves to; that's safe since a class's...
+// ... methods never change and every class has its own shapes
+//
+// entry 0 is the monomorphic case; up to MAX_ENTRIES shapes are...
+// ... kept after that, and a site seeing more goes megamorphic...
+// ... and just takes the slow path from then on
+class PropertyCache {
+    static final int MAX_ENTRIES = 4;
+
+    private final Shape[] shapes = new Shape[MAX_ENTRIES];
+    private final int[] indexes = new int[MAX_ENTRIES];
+
+    // for sets that add a field: the shape to move the instance to
+    private final Shape[] transitions = new Shape[MAX_ENTRIES];
+
+    // for invokes: the method, or null if it's a field (index >= 0)
+    private final LoxFunction[] methods = new LoxFunction[MAX_ENTRIES];
+    private int count = 0;
+
+    Object get(LoxInstance instance, Token name) {
+        Shape shape = instance.shape;
+        for (int i = 0; i < count; i++) {
+            if (shapes[i] == shape && indexes[i] >= 0)
+                return instance.fields[indexes[i]];
+        }
+
+        // bound methods and missing properties aren't cached
+        int index = shape.indexOf(name.symbol);
+        if (index < 0)
+            return instance.get(name);
+
+        remember(shape, index, null, null);
+        return instance.fields[index];
+    }
+
+    // the method an invoke site calls on `instance`, or null if...
+    // ... `name` is a field (fields shadow methods) or missing
+    LoxFunction method(LoxInstance instance, Token name) {
+        Shape shape = instance.shape;
+        for (int i = 0; i < count; i++) {
+            if (shapes[i] == shape)
+                return methods[i];
+        }
+
+        int index = shape.indexOf(name.symbol);
+        LoxFunction method = null;
+        if (index < 0)
+            method = instance.klass.findMethod(name.symbol);
+
+        remember(shape, index, null, method);
+        return method;
+    }
+
+    void set(LoxInstance instance, Token name, Object value) {
+        Shape shape = instance.shape;
+        for (int i = 0; i < count; i++) {
+            if (shapes[i] == shape) {
+                if (transitions[i] != null)
+                    instance.transition(transitions[i]);
+                instance.fields[indexes[i]] = value;
+                return;
+            }
+        }
+
+        Shape next = null;
+        int index = shape.indexOf(name.symbol);
+        if (index < 0) {
+            next = shape.with(name.symbol);
+            index = shape.size;
+        }
+
+        remember(shape, index, next, null);
+        if (next != null)
+            instance.transition(next);
+        instance.fields[index] = value;
+    }
+
+    private void remember(Shape shape, int index, Shape next,
+                          LoxFunction method) {
+        // megamorphic
+        if (count == MAX_ENTRIES)
+            return;
+
+        shapes[count] = shape;
+        indexes[count] = index;
+        transitions[count] = next;
+        methods[count] = method;
+        count++;
+    }
+}
@@ -1,17 +1,30 @@
 package com.craftinginterpreters.lox;
 
-import java.util.HashMap;
 import java.util.List;
 import java.util.Map;
 import java.util.Stack;
 
 class Resolver implements Expr.Visitor<Void>, Stmt.Visitor<Void> {
-    private final Interpreter interpreter;
+    // where each resolved local's slot is recorded: the interpreter's...
+    // ... own table, or a file's table when FrontEnd resolves several...
+    // ... files at once and hands them to the interpreter afterwards
+    private final Map<Expr, Slot> locals;
+
+    // a local variable: whether its initializer is done yet...
+    // ... and the slot it gets in its scope's environment
+    private static class Local {
+        boolean defined = false;
+        final int slot;
+
+        Local(int slot) {
+            this.slot = slot;
+        }
+    }
 
     // keeps track of scopes currently "in scope"
-    // each element in the stack is a Map representing...
-    // ...a single block scope
-    private final Stack<Map<String, Boolean>> scopes = new Stack<>();
+    // each element in the stack is a map (keyed by symbol ID)...
+    // ... representing a single block scope
+    private final Stack<SymbolMap<Local>> scopes = new Stack<>();
 
     private enum ClassType {
         NONE,
@@ -32,13 +45,27 @@ class Resolver implements Expr.Visitor<Void>, Stmt.Visitor<Void> {
     private FunctionType currentFunction = FunctionType.NONE;
 
     Resolver(Interpreter interpreter) {
-        this.interpreter = interpreter;
+        this(interpreter.locals);
+    }
+
+    Resolver(Map<Expr, Slot> locals) {
+        this.locals = locals;
     }
 
     // lexical scopes nest in both the interpreter and resolver...
     // ... behaving like a stack
     private void beginScope() {
-        scopes.push(new HashMap<String, Boolean>());
+        scopes.push(new SymbolMap<Local>());
+    }
+
+    // slots are handed out in declaration order, which is the...
+    // ... order the interpreter defines them in at runtime
+    private Local addLocal(int symbol) {
+        SymbolMap<Local> scope = scopes.peek();
+        Local local = new Local(scope.size());
+        scope.put(symbol, local);
+
+        return local;
     }
 
     private void endScope() {
@@ -64,7 +91,7 @@ class Resolver implements Expr.Visitor<Void>, Stmt.Visitor<Void> {
         define(stmt.name);
 
         if (stmt.superclass != null &&
-                stmt.name.lexeme.equals(stmt.superclass.name))
+                stmt.name.symbol == stmt.superclass.name.symbol)
             Lox.error(stmt.superclass.name, "a class can't inherit from itself");
 
         if (stmt.superclass != null) {
@@ -80,26 +107,23 @@ class Resolver implements Expr.Visitor<Void>, Stmt.Visitor<Void> {
         // ... all of its methods
         if (stmt.superclass != null) {
             beginScope();
-            scopes.peek().put("super", true);
+            addLocal(Symbols.SUPER).defined = true;
         }
 
-        beginScope();
-        scopes.peek().put("this", true);
-
+        // "super" gets slot 0 of its own scope, "this" is...
+        // ... slot 0 of each method's own scope (resolveFunction())
         // iterate thru methods in class body
         for (Stmt.Function method : stmt.methods) {
             FunctionType declaration = FunctionType.METHOD;
 
             // use visited method to determine if...
             // ... we're resolving an initializer or not
-            if (method.name.lexeme.equals("init"))
+            if (method.name.symbol == Symbols.INIT)
                 declaration = FunctionType.INITIALIZER;
             
             resolveFunction(method, declaration);
         }
 
-        endScope();
-
         // once done w/ resolving class's methods...
         // ...the scope is discarded
         if (stmt.superclass != null)
@@ -296,9 +320,10 @@ class Resolver implements Expr.Visitor<Void>, Stmt.Visitor<Void> {
     @Override
     public Void visitVariableExpr(Expr.Variable expr) {
         // variable exists in the current scope...
-        // ... but value is false (declared and not defined)
-        boolean not_defined = !scopes.isEmpty() &&
-                            scopes.peek().get(expr.name.lexeme) == Boolean.FALSE;
+        // ... but is declared and not defined
+        Local local = scopes.isEmpty() ? null :
+                            scopes.peek().get(expr.name.symbol);
+        boolean not_defined = local != null && !local.defined;
         
         if (not_defined)
             Lox.error(expr.name, "can't read local variable in its own initializer");
@@ -316,13 +341,12 @@ class Resolver implements Expr.Visitor<Void>, Stmt.Visitor<Void> {
         if (scopes.isEmpty())
             return;
         
-        Map<String, Boolean> scope = scopes.peek();
-        if (scope.containsKey(name.lexeme))
+        SymbolMap<Local> scope = scopes.peek();
+        if (scope.containsKey(name.symbol))
             Lox.error(name, "a variable with this name already exists in this scope");
 
-        // marking variable as not ready yet by...
-        // ...binding its name to false in the scope map
-        scope.put(name.lexeme, false);
+        // marking variable as not ready yet (`defined` starts false)
+        addLocal(name.symbol);
     }
 
     private void define(Token name) {
@@ -330,7 +354,7 @@ class Resolver implements Expr.Visitor<Void>, Stmt.Visitor<Void> {
             return;
         
         // marked as fully initialized and avail for use
-        scopes.peek().put(name.lexeme, true);
+        scopes.peek().get(name.symbol).defined = true;
     }
     
     void resolve(List<Stmt> stmts) {
@@ -352,6 +376,11 @@ class Resolver implements Expr.Visitor<Void>, Stmt.Visitor<Void> {
 
         // creates a new scope for the body
         beginScope();
+
+        // methods get their receiver ahead of the params, so...
+        // ... calling one needs no env of its own just for "this"
+        if (type == FunctionType.METHOD || type == FunctionType.INITIALIZER)
+            addLocal(Symbols.THIS).defined = true;
         
         // binds vars for each of the function's params
         for (Token param : function.params) {
@@ -362,6 +391,10 @@ class Resolver implements Expr.Visitor<Void>, Stmt.Visitor<Void> {
         // resolve function body in that scope
         resolve(function.body);
 
+        // every slot the call's env will ever fill, so a call can...
+        // ... allocate its frame once at the right size
+        function.frame.size = scopes.peek().size();
+
         endScope();
         currentFunction = enclosingFunction;
     }
@@ -370,8 +403,10 @@ class Resolver implements Expr.Visitor<Void>, Stmt.Visitor<Void> {
         // start at the innermost scope and work outwards
         for (int i = scopes.size() - 1; i >= 0; i--) {
             // look in each map for a matching name
-            if (scopes.get(i).containsKey(name.lexeme)) {
-                interpreter.resolve(expr, scopes.size() - 1 - i);
+            Local local = scopes.get(i).get(name.symbol);
+            if (local != null) {
+                locals.put(expr, new Slot(scopes.size() - 1 - i,
+                    local.slot));
                 return;
             }
         }
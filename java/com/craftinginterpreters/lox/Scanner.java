@@ -1,47 +1,28 @@
 package com.craftinginterpreters.lox;
 
-import java.util.ArrayList;
-import java.util.HashMap;
-import java.util.List;
-import java.util.Map;
-
 class Scanner {
     private final String src;
-    private final List<Token> tokens = new ArrayList<>();
-
-    // reserved keywords
-    private static final Map<String, TokenType> keywords;
-    static {
-        keywords = new HashMap<>();
-        keywords.put("and",         TokenType.AND);
-        keywords.put("class",       TokenType.CLASS);
-        keywords.put("else",        TokenType.ELSE);
-        keywords.put("false",       TokenType.FALSE);
-        keywords.put("for",         TokenType.FOR);
-        keywords.put("fun",         TokenType.FUN);
-        keywords.put("if",          TokenType.IF);
-        keywords.put("nil",         TokenType.NIL);
-        keywords.put("or",          TokenType.OR);
-        keywords.put("print",       TokenType.PRINT);
-        keywords.put("return",      TokenType.RETURN);
-        keywords.put("super",       TokenType.SUPER);
-        keywords.put("this",        TokenType.THIS);
-        keywords.put("true",        TokenType.TRUE);
-        keywords.put("var",         TokenType.VAR);
-        keywords.put("while",       TokenType.WHILE);
-    }
+    private final TokenStream tokens;
     
     private int start = 0;
     private int current = 0;
     private int line = 1;
 
+    // identifiers this scanner has interned already, by their...
+    // ... chars' hash: a repeat costs neither a substring nor a...
+    // ... trip to the shared table in Symbols
+    private String[] seenNames = new String[64];
+    private int[] seenSymbols = new int[64];
+    private int seenCount = 0;
+
     // store the raw src code as a simple string
     Scanner(String src) {
         this.src = src;
+        this.tokens = new TokenStream(src);
     }
 
     // takes raw src code
-    List<Token> scanTokens() {
+    TokenStream scanTokens() {
         // scan a single token
         while (!isAtEnd()) {
             // we're at the beginning of the next lexeme
@@ -49,7 +30,7 @@ class Scanner {
             scanToken();
         }
 
-        tokens.add(new Token(TokenType.EOF, "", null, line));
+        tokens.add(TokenType.EOF, current, 0, line, -1);
         return tokens;
     }
 
@@ -185,9 +166,8 @@ class Scanner {
         // the closing '"'
         advance();
 
-        // trim the surrouding quotes
-        String value = src.substring(start + 1, current - 1);
-        addToken(TokenType.STRING, value);
+        // the value (w/out the quotes) is cut out later, if needed
+        addToken(TokenType.STRING);
     }
 
     // number() -> (0..9)* ('.'(0..9)*)?
@@ -205,21 +185,121 @@ class Scanner {
                 advance();
         }
 
-        addToken(TokenType.NUMBER,
-            Double.parseDouble(src.substring(start, current)));
+        // parsed into a Double later, if needed
+        addToken(TokenType.NUMBER);
     }
 
     private void identifier() {
         while(isAlphaNumeric(peek()))
             advance();
-        
-        String txt = src.substring(start, current);
-        
-        // check for a match in hashmap
-        TokenType type = keywords.get(txt);
-        if (type == null)
-            type = TokenType.IDENTIFIER;
-        addToken(type);
+
+        TokenType type = identifierType();
+        int symbol = -1;
+        if (type == TokenType.IDENTIFIER)
+            symbol = symbol();
+        else if (type == TokenType.THIS)
+            symbol = Symbols.THIS;
+        else if (type == TokenType.SUPER)
+            symbol = Symbols.SUPER;
+
+        tokens.add(type, start, current - start, line, symbol);
+    }
+
+    // the current lexeme's ID in Symbols
+    private int symbol() {
+        int length = current - start;
+
+        // the same hash String.hashCode() gives, w/out the String
+        int hash = 0;
+        for (int i = start; i < current; i++)
+            hash = 31 * hash + src.charAt(i);
+
+        int mask = seenNames.length - 1;
+        int index = (hash ^ (hash >>> 16)) & mask;
+        while (seenNames[index] != null) {
+            String name = seenNames[index];
+            if (name.length() == length &&
+                    src.regionMatches(start, name, 0, length))
+                return seenSymbols[index];
+            index = (index + 1) & mask;
+        }
+
+        String name = src.substring(start, current);
+        int symbol = Symbols.intern(name);
+
+        seenNames[index] = name;
+        seenSymbols[index] = symbol;
+        if (++seenCount * 2 > seenNames.length)
+            growSeen();
+
+        return symbol;
+    }
+
+    private void growSeen() {
+        String[] oldNames = seenNames;
+        int[] oldSymbols = seenSymbols;
+
+        seenNames = new String[oldNames.length * 2];
+        seenSymbols = new int[oldNames.length * 2];
+
+        int mask = seenNames.length - 1;
+        for (int i = 0; i < oldNames.length; i++) {
+            if (oldNames[i] == null)
+                continue;
+
+            int hash = oldNames[i].hashCode();
+            int index = (hash ^ (hash >>> 16)) & mask;
+            while (seenNames[index] != null)
+                index = (index + 1) & mask;
+
+            seenNames[index] = oldNames[i];
+            seenSymbols[index] = oldSymbols[i];
+        }
+    }
+
+    // recognizes reserved keywords in place by switching on their...
+    // ... first letters (as clox does), w/out a substring per identifier
+    private TokenType identifierType() {
+        switch (src.charAt(start)) {
+            case 'a': return checkKeyword(1, "nd", TokenType.AND);
+            case 'c': return checkKeyword(1, "lass", TokenType.CLASS);
+            case 'e': return checkKeyword(1, "lse", TokenType.ELSE);
+            case 'f':
+                if (current - start > 1) {
+                    switch (src.charAt(start + 1)) {
+                        case 'a': return checkKeyword(2, "lse", TokenType.FALSE);
+                        case 'o': return checkKeyword(2, "r", TokenType.FOR);
+                        case 'u': return checkKeyword(2, "n", TokenType.FUN);
+                    }
+                }
+                break;
+            case 'i': return checkKeyword(1, "f", TokenType.IF);
+            case 'n': return checkKeyword(1, "il", TokenType.NIL);
+            case 'o': return checkKeyword(1, "r", TokenType.OR);
+            case 'p': return checkKeyword(1, "rint", TokenType.PRINT);
+            case 'r': return checkKeyword(1, "eturn", TokenType.RETURN);
+            case 's': return checkKeyword(1, "uper", TokenType.SUPER);
+            case 't':
+                if (current - start > 1) {
+                    switch (src.charAt(start + 1)) {
+                        case 'h': return checkKeyword(2, "is", TokenType.THIS);
+                        case 'r': return checkKeyword(2, "ue", TokenType.TRUE);
+                    }
+                }
+                break;
+            case 'v': return checkKeyword(1, "ar", TokenType.VAR);
+            case 'w': return checkKeyword(1, "hile", TokenType.WHILE);
+        }
+
+        return TokenType.IDENTIFIER;
+    }
+
+    private TokenType checkKeyword(int offset, String rest, TokenType type) {
+        if (current - start == offset + rest.length() &&
+                src.regionMatches(start + offset, rest, 0, rest.length()))
+            return type;
+
+        return TokenType.IDENTIFIER;
     }
 
     private boolean isAtEnd() {
@@ -231,14 +311,9 @@ class Scanner {
         return src.charAt(current++);
     }
 
+    // records where the current lexeme is, w/out copying it
     private void addToken(TokenType type) {
-        addToken(type, null);
-    }
-
-    // grabs txt of current lexeme and creates a new "Token" for it
-    private void addToken(TokenType type, Object literal) {
-        String txt = src.substring(start, current);
-        tokens.add(new Token(type, txt, literal, line));
+        tokens.add(type, start, current - start, line, -1);
     }
 
     // "conditional advance" - only consume char if it is "expected"
@@ -0,0 +1,46 @@
+package com.craftinginterpreters.lox;
+
+// a hidden class: maps property names (their symbol IDs) to indexes in...
+// ... LoxInstance.fields and is shared by every instance that...
+// ... got its fields added in the same order
+//
+// adding a field moves an instance along a transition to the...
+// ... next shape, which is created once and then reused, so...
+// ... PropertyCache can compare shapes by identity
+class Shape {
+    private final SymbolMap<Integer> indexes;
+    private final SymbolMap<Shape> transitions = new SymbolMap<>();
+
+    // number of fields an instance of this shape has
+    final int size;
+
+    // the empty shape each class starts its instances with
+    Shape() {
+        this.indexes = new SymbolMap<>();
+        this.size = 0;
+    }
+
+    private Shape(Shape parent, int symbol) {
+        this.indexes = new SymbolMap<>(parent.indexes);
+        this.indexes.put(symbol, parent.size);
+        this.size = parent.size + 1;
+    }
+
+    // -1 when there's no such field
+    int indexOf(int symbol) {
+        Integer index = indexes.get(symbol);
+        if (index == null)
+            return -1;
+        return index;
+    }
+
+    // the shape after adding field `symbol`, which lands at index `size`
+    Shape with(int symbol) {
+        Shape next = transitions.get(symbol);
+        if (next == null) {
+            next = new Shape(this, symbol);
+            transitions.put(symbol, next);
+        }
+        return next;
+    }
+}
@@ -0,0 +1,14 @@
+package com.craftinginterpreters.lox;
+
+// where the resolver found a local variable: how many...
+// ... environments out from the current one, and which...
+// ... slot of that environment it lives in
+class Slot {
+    final int depth;
+    final int index;
+
+    Slot(int depth, int index) {
+        this.depth = depth;
+        this.index = index;
+    }
+}
@@ -0,0 +1,92 @@
+package com.craftinginterpreters.lox;
+
+// a body StackCompiler flattened into instructions for StackMachine:...
+// ... an opcode followed by its operands, all ints, w/ anything...
+// ... that isn't an int (values, tokens, AST nodes) in `constants`
+class StackCode {
+    // operands: constant
+    static final int CONSTANT = 0;
+    static final int POP = 1;
+
+    // operands: depth, slot
+    static final int GET_LOCAL = 2;
+    static final int SET_LOCAL = 3;
+
+    // operands: the variable's name token
+    static final int GET_GLOBAL = 4;
+    static final int SET_GLOBAL = 5;
+
+    // operands: name; defines the popped value in the current env
+    static final int DEFINE = 6;
+
+    // operands: operator token; pops both operands
+    static final int BINARY = 7;
+    static final int NOT = 8;
+
+    // operands: operator token
+    static final int NEGATE = 9;
+
+    // pops all three operands, like the visitor evaluates them
+    static final int TERNARY = 10;
+
+    // operands: absolute target
+    static final int JUMP = 11;
+    static final int JUMP_IF_FALSE = 12;
+
+    // short-circuits w/ the left operand on the stack, pops it otherwise
+    static final int AND = 13;
+    static final int OR = 14;
+
+    // operands: arg count, paren token; the callee is below the args
+    static final int CALL = 15;
+
+    // `return f(...)`: like CALL, but a Lox function replaces the...
+    // ... caller's frame instead of going on top of it
+    static final int TAIL_CALL = 16;
+
+    // operands: the Expr.Get, which holds the name and the cache
+    static final int GET = 17;
+
+    // operands: name token; checked before a set's value is evaluated
+    static final int CHECK_INSTANCE = 18;
+
+    // operands: the Expr.Set
+    static final int SET = 19;
+
+    // operands: depth of "super", method name token
+    static final int SUPER = 20;
+
+    static final int PRINT = 21;
+    static final int RETURN = 22;
+
+    // a block's own env
+    static final int SCOPE = 23;
+    static final int END_SCOPE = 24;
+
+    // operands: a StackFunction w/ no closure yet
+    static final int FUNCTION = 25;
+
+    // operands: a Class; pops the superclass (nil when there's none)
+    static final int CLASS = 26;
+
+    // what a class declaration needs at runtime, compiled once
+    static class Class {
+        final Token name;
+        final Token superclass;
+        final StackFunction[] methods;
+
+        Class(Token name, Token superclass, StackFunction[] methods) {
+            this.name = name;
+            this.superclass = superclass;
+            this.methods = methods;
+        }
+    }
+
+    final int[] code;
+    final Object[] constants;
+
+    StackCode(int[] code, Object[] constants) {
+        this.code = code;
+        this.constants = constants;
+    }
+}
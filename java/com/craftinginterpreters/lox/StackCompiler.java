@@ -0,0 +1,315 @@
+package com.craftinginterpreters.lox;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+
+import static com.craftinginterpreters.lox.StackCode.*;
+
+// flattens a resolved body into StackCode, so StackMachine can run...
+// ... it w/ its own stacks instead of Java recursion; every decision...
+// ... the visitor makes per evaluation (local vs global, depth and...
+// ... slot, which operator) is made here, once
+//
+// each function body gets its own StackCode, compiled when the...
+// ... enclosing body is
+class StackCompiler implements Expr.Visitor<Void>, Stmt.Visitor<Void> {
+    private final Interpreter interpreter;
+
+    // `return f(...)` is a tail call anywhere but an initializer...
+    // ... (whose frame has to stay to return "this") and the top level
+    private final boolean tailCalls;
+
+    private int[] code = new int[64];
+    private int length = 0;
+    private final List<Object> constants = new ArrayList<>();
+
+    private StackCompiler(Interpreter interpreter, boolean tailCalls) {
+        this.interpreter = interpreter;
+        this.tailCalls = tailCalls;
+    }
+
+    // top-level code
+    static StackCode compile(Interpreter interpreter, List<Stmt> stmts) {
+        return new StackCompiler(interpreter, false).body(stmts);
+    }
+
+    private static StackFunction function(Interpreter interpreter,
+                                          Stmt.Function declaration,
+                                          boolean isInitializer) {
+        StackCode body = new StackCompiler(interpreter, !isInitializer)
+            .body(declaration.body);
+        return new StackFunction(declaration, body, null, isInitializer,
+            null);
+    }
+
+    // falling off the end returns nil
+    private StackCode body(List<Stmt> stmts) {
+        for (Stmt stmt : stmts)
+            compile(stmt);
+
+        emit(CONSTANT, constant(null));
+        emit(RETURN);
+        return new StackCode(Arrays.copyOf(code, length),
+            constants.toArray());
+    }
+
+    private void compile(Stmt stmt) {
+        stmt.accept(this);
+    }
+
+    private void compile(Expr expr) {
+        expr.accept(this);
+    }
+
+    private void emit(int... words) {
+        for (int word : words) {
+            if (length == code.length)
+                code = Arrays.copyOf(code, length * 2);
+            code[length++] = word;
+        }
+    }
+
+    private int constant(Object value) {
+        constants.add(value);
+        return constants.size() - 1;
+    }
+
+    // emits a jump w/ its target left to patch(), returns where...
+    // ... the target goes
+    private int jump(int opcode) {
+        emit(opcode, -1);
+        return length - 1;
+    }
+
+    // points the jump at the next instruction
+    private void patch(int target) {
+        code[target] = length;
+    }
+
+    @Override
+    public Void visitBlockStmt(Stmt.Block stmt) {
+        emit(SCOPE);
+        for (Stmt inner : stmt.statements)
+            compile(inner);
+        emit(END_SCOPE);
+        return null;
+    }
+
+    @Override
+    public Void visitClassStmt(Stmt.Class stmt) {
+        Token superclass = null;
+        if (stmt.superclass != null) {
+            compile(stmt.superclass);
+            superclass = stmt.superclass.name;
+        } else {
+            emit(CONSTANT, constant(null));
+        }
+
+        StackFunction[] methods = new StackFunction[stmt.methods.size()];
+        for (int i = 0; i < methods.length; i++) {
+            Stmt.Function method = stmt.methods.get(i);
+            methods[i] = function(interpreter, method,
+                method.name.symbol == Symbols.INIT);
+        }
+
+        emit(CLASS, constant(new StackCode.Class(stmt.name, superclass,
+            methods)));
+        return null;
+    }
+
+    @Override
+    public Void visitExpressionStmt(Stmt.Expression stmt) {
+        compile(stmt.expression);
+        emit(POP);
+        return null;
+    }
+
+    @Override
+    public Void visitFunctionStmt(Stmt.Function stmt) {
+        emit(FUNCTION, constant(function(interpreter, stmt, false)));
+        return null;
+    }
+
+    @Override
+    public Void visitIfStmt(Stmt.If stmt) {
+        compile(stmt.condition);
+        int elseBranch = jump(JUMP_IF_FALSE);
+
+        compile(stmt.thenBranch);
+        int end = jump(JUMP);
+
+        patch(elseBranch);
+        if (stmt.elseBranch != null)
+            compile(stmt.elseBranch);
+        patch(end);
+        return null;
+    }
+
+    @Override
+    public Void visitPrintStmt(Stmt.Print stmt) {
+        compile(stmt.expression);
+        emit(PRINT);
+        return null;
+    }
+
+    @Override
+    public Void visitReturnStmt(Stmt.Return stmt) {
+        if (stmt.value == null)
+            emit(CONSTANT, constant(null));
+        else if (tailCalls && stmt.value instanceof Expr.Call)
+            call((Expr.Call)stmt.value, TAIL_CALL);
+        else
+            compile(stmt.value);
+
+        // after a TAIL_CALL that didn't replace the frame (e.g. a...
+        // ... native), this returns what it pushed
+        emit(RETURN);
+        return null;
+    }
+
+    @Override
+    public Void visitVarStmt(Stmt.Var stmt) {
+        if (stmt.initializer != null)
+            compile(stmt.initializer);
+        else
+            emit(CONSTANT, constant(null));
+
+        emit(DEFINE, constant(stmt.name));
+        return null;
+    }
+
+    @Override
+    public Void visitWhileStmt(Stmt.While stmt) {
+        int start = length;
+        compile(stmt.condition);
+        int end = jump(JUMP_IF_FALSE);
+
+        compile(stmt.body);
+        emit(JUMP, start);
+
+        patch(end);
+        return null;
+    }
+
+    @Override
+    public Void visitAssignExpr(Expr.Assign expr) {
+        compile(expr.value);
+
+        Slot slot = interpreter.slotOf(expr);
+        if (slot == null)
+            emit(SET_GLOBAL, constant(expr.name));
+        else
+            emit(SET_LOCAL, slot.depth, slot.index);
+        return null;
+    }
+
+    @Override
+    public Void visitBinaryExpr(Expr.Binary expr) {
+        compile(expr.left);
+        compile(expr.right);
+        emit(BINARY, constant(expr.operator));
+        return null;
+    }
+
+    @Override
+    public Void visitCallExpr(Expr.Call expr) {
+        call(expr, CALL);
+        return null;
+    }
+
+    // `obj.method(args)` is a GET then a CALL, which binds the...
+    // ... method first but behaves the same
+    private void call(Expr.Call expr, int opcode) {
+        compile(expr.callee);
+        for (Expr arg : expr.args)
+            compile(arg);
+
+        emit(opcode, expr.args.size(), constant(expr.paren));
+    }
+
+    @Override
+    public Void visitGetExpr(Expr.Get expr) {
+        compile(expr.object);
+        emit(GET, constant(expr));
+        return null;
+    }
+
+    @Override
+    public Void visitGroupingExpr(Expr.Grouping expr) {
+        compile(expr.expression);
+        return null;
+    }
+
+    @Override
+    public Void visitLiteralExpr(Expr.Literal expr) {
+        emit(CONSTANT, constant(expr.value));
+        return null;
+    }
+
+    @Override
+    public Void visitLogicalExpr(Expr.Logical expr) {
+        compile(expr.left);
+        int end = jump(expr.operator.type == TokenType.OR ? OR : AND);
+
+        compile(expr.right);
+        patch(end);
+        return null;
+    }
+
+    @Override
+    public Void visitSetExpr(Expr.Set expr) {
+        compile(expr.object);
+        emit(CHECK_INSTANCE, constant(expr.name));
+
+        compile(expr.value);
+        emit(SET, constant(expr));
+        return null;
+    }
+
+    @Override
+    public Void visitSuperExpr(Expr.Super expr) {
+        emit(SUPER, interpreter.slotOf(expr).depth, constant(expr.method));
+        return null;
+    }
+
+    @Override
+    public Void visitTernaryExpr(Expr.Ternary expr) {
+        compile(expr.left);
+        compile(expr.mid);
+        compile(expr.right);
+        emit(TERNARY);
+        return null;
+    }
+
+    @Override
+    public Void visitThisExpr(Expr.This expr) {
+        variable(expr.keyword, expr);
+        return null;
+    }
+
+    @Override
+    public Void visitUnaryExpr(Expr.Unary expr) {
+        compile(expr.right);
+
+        if (expr.operator.type == TokenType.BANG)
+            emit(NOT);
+        else
+            emit(NEGATE, constant(expr.operator));
+        return null;
+    }
+
+    @Override
+    public Void visitVariableExpr(Expr.Variable expr) {
+        variable(expr.name, expr);
+        return null;
+    }
+
+    private void variable(Token name, Expr expr) {
+        Slot slot = interpreter.slotOf(expr);
+        if (slot == null)
+            emit(GET_GLOBAL, constant(name));
+        else
+            emit(GET_LOCAL, slot.depth, slot.index);
+    }
+}
@@ -0,0 +1,34 @@
+package com.craftinginterpreters.lox;
+
+// a function whose body StackCompiler flattened; StackMachine calls...
+// ... it by pushing a frame, not through execute()
+class StackFunction extends LoxFunction {
+    final StackCode code;
+
+    StackFunction(Stmt.Function declaration, StackCode code,
+                  Environment closure, boolean isInitializer,
+                  LoxInstance receiver) {
+        super(declaration, closure, isInitializer, receiver);
+        this.code = code;
+    }
+
+    // the body is compiled once per declaration; each time the...
+    // ... declaration runs it closes over that run's env
+    StackFunction closeOver(Environment env) {
+        return new StackFunction(declaration, code, env, isInitializer,
+            receiver);
+    }
+
+    // only reached when something other than the machine calls it
+    @Override
+    Object execute(Interpreter interpreter, LoxInstance receiver,
+                   Object[] frame) {
+        return new StackMachine(interpreter).execute(this, receiver, frame);
+    }
+
+    @Override
+    LoxFunction bind(LoxInstance instance) {
+        return new StackFunction(declaration, code, closure, isInitializer,
+            instance);
+    }
+}
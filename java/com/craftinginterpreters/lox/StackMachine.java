@@ -0,0 +1,399 @@
+package com.craftinginterpreters.lox;
+
+import java.util.Arrays;
+import java.util.List;
+
+import static com.craftinginterpreters.lox.StackCode.*;
+
+// runs StackCode w/ an explicit operand stack and call-frame stack...
+// ... on the heap: a Lox call pushes a Frame and a return pops one,...
+// ... and the loop in run() never recurses, so recursion is only as...
+// ... deep as memory allows
+//
+// `return f(...)` (TAIL_CALL) reuses the caller's frame, so tail...
+// ... recursion runs in constant space
+class StackMachine {
+    private final Interpreter interpreter;
+
+    private Object[] stack = new Object[256];
+    private int sp = 0;
+
+    // frames are reused as calls come and go
+    private Frame[] frames = new Frame[64];
+    private int frameCount = 0;
+
+    private static final class Frame {
+        StackCode code;
+        int ip;
+        Environment env;
+
+        // null for top-level code
+        LoxFunction function;
+        LoxInstance receiver;
+
+        // the operand stack below this is the caller's
+        int base;
+    }
+
+    StackMachine(Interpreter interpreter) {
+        this.interpreter = interpreter;
+    }
+
+    // runs a program, top-level code directly in the globals
+    static void interpret(Interpreter interpreter, List<Stmt> stmts) {
+        StackCode script = StackCompiler.compile(interpreter, stmts);
+
+        StackMachine machine = new StackMachine(interpreter);
+        try {
+            machine.push(script, interpreter.globals, null, null);
+            machine.run();
+        }
+        catch(RuntimeError error) {
+            Lox.runtimeError(error);
+        }
+    }
+
+    // a call from outside the machine: `frame` already holds the...
+    // ... receiver and args (see LoxFunction.newFrame())
+    Object execute(StackFunction function, LoxInstance receiver,
+                   Object[] frame) {
+        LoxFunction.calls++;
+
+        int count = function.arity() + (receiver != null ? 1 : 0);
+        push(function.code, new Environment(function.closure, frame, count),
+            function, receiver);
+        return run();
+    }
+
+    private void push(StackCode code, Environment env, LoxFunction function,
+                      LoxInstance receiver) {
+        if (frameCount == frames.length)
+            frames = Arrays.copyOf(frames, frameCount * 2);
+
+        Frame frame = frames[frameCount];
+        if (frame == null)
+            frame = frames[frameCount] = new Frame();
+        frameCount++;
+
+        frame.code = code;
+        frame.ip = 0;
+        frame.env = env;
+        frame.function = function;
+        frame.receiver = receiver;
+        frame.base = sp;
+    }
+
+    private void push(Object value) {
+        if (sp == stack.length)
+            stack = Arrays.copyOf(stack, sp * 2);
+        stack[sp++] = value;
+    }
+
+    private Object pop() {
+        Object value = stack[--sp];
+        stack[sp] = null;
+        return value;
+    }
+
+    // runs until the frame on top when it was called returns
+    private Object run() {
+        int exit = frameCount - 1;
+        Frame frame = frames[frameCount - 1];
+        int[] code = frame.code.code;
+        Object[] constants = frame.code.constants;
+
+        for (;;) {
+            switch (code[frame.ip++]) {
+                case CONSTANT:
+                    push(constants[code[frame.ip++]]);
+                    break;
+
+                case POP:
+                    pop();
+                    break;
+
+                case GET_LOCAL: {
+                    int depth = code[frame.ip++];
+                    push(frame.env.getAt(depth, code[frame.ip++]));
+                    break;
+                }
+
+                case SET_LOCAL: {
+                    int depth = code[frame.ip++];
+                    frame.env.assignAt(depth, code[frame.ip++], stack[sp - 1]);
+                    break;
+                }
+
+                case GET_GLOBAL:
+                    push(interpreter.globals.get((Token)constants[code[frame.ip++]]));
+                    break;
+
+                case SET_GLOBAL:
+                    interpreter.globals.assign((Token)constants[code[frame.ip++]],
+                        stack[sp - 1]);
+                    break;
+
+                case DEFINE:
+                    frame.env.define(((Token)constants[code[frame.ip++]]).symbol,
+                        pop());
+                    break;
+
+                case BINARY: {
+                    Token operator = (Token)constants[code[frame.ip++]];
+                    Object right = pop();
+                    Object left = pop();
+                    push(Interpreter.binary(operator, left, right));
+                    break;
+                }
+
+                case NOT:
+                    push(!Interpreter.isTruthy(pop()));
+                    break;
+
+                case NEGATE: {
+                    Token operator = (Token)constants[code[frame.ip++]];
+                    Object right = pop();
+                    Interpreter.checkNumberOperand(operator, right);
+                    push(-(double)right);
+                    break;
+                }
+
+                case TERNARY: {
+                    Object right = pop();
+                    Object mid = pop();
+                    Object left = pop();
+                    push(Interpreter.isTruthy(left) ? mid : right);
+                    break;
+                }
+
+                case JUMP:
+                    frame.ip = code[frame.ip];
+                    break;
+
+                case JUMP_IF_FALSE: {
+                    int target = code[frame.ip++];
+                    if (!Interpreter.isTruthy(pop()))
+                        frame.ip = target;
+                    break;
+                }
+
+                case AND: {
+                    int target = code[frame.ip++];
+                    if (!Interpreter.isTruthy(stack[sp - 1]))
+                        frame.ip = target;
+                    else
+                        pop();
+                    break;
+                }
+
+                case OR: {
+                    int target = code[frame.ip++];
+                    if (Interpreter.isTruthy(stack[sp - 1]))
+                        frame.ip = target;
+                    else
+                        pop();
+                    break;
+                }
+
+                case CALL:
+                case TAIL_CALL: {
+                    boolean tail = code[frame.ip - 1] == TAIL_CALL;
+                    int argc = code[frame.ip++];
+                    Token paren = (Token)constants[code[frame.ip++]];
+
+                    // false when it was a native, already done
+                    if (call(argc, paren, tail)) {
+                        frame = frames[frameCount - 1];
+                        code = frame.code.code;
+                        constants = frame.code.constants;
+                    }
+                    break;
+                }
+
+                case GET: {
+                    Expr.Get get = (Expr.Get)constants[code[frame.ip++]];
+                    Object obj = pop();
+                    if (!(obj instanceof LoxInstance))
+                        throw new RuntimeError(get.name,
+                            "only instances have properties");
+
+                    push(get.cache.get((LoxInstance)obj, get.name));
+                    break;
+                }
+
+                case CHECK_INSTANCE:
+                    if (!(stack[sp - 1] instanceof LoxInstance))
+                        throw new RuntimeError(
+                            (Token)constants[code[frame.ip]],
+                            "only instances have fields");
+                    frame.ip++;
+                    break;
+
+                case SET: {
+                    Expr.Set set = (Expr.Set)constants[code[frame.ip++]];
+                    Object value = pop();
+                    LoxInstance instance = (LoxInstance)pop();
+                    set.cache.set(instance, set.name, value);
+                    push(value);
+                    break;
+                }
+
+                case SUPER: {
+                    int distance = code[frame.ip++];
+                    Token method = (Token)constants[code[frame.ip++]];
+                    push(superMethod(frame.env, distance, method));
+                    break;
+                }
+
+                case PRINT:
+                    System.out.println(Interpreter.stringify(pop()));
+                    break;
+
+                case RETURN: {
+                    Object result = pop();
+                    Frame done = frame;
+                    frameCount--;
+                    sp = done.base;
+
+                    // an initializer always returns "this"
+                    if (done.function != null && done.function.isInitializer)
+                        result = done.receiver;
+
+                    if (frameCount == exit)
+                        return result;
+
+                    frame = frames[frameCount - 1];
+                    code = frame.code.code;
+                    constants = frame.code.constants;
+                    push(result);
+                    break;
+                }
+
+                case SCOPE:
+                    frame.env = new Environment(frame.env);
+                    break;
+
+                case END_SCOPE:
+                    frame.env = frame.env.enclosing;
+                    break;
+
+                case FUNCTION: {
+                    StackFunction template =
+                        (StackFunction)constants[code[frame.ip++]];
+                    frame.env.define(template.declaration.name.symbol,
+                        template.closeOver(frame.env));
+                    break;
+                }
+
+                case CLASS:
+                    declareClass(frame.env,
+                        (StackCode.Class)constants[code[frame.ip++]], pop());
+                    break;
+            }
+        }
+    }
+
+    // the callee is below `argc` args on the stack; a Lox function...
+    // ... (or a class w/ a Lox initializer) gets a new frame and this...
+    // ... returns true, anything else is called here and its result...
+    // ... replaces the callee and args
+    private boolean call(int argc, Token paren, boolean tail) {
+        Object callee = stack[sp - argc - 1];
+
+        if (!(callee instanceof LoxCallable))
+            throw new RuntimeError(paren, "can only call functions and classes");
+
+        LoxCallable callable = (LoxCallable)callee;
+        if (argc != callable.arity()) {
+            throw new RuntimeError(paren, "expected " + callable.arity() +
+                " arguments but got " + argc);
+        }
+
+        if (callee instanceof StackFunction) {
+            StackFunction function = (StackFunction)callee;
+            enter(function, function.receiver, argc, tail);
+            return true;
+        }
+
+        if (callee instanceof LoxClass) {
+            LoxClass klass = (LoxClass)callee;
+            LoxFunction initializer = klass.findMethod(Symbols.INIT);
+            if (initializer instanceof StackFunction) {
+                enter((StackFunction)initializer, new LoxInstance(klass), argc,
+                    tail);
+                return true;
+            }
+        }
+
+        Object[] args = Arrays.copyOfRange(stack, sp - argc, sp);
+        for (int i = 0; i <= argc; i++)
+            pop();
+        push(callable.call(interpreter, args));
+        return false;
+    }
+
+    private void enter(StackFunction function, LoxInstance receiver,
+                       int argc, boolean tail) {
+        LoxFunction.calls++;
+
+        Object[] slots = function.newFrame(receiver);
+        int offset = receiver != null ? 1 : 0;
+        System.arraycopy(stack, sp - argc, slots, offset, argc);
+        for (int i = 0; i <= argc; i++)
+            pop();
+
+        // the caller is done: its frame goes, and this call returns...
+        // ... straight to the caller's caller
+        if (tail) {
+            Frame caller = frames[--frameCount];
+            while (sp > caller.base)
+                pop();
+        }
+
+        push(function.code, new Environment(function.closure, slots,
+            offset + argc), function, receiver);
+    }
+
+    private LoxFunction superMethod(Environment env, int distance,
+                                    Token name) {
+        // "super" is the only slot in its env, "this" is slot 0 of...
+        // ... the method's env just inside it
+        LoxClass superclass = (LoxClass)env.getAt(distance, 0);
+        LoxInstance obj = (LoxInstance)env.getAt(distance - 1, 0);
+
+        LoxFunction method = superclass.findMethod(name.symbol);
+        if (method == null)
+            throw new RuntimeError(name, "undefined property '" + name.lexeme + "'");
+
+        return method.bind(obj);
+    }
+
+    // like Interpreter.visitClassStmt()
+    private void declareClass(Environment env, StackCode.Class declaration,
+                              Object superclass) {
+        if (declaration.superclass != null && !(superclass instanceof LoxClass))
+            throw new RuntimeError(declaration.superclass, "superclass must be a class");
+
+        int slot = env.define(declaration.name.symbol, null);
+
+        // methods of a subclass close over an env holding "super"
+        Environment methodEnv = env;
+        if (declaration.superclass != null) {
+            methodEnv = new Environment(env);
+            methodEnv.define(Symbols.SUPER, superclass);
+        }
+
+        SymbolMap<LoxFunction> methods = new SymbolMap<>();
+        for (StackFunction method : declaration.methods)
+            methods.put(method.declaration.name.symbol,
+                method.closeOver(methodEnv));
+
+        LoxClass klass = new LoxClass(declaration.name.lexeme,
+            (LoxClass)superclass, methods);
+
+        if (slot < 0)
+            env.assign(declaration.name, klass);
+        else
+            env.assignAt(0, slot, klass);
+    }
+}
@@ -73,6 +73,7 @@ abstract class Stmt {
 		final Token name;
 		final List<Token> params;
 		final List<Stmt> body;
+		final FrameLayout frame = new FrameLayout();
 	}
 
 	static class If extends Stmt {
@@ -0,0 +1,210 @@
+package com.craftinginterpreters.lox;
+
+// statements compiled by NodeCompiler, see ExprNode...
+// ... the environment to run in is passed down explicitly...
+// ... instead of living in a mutable field like the visitor's
+//
+// a `return` doesn't throw: exec() hands back its value, and every...
+// ... statement list and loop stops at the first completion that...
+// ... isn't NORMAL and passes it up to the function being called
+abstract class StmtNode {
+    static final Object NORMAL = new Object();
+
+    abstract Object exec(Environment env);
+
+    static class Expression extends StmtNode {
+        final ExprNode expression;
+
+        Expression(ExprNode expression) {
+            this.expression = expression;
+        }
+
+        @Override
+        Object exec(Environment env) {
+            expression.eval(env);
+            return NORMAL;
+        }
+    }
+
+    static class Print extends StmtNode {
+        final ExprNode expression;
+
+        Print(ExprNode expression) {
+            this.expression = expression;
+        }
+
+        @Override
+        Object exec(Environment env) {
+            System.out.println(Interpreter.stringify(expression.eval(env)));
+            return NORMAL;
+        }
+    }
+
+    // defines into whatever env it runs in: the globals map at...
+    // ... the top level, the next free slot anywhere else
+    static class Var extends StmtNode {
+        final int name;         // the symbol ID
+        final ExprNode initializer;
+
+        Var(int name, ExprNode initializer) {
+            this.name = name;
+            this.initializer = initializer;
+        }
+
+        @Override
+        Object exec(Environment env) {
+            Object value = null;
+            if (initializer != null)
+                value = initializer.eval(env);
+
+            env.define(name, value);
+            return NORMAL;
+        }
+    }
+
+    static class Block extends StmtNode {
+        final StmtNode[] statements;
+
+        Block(StmtNode[] statements) {
+            this.statements = statements;
+        }
+
+        @Override
+        Object exec(Environment env) {
+            Environment inner = new Environment(env);
+            for (StmtNode stmt : statements) {
+                Object completion = stmt.exec(inner);
+                if (completion != NORMAL)
+                    return completion;
+            }
+            return NORMAL;
+        }
+    }
+
+    static class If extends StmtNode {
+        final ExprNode condition;
+        final StmtNode thenBranch;
+        final StmtNode elseBranch;
+
+        If(ExprNode condition, StmtNode thenBranch, StmtNode elseBranch) {
+            this.condition = condition;
+            this.thenBranch = thenBranch;
+            this.elseBranch = elseBranch;
+        }
+
+        @Override
+        Object exec(Environment env) {
+            if (Interpreter.isTruthy(condition.eval(env)))
+                return thenBranch.exec(env);
+            else if (elseBranch != null)
+                return elseBranch.exec(env);
+            return NORMAL;
+        }
+    }
+
+    static class While extends StmtNode {
+        final ExprNode condition;
+        final StmtNode body;
+
+        While(ExprNode condition, StmtNode body) {
+            this.condition = condition;
+            this.body = body;
+        }
+
+        @Override
+        Object exec(Environment env) {
+            while (Interpreter.isTruthy(condition.eval(env))) {
+                Object completion = body.exec(env);
+                if (completion != NORMAL)
+                    return completion;
+            }
+            return NORMAL;
+        }
+    }
+
+    static class Return extends StmtNode {
+        final ExprNode value;
+
+        Return(ExprNode value) {
+            this.value = value;
+        }
+
+        @Override
+        Object exec(Environment env) {
+            Object result = null;
+            if (value != null)
+                result = value.eval(env);
+
+            return result;
+        }
+    }
+
+    // the body is compiled once, here, and shared by every...
+    // ... closure the declaration creates at runtime
+    static class Function extends StmtNode {
+        final Stmt.Function declaration;
+        final StmtNode[] body;
+
+        Function(Stmt.Function declaration, StmtNode[] body) {
+            this.declaration = declaration;
+            this.body = body;
+        }
+
+        @Override
+        Object exec(Environment env) {
+            env.define(declaration.name.symbol,
+                new CompiledFunction(declaration, body, env, false));
+            return NORMAL;
+        }
+    }
+
+    static class Class extends StmtNode {
+        final Token name;
+        final ExprNode superclass;
+        final Token superclassName;
+        final Function[] methods;
+
+        Class(Token name, ExprNode superclass, Token superclassName,
+              Function[] methods) {
+            this.name = name;
+            this.superclass = superclass;
+            this.superclassName = superclassName;
+            this.methods = methods;
+        }
+
+        @Override
+        Object exec(Environment env) {
+            Object parent = null;
+            if (superclass != null) {
+                parent = superclass.eval(env);
+
+                if (!(parent instanceof LoxClass))
+                    throw new RuntimeError(superclassName, "superclass must be a class");
+            }
+            int slot = env.define(name.symbol, null);
+
+            // methods of a subclass close over an env holding "super"
+            Environment methodEnv = env;
+            if (superclass != null) {
+                methodEnv = new Environment(env);
+                methodEnv.define(Symbols.SUPER, parent);
+            }
+
+            SymbolMap<LoxFunction> table = new SymbolMap<>();
+            for (Function method : methods) {
+                int methodName = method.declaration.name.symbol;
+                table.put(methodName, new CompiledFunction(
+                    method.declaration, method.body, methodEnv,
+                    methodName == Symbols.INIT));
+            }
+
+            LoxClass klass = new LoxClass(name.lexeme, (LoxClass)parent, table);
+
+            if (slot < 0)
+                env.assign(name, klass);
+            else
+                env.assignAt(0, slot, klass);
+            return NORMAL;
+        }
+    }
+}
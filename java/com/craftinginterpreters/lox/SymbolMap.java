@@ -0,0 +1,92 @@
+package com.craftinginterpreters.lox;
+
+import java.util.Arrays;
+
+// a map keyed by symbol ID (see Symbols): open addressing w/ linear...
+// ... probing over parallel arrays, and since IDs are dense the ID...
+// ... is its own hash, so a lookup is an int compare or two
+//
+// there's no removal, nothing in the runtime ever needs it
+class SymbolMap<V> {
+    private static final int EMPTY = -1;
+
+    // the capacity's always a power of two
+    private int[] keys;
+    private Object[] values;
+    private int size = 0;
+
+    SymbolMap() {
+        keys = new int[8];
+        values = new Object[8];
+        Arrays.fill(keys, EMPTY);
+    }
+
+    SymbolMap(SymbolMap<? extends V> other) {
+        keys = other.keys.clone();
+        values = other.values.clone();
+        size = other.size;
+    }
+
+    int size() {
+        return size;
+    }
+
+    boolean containsKey(int symbol) {
+        return keys[find(symbol)] == symbol;
+    }
+
+    @SuppressWarnings("unchecked")
+    V get(int symbol) {
+        int index = find(symbol);
+        return keys[index] == symbol ? (V)values[index] : null;
+    }
+
+    void put(int symbol, V value) {
+        int index = find(symbol);
+        if (keys[index] != symbol) {
+            // kept under half full, so probes stay short
+            if ((size + 1) * 2 > keys.length) {
+                grow();
+                index = find(symbol);
+            }
+            keys[index] = symbol;
+            size++;
+        }
+        values[index] = value;
+    }
+
+    @SuppressWarnings("unchecked")
+    void putAll(SymbolMap<? extends V> other) {
+        for (int i = 0; i < other.keys.length; i++) {
+            if (other.keys[i] != EMPTY)
+                put(other.keys[i], (V)other.values[i]);
+        }
+    }
+
+    // the slot `symbol` is in, or the empty one it'd go in
+    private int find(int symbol) {
+        int mask = keys.length - 1;
+        int index = symbol & mask;
+        while (keys[index] != symbol && keys[index] != EMPTY)
+            index = (index + 1) & mask;
+
+        return index;
+    }
+
+    private void grow() {
+        int[] oldKeys = keys;
+        Object[] oldValues = values;
+
+        keys = new int[oldKeys.length * 2];
+        values = new Object[oldKeys.length * 2];
+        Arrays.fill(keys, EMPTY);
+
+        for (int i = 0; i < oldKeys.length; i++) {
+            if (oldKeys[i] != EMPTY) {
+                int index = find(oldKeys[i]);
+                keys[index] = oldKeys[i];
+                values[index] = oldValues[i];
+            }
+        }
+    }
+}
@@ -0,0 +1,56 @@
+package com.craftinginterpreters.lox;
+
+import java.util.Arrays;
+import java.util.concurrent.ConcurrentHashMap;
+
+// the global symbol table: every identifier (and "this", "super",...
+// ... "init" and the natives) gets a small dense int ID the first...
+// ... time it's seen, so the runtime can key its maps on ints...
+// ... instead of hashing and comparing strings
+//
+// IDs are never reused and the table never shrinks; scanners on...
+// ... several threads (FrontEnd) intern at once, which is why...
+// ... lookups go through a ConcurrentHashMap and only new names lock
+final class Symbols {
+    private static final ConcurrentHashMap<String, Integer> ids =
+        new ConcurrentHashMap<>();
+
+    // by ID, for error messages and the like
+    private static String[] names = new String[256];
+    private static int count = 0;
+
+    static final int THIS = intern("this");
+    static final int SUPER = intern("super");
+    static final int INIT = intern("init");
+
+    private Symbols() {}
+
+    static int intern(String name) {
+        Integer id = ids.get(name);
+        if (id != null)
+            return id;
+
+        synchronized (Symbols.class) {
+            id = ids.get(name);
+            if (id != null)
+                return id;
+
+            if (count == names.length)
+                names = Arrays.copyOf(names, count * 2);
+            names[count] = name;
+
+            // published last, so a reader that finds the ID finds the name
+            ids.put(name, count);
+            return count++;
+        }
+    }
+
+    static synchronized String name(int id) {
+        return names[id];
+    }
+
+    // one past the largest ID handed out so far
+    static synchronized int count() {
+        return count;
+    }
+}
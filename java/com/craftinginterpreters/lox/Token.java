@@ -6,11 +6,17 @@ class Token {
     final Object literal;
     final int line;
 
-    Token(TokenType type, String lexeme, Object literal, int line) {
+    // the identifier's ID in Symbols ("this" and "super" have...
+    // ... one too), -1 for any other token
+    final int symbol;
+
+    Token(TokenType type, String lexeme, Object literal, int line,
+          int symbol) {
         this.type = type;
         this.lexeme = lexeme;
         this.literal = literal;
         this.line = line;
+        this.symbol = symbol;
     }
 
     public String toString() {
@@ -0,0 +1,88 @@
+package com.craftinginterpreters.lox;
+
+import java.util.Arrays;
+
+// the scanner's output, packed: one entry per token across parallel...
+// ... int arrays (type ordinal, start offset, length, line, symbol)...
+// ... instead of a Token object, lexeme String and boxed literal each
+//
+// lexemes and literals are cut out of the source only when the...
+// ... parser asks for them, i.e. for tokens that end up in the AST
+class TokenStream {
+    private static final TokenType[] TYPES = TokenType.values();
+
+    private final String src;
+
+    private int[] types;
+    private int[] starts;
+    private int[] lengths;
+    private int[] lines;
+    private int[] symbols;
+    private int count = 0;
+
+    TokenStream(String src) {
+        this.src = src;
+
+        // roughly a token per 4 chars of source, to begin w/
+        int capacity = Math.max(16, src.length() / 4);
+        types = new int[capacity];
+        starts = new int[capacity];
+        lengths = new int[capacity];
+        lines = new int[capacity];
+        symbols = new int[capacity];
+    }
+
+    void add(TokenType type, int start, int length, int line, int symbol) {
+        if (count == types.length) {
+            int capacity = count * 2;
+            types = Arrays.copyOf(types, capacity);
+            starts = Arrays.copyOf(starts, capacity);
+            lengths = Arrays.copyOf(lengths, capacity);
+            lines = Arrays.copyOf(lines, capacity);
+            symbols = Arrays.copyOf(symbols, capacity);
+        }
+
+        types[count] = type.ordinal();
+        starts[count] = start;
+        lengths[count] = length;
+        lines[count] = line;
+        symbols[count] = symbol;
+        count++;
+    }
+
+    int size() {
+        return count;
+    }
+
+    TokenType type(int index) {
+        return TYPES[types[index]];
+    }
+
+    int line(int index) {
+        return lines[index];
+    }
+
+    String lexeme(int index) {
+        return src.substring(starts[index], starts[index] + lengths[index]);
+    }
+
+    // the value of a NUMBER or STRING token, null for anything else
+    Object literal(int index) {
+        switch (type(index)) {
+            case NUMBER:
+                return Double.parseDouble(lexeme(index));
+            case STRING:
+                // trim the surrounding quotes
+                return src.substring(starts[index] + 1,
+                    starts[index] + lengths[index] - 1);
+            default:
+                return null;
+        }
+    }
+
+    // materializes a Token for the AST or an error message
+    Token token(int index) {
+        return new Token(type(index), lexeme(index), literal(index),
+            lines[index], symbols[index]);
+    }
+}
@@ -0,0 +1,60 @@
+package com.craftinginterpreters.tool;
+
+import java.lang.management.ManagementFactory;
+import java.lang.reflect.InvocationTargetException;
+import java.lang.reflect.Method;
+import java.util.Arrays;
+
+// runs another class' main() and reports on stderr how many bytes...
+// ... the main thread allocated and how long it took, the same for...
+// ... any build of jlox, e.g. for tools/alloc_bench.py
+public class AllocStats {
+    private static final com.sun.management.ThreadMXBean threads =
+        (com.sun.management.ThreadMXBean)ManagementFactory.getThreadMXBean();
+
+    private static long mainThread;
+    private static long allocatedAtStart;
+    private static long startedAt;
+    private static boolean reported = false;
+
+    public static void main(String[] args) throws Throwable {
+        if (args.length < 1) {
+            System.err.println("usage: alloc_stats <main class> [arg ...]");
+
+            // command used incorrectly (UNIX "sysexits.h" header)
+            System.exit(64);
+        }
+
+        Method main = Class.forName(args[0])
+            .getMethod("main", String[].class);
+        String[] rest = Arrays.copyOfRange(args, 1, args.length);
+
+        // jlox leaves w/ System.exit() on errors, and that runs the...
+        // ... hook while the main thread is still alive
+        mainThread = Thread.currentThread().getId();
+        Runtime.getRuntime().addShutdownHook(new Thread(AllocStats::report));
+
+        allocatedAtStart = threads.getThreadAllocatedBytes(mainThread);
+        startedAt = System.nanoTime();
+        try {
+            main.invoke(null, (Object)rest);
+        } catch (InvocationTargetException e) {
+            throw e.getCause();
+        }
+        report();
+    }
+
+    private static synchronized void report() {
+        if (reported)
+            return;
+        reported = true;
+
+        double seconds = (System.nanoTime() - startedAt) / 1e9;
+
+        // -1 once the main thread died of an exception
+        long allocated = threads.getThreadAllocatedBytes(mainThread);
+        if (allocated >= 0)
+            System.err.printf("allocated %d bytes in %.3fs%n",
+                allocated - allocatedAtStart, seconds);
+    }
+}
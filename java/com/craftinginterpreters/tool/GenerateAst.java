@@ -20,11 +20,12 @@ public class GenerateAst {
             "Assign: Token name, Expr value",
             "Binary     : Expr left, Token operator, Expr right",
             "Call       : Expr callee, Token paren, List<Expr> args",
-            "Get        : Expr object, Token name",
+            "Get        : Expr object, Token name; PropertyCache cache",
             "Grouping   : Expr expression",
             "Literal    : Object value",
             "Logical    : Expr left, Token operator, Expr right",
-            "Set        : Expr object, Token name, Expr value",
+            "Set        : Expr object, Token name, Expr value;" +
+                        " PropertyCache cache",
             "Super      : Token keyword, Token method",
             "Ternary    : Expr left, Token op1, Expr mid, Token op2, Expr right",
             "This       : Token keyword",
@@ -38,7 +39,7 @@ public class GenerateAst {
                         " List<Stmt.Function> methods",
             "Expression : Expr expression",
             "Function   : Token name, List<Token> params," +
-                        " List<Stmt> body",
+                        " List<Stmt> body; FrameLayout frame",
             "If         : Expr condition, Stmt thenBranch," +
                         " Stmt elseBranch",
             "Print      : Expr expression",
@@ -74,9 +75,17 @@ public class GenerateAst {
             // ... from defineAst()'s param List<String> types
             String className = type.split(":")[0].trim();
             String fields = type.split(":")[1].trim();
+
+            // anything after a ";" is per-node runtime state...
+            // ... (e.g. an inline cache), not a constructor param
+            String state = "";
+            if (fields.contains(";")) {
+                state = fields.split(";")[1].trim();
+                fields = fields.split(";")[0].trim();
+            }
             
             // 
-            defineType(writer, baseName, className, fields);
+            defineType(writer, baseName, className, fields, state);
         }
 
         // the base accept() method
@@ -103,7 +112,7 @@ public class GenerateAst {
 
     private static void defineType(
             PrintWriter writer, String baseName,
-            String className, String fieldList) {
+            String className, String fieldList, String stateList) {
         
         writer.println("\n\tstatic class " + className + " extends " +
             baseName + " {");
@@ -131,6 +140,14 @@ public class GenerateAst {
         writer.println();
         for (String field : fields)
             writer.println("\t\tfinal " + field + ";");
+
+        // state fields are default constructed
+        if (!stateList.isEmpty()) {
+            for (String field : stateList.split(", ")) {
+                String type = field.split(" ")[0];
+                writer.println("\t\tfinal " + field + " = new " + type + "();");
+            }
+        }
         
         writer.println("\t}");
     }
@@ -0,0 +1,71 @@
+package com.craftinginterpreters.lox;
+
+import java.util.List;
+import java.util.concurrent.TimeUnit;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+
+// the micro-workloads in Sources under each engine; scanning,...
+// ... parsing, resolving and compiling happen once per trial, so...
+// ... only execution is measured
+//
+// the same interpreter reruns the program every invocation, which...
+// ... just redefines its globals
+@State(Scope.Benchmark)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+@Warmup(iterations = 5, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+public class InterpreterBenchmark {
+    @Param({"variables", "calls", "properties", "strings"})
+    public String workload;
+
+    @Param({"visitor", "closure", "jvm"})
+    public String engine;
+
+    private Interpreter interpreter;
+    private List<Stmt> stmts;
+    private StmtNode[] nodes;
+
+    // null if JvmCompiler couldn't compile it; the visitor runs it then
+    private JvmCompiler.Unit unit;
+
+    @Setup(Level.Trial)
+    public void compile() {
+        interpreter = new Interpreter();
+        stmts = new Parser(new Scanner(Sources.workload(workload))
+            .scanTokens()).parse();
+        new Resolver(interpreter).resolve(stmts);
+
+        if (Lox.hadError)
+            throw new IllegalStateException("workload doesn't compile");
+
+        if (engine.equals("closure"))
+            nodes = new NodeCompiler(interpreter).compile(stmts);
+        else if (engine.equals("jvm"))
+            unit = JvmCompiler.compile(interpreter, stmts);
+    }
+
+    @Benchmark
+    public Interpreter run() {
+        if (nodes != null)
+            interpreter.interpret(nodes);
+        else if (unit != null)
+            unit.code.exec(interpreter.globals, unit.constants);
+        else
+            interpreter.interpret(stmts);
+        return interpreter;
+    }
+}
@@ -0,0 +1,109 @@
+package com.craftinginterpreters.lox;
+
+import java.util.List;
+import java.util.concurrent.TimeUnit;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+
+// each stage of Lox.run() on its own, on generated sources of...
+// ... increasing size; a stage's input is built once, by the...
+// ... stages before it, outside the measurement
+@State(Scope.Benchmark)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+@Warmup(iterations = 5, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+public class PipelineBenchmark {
+    // copies of Sources' chunk, ~0.6 KB each
+    @Param({"10", "100", "1000"})
+    public int chunks;
+
+    private String src;
+    private TokenStream tokens;
+    private List<Stmt> stmts;
+
+    @Setup(Level.Trial)
+    public void generate() {
+        src = Sources.generate(chunks);
+        tokens = new Scanner(src).scanTokens();
+        stmts = new Parser(tokens).parse();
+    }
+
+    @Benchmark
+    public TokenStream scan() {
+        return new Scanner(src).scanTokens();
+    }
+
+    @Benchmark
+    public List<Stmt> parse() {
+        return new Parser(tokens).parse();
+    }
+
+    @Benchmark
+    public Interpreter resolver() {
+        Interpreter fresh = new Interpreter();
+        new Resolver(fresh).resolve(stmts);
+        return fresh;
+    }
+
+    // the pass `--optimize` adds between resolving and interpreting
+    @Benchmark
+    public List<Stmt> optimize() {
+        return new Optimizer().optimize(stmts);
+    }
+
+    // interpreting needs a freshly resolved interpreter each time,...
+    // ... set up per invocation only for the benchmark that uses it
+    @State(Scope.Thread)
+    public static class Resolved {
+        Interpreter interpreter;
+        List<Stmt> stmts;
+
+        @Setup(Level.Invocation)
+        public void resolve(PipelineBenchmark pipeline) {
+            stmts = pipeline.stmts;
+            interpreter = new Interpreter();
+            new Resolver(interpreter).resolve(stmts);
+        }
+    }
+
+    @Benchmark
+    public Interpreter interpret(Resolved resolved) {
+        resolved.interpreter.interpret(resolved.stmts);
+        return resolved.interpreter;
+    }
+
+    // the same, w/ the program optimized and resolved again like...
+    // ... Lox.optimize() does
+    @State(Scope.Thread)
+    public static class Optimized {
+        Interpreter interpreter;
+        List<Stmt> stmts;
+
+        @Setup(Level.Invocation)
+        public void optimize(PipelineBenchmark pipeline) {
+            interpreter = new Interpreter();
+            new Resolver(interpreter).resolve(pipeline.stmts);
+            stmts = new Optimizer().optimize(pipeline.stmts);
+            new Resolver(interpreter).resolve(stmts);
+        }
+    }
+
+    @Benchmark
+    public Interpreter interpretOptimized(Optimized optimized) {
+        optimized.interpreter.interpret(optimized.stmts);
+        return optimized.interpreter;
+    }
+}
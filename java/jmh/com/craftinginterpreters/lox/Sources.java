@@ -0,0 +1,86 @@
+package com.craftinginterpreters.lox;
+
+// Lox programs for the benchmarks to run: a generated one that grows...
+// ... w/ `chunks`, and fixed micro-workloads that each stress one...
+// ... part of the interpreter; none of them print
+final class Sources {
+    private Sources() {}
+
+    // typical jlox code, repeated to build the generated input...
+    // ... every chunk also calls what it declares, so it does...
+    // ... some work when interpreted and not just declarations
+    private static final String CHUNK =
+        "// a chunk of typical jlox code\n" +
+        "class Point < Base {\n" +
+        "    init(x, y) {\n" +
+        "        this.x = x;\n" +
+        "        this.y = y;\n" +
+        "    }\n" +
+        "    length() {\n" +
+        "        return this.x * this.x + this.y * this.y;\n" +
+        "    }\n" +
+        "}\n" +
+        "fun scale(point, factor) {\n" +
+        "    var result = Point(point.x * factor, point.y * factor);\n" +
+        "    if (factor > 1.5 and !nil) print \"growing \" + factor;\n" +
+        "    for (var i = 0; i < 10; i = i + 1) result.x = result.x - 0.25;\n" +
+        "    return result.length() >= 100 ? result : point;\n" +
+        "}\n" +
+        "scale(Point(3, 4), 1);\n";
+
+    static String generate(int chunks) {
+        StringBuilder src = new StringBuilder("class Base {}\n");
+        for (int i = 0; i < chunks; i++)
+            src.append(CHUNK);
+        return src.toString();
+    }
+
+    // local and global reads and writes
+    static final String VARIABLES =
+        "var total = 0;\n" +
+        "{\n" +
+        "    var a = 1;\n" +
+        "    var b = 2;\n" +
+        "    for (var i = 0; i < 10000; i = i + 1) {\n" +
+        "        a = b + i;\n" +
+        "        b = a - i;\n" +
+        "        total = total + a;\n" +
+        "    }\n" +
+        "}\n";
+
+    // calls that do almost nothing else
+    static final String CALLS =
+        "fun fib(n) {\n" +
+        "    if (n < 2) return n;\n" +
+        "    return fib(n - 1) + fib(n - 2);\n" +
+        "}\n" +
+        "var result = fib(15);\n";
+
+    // field reads and writes, and method invocations
+    static final String PROPERTIES =
+        "class Counter {\n" +
+        "    init() { this.count = 0; }\n" +
+        "    add(n) { this.count = this.count + n; }\n" +
+        "}\n" +
+        "var counter = Counter();\n" +
+        "for (var i = 0; i < 5000; i = i + 1) {\n" +
+        "    counter.add(i);\n" +
+        "    counter.last = counter.count;\n" +
+        "}\n";
+
+    // string concatenation, including numbers
+    static final String STRINGS =
+        "var text = \"\";\n" +
+        "for (var i = 0; i < 500; i = i + 1)\n" +
+        "    text = text + \"item \" + i + \", \";\n";
+
+    static String workload(String name) {
+        switch (name) {
+            case "variables":  return VARIABLES;
+            case "calls":      return CALLS;
+            case "properties": return PROPERTIES;
+            case "strings":    return STRINGS;
+        }
+        throw new IllegalArgumentException("unknown workload '" + name + "'");
+    }
+}
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+# bytes allocated per Lox call, and calls/s, by each jlox engine,...
+# ... and w/ --before REV by the jlox of that revision too, for...
+# ... before/after numbers from builds that may not have...
+# ... `--alloc-stats` yet
+#
+# every run goes through com.craftinginterpreters.tool.AllocStats,...
+# ... which counts what the main thread allocated in all and times...
+# ... main(); the number of calls is the script's own, from HEAD's...
+# ... `--alloc-stats`
+#
+# usage: alloc_bench.py [--engines NAME,...] [--before REV] [script ...]
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+from bench import JLOX_CORPUS_DIR, ROOT
+from conformance import ENGINES, JAVA, LOX_MAIN, build_baseline
+
+ALLOC_STATS = "com.craftinginterpreters.tool.AllocStats"
+ALLOC_STATS_SRC = os.path.join(ROOT, "java", "com", "craftinginterpreters",
+                               "tool", "AllocStats.java")
+
+
+def find_scripts(paths):
+    if paths:
+        return paths
+    return [os.path.join(JLOX_CORPUS_DIR, name)
+            for name in sorted(os.listdir(JLOX_CORPUS_DIR))
+            if name.endswith(".lox")]
+
+
+def stderr_of(cmd):
+    proc = subprocess.run(cmd, stdout=subprocess.DEVNULL,
+                          stderr=subprocess.PIPE)
+    err = proc.stderr.decode(errors="replace")
+    if proc.returncode != 0:
+        raise RuntimeError("exit %d: %s" % (proc.returncode,
+                                            err.strip()[-200:]))
+    return err
+
+
+def calls_in(script):
+    err = stderr_of(JAVA + ["--alloc-stats", script])
+    match = re.search(r"allocated \d+ bytes over (\d+) calls", err)
+    if match is None:
+        raise RuntimeError("no --alloc-stats report")
+    return int(match.group(1))
+
+
+def allocated(classpath, flags, script, tool):
+    # returns (bytes, seconds)
+    err = stderr_of(["java", "-cp", classpath + os.pathsep + tool,
+                     ALLOC_STATS, LOX_MAIN] + flags + [script])
+    match = re.search(r"^allocated (\d+) bytes in ([\d.]+)s$", err,
+                      re.MULTILINE)
+    if match is None:
+        raise RuntimeError("no AllocStats report")
+    return int(match.group(1)), float(match.group(2))
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--engines", default=",".join(ENGINES),
+                        help="comma-separated engines to measure")
+    parser.add_argument("--before",
+                        help="also measure the jlox of this git revision")
+    parser.add_argument("scripts", nargs="*")
+    args = parser.parse_args()
+
+    head = os.path.join(ROOT, "java")
+    # (label, classpath, flags)
+    targets = [("jlox-" + e, head, ["--engine=" + e])
+               for e in args.engines.split(",") if e]
+
+    failed = False
+    with tempfile.TemporaryDirectory() as tmpdir:
+        tool = os.path.join(tmpdir, "tool")
+        subprocess.run(["javac", "-d", tool, ALLOC_STATS_SRC], check=True)
+
+        if args.before:
+            before = os.path.join(tmpdir, "before")
+            os.mkdir(before)
+            # its plain `Lox script`, whatever engine that was then
+            targets.insert(0, ("jlox@" + args.before,
+                               build_baseline(args.before, before), []))
+
+        header = "%-36s %-14s %14s %10s %12s %12s" % (
+            "script", "interp", "bytes", "calls", "bytes/call", "calls/s")
+        print(header)
+        print("-" * len(header))
+
+        for script in find_scripts(args.scripts):
+            name = os.path.relpath(script, ROOT)
+            try:
+                calls = calls_in(script)
+            except RuntimeError as e:
+                failed = True
+                print("%-36s %-14s  FAILED: %s" % (name, "calls", e))
+                continue
+
+            for label, classpath, flags in targets:
+                try:
+                    bytes, seconds = allocated(classpath, flags, script,
+                                               tool)
+                except RuntimeError as e:
+                    failed = True
+                    print("%-36s %-14s  FAILED: %s" % (name, label, e))
+                    continue
+
+                per_call = "%.1f" % (bytes / calls) if calls else "-"
+                rate = "%.0f" % (calls / seconds) if seconds else "-"
+                print("%-36s %-14s %14d %10d %12s %12s" % (
+                    name, label, bytes, calls, per_call, rate))
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+# translates each lox-files/bench/*.lox expression to C w/...
+# ... `clox --emit-c`, builds it, checks it prints what clox does...
+# ... and times both, like tools/bench.py
+#
+# needs c/main_bench (`make compile-clox-bench`)
+#
+# usage: aot_bench.py [--warmup N] [--reps N] [--cc CC] [script ...]
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+from bench import CORPUS_DIR, ROOT, median, percentile, run_once
+
+CLOX = os.path.join(ROOT, "c", "main_bench")
+RUNTIME = [os.path.join(ROOT, "c", name) for name in [
+    "aot.c", "atod.c", "cache.c", "chunk.c", "compiler.c", "debug.c",
+    "dtoa.c", "ir.c", "memory.c", "object.c", "output.c", "rle.c",
+    "scanner.c", "value.c", "vm.c"]]
+CFLAGS = ["-O2", "-DNDEBUG"]
+
+
+def build(script, cc, tmpdir):
+    # returns the executable and how long the C compiler took
+    name = os.path.splitext(os.path.basename(script))[0]
+    source = os.path.join(tmpdir, name + ".c")
+    exe = os.path.join(tmpdir, name)
+
+    subprocess.run([CLOX, "--emit-c", script, source], check=True)
+
+    start = time.perf_counter()
+    subprocess.run([cc] + CFLAGS + ["-I", os.path.join(ROOT, "c"), source] +
+                   RUNTIME + ["-o", exe], check=True)
+    return exe, time.perf_counter() - start
+
+
+def output(cmd):
+    return subprocess.run(cmd, stdout=subprocess.PIPE).stdout
+
+
+def timings(cmd, args):
+    for _ in range(args.warmup):
+        run_once(cmd)
+    return [run_once(cmd) for _ in range(args.reps)]
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--warmup", type=int, default=2)
+    parser.add_argument("--reps", type=int, default=10)
+    parser.add_argument("--cc", default=os.environ.get("CC", "cc"))
+    parser.add_argument("scripts", nargs="*")
+    args = parser.parse_args()
+
+    scripts = args.scripts or [
+        os.path.join(CORPUS_DIR, name)
+        for name in sorted(os.listdir(CORPUS_DIR)) if name.endswith(".lox")]
+
+    header = "%-36s %10s %10s %10s %8s %10s" % (
+        "script", "clox ms", "aot ms", "aot p95", "speedup", "cc s")
+    print(header)
+    print("-" * len(header))
+
+    failed = False
+    with tempfile.TemporaryDirectory() as tmpdir:
+        for script in scripts:
+            name = os.path.relpath(script, ROOT)
+            try:
+                exe, cc_time = build(script, args.cc, tmpdir)
+            except subprocess.CalledProcessError as e:
+                print("%-36s  FAILED: %s" % (name, e))
+                failed = True
+                continue
+
+            if output([CLOX, script]) != output([exe]):
+                print("%-36s  FAILED: output differs from clox" % name)
+                failed = True
+                continue
+
+            clox = timings([CLOX, script], args)
+            aot = timings([exe], args)
+            print("%-36s %10.2f %10.2f %10.2f %7.2fx %10.2f" % (
+                name, median(clox) * 1e3, median(aot) * 1e3,
+                percentile(aot, 95) * 1e3, median(clox) / median(aot),
+                cc_time))
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
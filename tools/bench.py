@@ -0,0 +1,279 @@
+#!/usr/bin/env python3
+# runs the lox-files/bench/ corpus under jlox and clox and reports...
+# ... the median, p95 and throughput of each (script, interpreter)
+#
+# lox-files/bench/*.lox hold a single expression, which is all clox...
+# ... compiles so far; jlox gets them wrapped in a `print` statement...
+# ... lox-files/bench/jlox/*.lox are whole programs only jlox runs
+#
+# w/ --before REV the jlox of that revision is built too and run as...
+# ... "jlox@REV", for before/after numbers from one command
+#
+# usage: bench.py [--warmup N] [--reps N] [--json FILE]
+#                 [--baseline FILE] [--only NAME,...] [--before REV]
+#                 [--expect-overflow NAME,...] [script ...]
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+from conformance import LOX_MAIN, build_baseline
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+CORPUS_DIR = os.path.join(ROOT, "lox-files", "bench")
+JLOX_CORPUS_DIR = os.path.join(CORPUS_DIR, "jlox")
+
+JAVA = ["java", "-cp", os.path.join(ROOT, "java"), LOX_MAIN]
+
+# name -> command (the script path is appended) and which...
+# ... scripts it runs: "expr" (single expressions) or "all"
+TARGETS = {
+    "clox": {
+        "cmd": [os.path.join(ROOT, "c", "main_bench")],
+        "runs": "expr",
+    },
+    "jlox": {
+        "cmd": JAVA,
+        "runs": "all",
+    },
+    "jlox-closure": {
+        "cmd": JAVA + ["--engine=closure"],
+        "runs": "all",
+    },
+    "jlox-jvm": {
+        "cmd": JAVA + ["--engine=jvm"],
+        "runs": "all",
+    },
+    "jlox-stack": {
+        "cmd": JAVA + ["--engine=stack"],
+        "runs": "all",
+    },
+    "jlox-optimize": {
+        "cmd": JAVA + ["--optimize"],
+        "runs": "all",
+    },
+}
+
+# slower than the baseline by more than this is flagged
+REGRESSION_THRESHOLD = 0.10
+
+
+class StackOverflow(RuntimeError):
+    # the JVM ran out of stack, which --expect-overflow allows
+    pass
+
+
+def percentile(samples, pct):
+    # nearest-rank percentile
+    ordered = sorted(samples)
+    rank = max(1, -(-len(ordered) * pct // 100))
+    return ordered[int(rank) - 1]
+
+
+def median(samples):
+    ordered = sorted(samples)
+    mid = len(ordered) // 2
+    if len(ordered) % 2:
+        return ordered[mid]
+    return (ordered[mid - 1] + ordered[mid]) / 2
+
+
+def is_program(path):
+    # anything w/ a statement in it, like tools/conformance.py
+    if os.path.dirname(os.path.abspath(path)) == JLOX_CORPUS_DIR:
+        return True
+    with open(path) as f:
+        return ";" in f.read()
+
+
+def find_scripts(paths):
+    # returns [(path, kind)] where kind is "expr" or "program"
+    if paths:
+        return [(p, "program" if is_program(p) else "expr") for p in paths]
+
+    scripts = []
+    for name in sorted(os.listdir(CORPUS_DIR)):
+        if name.endswith(".lox"):
+            scripts.append((os.path.join(CORPUS_DIR, name), "expr"))
+
+    if os.path.isdir(JLOX_CORPUS_DIR):
+        for name in sorted(os.listdir(JLOX_CORPUS_DIR)):
+            if name.endswith(".lox"):
+                scripts.append((os.path.join(JLOX_CORPUS_DIR, name),
+                                "program"))
+    return scripts
+
+
+def script_for(target, path, kind, tmpdir):
+    # jlox needs a statement, so expressions get printed
+    if TARGETS[target]["runs"] == "expr" or kind == "program":
+        return path
+
+    wrapped = os.path.join(tmpdir, os.path.basename(path))
+    if not os.path.exists(wrapped):
+        with open(path) as src, open(wrapped, "w") as dst:
+            dst.write("print " + src.read().strip() + ";\n")
+    return wrapped
+
+
+def run_once(cmd):
+    start = time.perf_counter()
+    proc = subprocess.run(cmd, stdout=subprocess.DEVNULL,
+                          stderr=subprocess.PIPE)
+    elapsed = time.perf_counter() - start
+
+    if proc.returncode != 0:
+        err = proc.stderr.decode(errors="replace").strip()
+        if "java.lang.StackOverflowError" in err:
+            raise StackOverflow("exit %d: StackOverflowError"
+                                % proc.returncode)
+        raise RuntimeError("exit %d: %s" % (proc.returncode, err[-200:]))
+    return elapsed
+
+
+def bench(target, path, kind, args, tmpdir):
+    script = script_for(target, path, kind, tmpdir)
+    cmd = TARGETS[target]["cmd"] + [script]
+
+    for _ in range(args.warmup):
+        run_once(cmd)
+
+    samples = [run_once(cmd) for _ in range(args.reps)]
+    size = os.path.getsize(path)
+    med = median(samples)
+
+    return {
+        "script": os.path.relpath(path, ROOT),
+        "interpreter": target,
+        "reps": args.reps,
+        "median_ms": med * 1e3,
+        "p95_ms": percentile(samples, 95) * 1e3,
+        "min_ms": min(samples) * 1e3,
+        "runs_per_s": 1 / med,
+        "source_kb_per_s": size / 1024 / med,
+    }
+
+
+def load_baseline(path):
+    with open(path) as f:
+        results = json.load(f)["results"]
+    return {(r["script"], r["interpreter"]): r for r in results}
+
+
+def print_table(results, baseline):
+    # returns whether anything regressed against the baseline
+    regressed = False
+    header = "%-36s %-12s %10s %10s %10s %12s" % (
+        "script", "interp", "median ms", "p95 ms", "runs/s", "src KB/s")
+    if baseline:
+        header += " %10s" % "vs base"
+    print(header)
+    print("-" * len(header))
+
+    for r in results:
+        if "error" in r:
+            print("%-36s %-12s  FAILED: %s" % (
+                r["script"], r["interpreter"], r["error"]))
+            continue
+        if r.get("overflowed"):
+            print("%-36s %-12s  stack overflow, as expected" % (
+                r["script"], r["interpreter"]))
+            continue
+
+        line = "%-36s %-12s %10.2f %10.2f %10.2f %12.1f" % (
+            r["script"], r["interpreter"], r["median_ms"], r["p95_ms"],
+            r["runs_per_s"], r["source_kb_per_s"])
+
+        base = baseline.get((r["script"], r["interpreter"]))
+        if base and "median_ms" in base:
+            change = r["median_ms"] / base["median_ms"] - 1
+            line += " %+9.1f%%" % (change * 100)
+            if change > REGRESSION_THRESHOLD:
+                line += "  <-- REGRESSION"
+                regressed = True
+        print(line)
+
+    return regressed
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--warmup", type=int, default=2)
+    parser.add_argument("--reps", type=int, default=10)
+    parser.add_argument("--json", help="write results as JSON here")
+    parser.add_argument("--baseline",
+                        help="earlier --json output to compare against")
+    parser.add_argument("--only", help="comma-separated interpreters")
+    parser.add_argument("--before",
+                        help="also run the jlox of this git revision")
+    parser.add_argument("--expect-overflow", default="",
+                        help="comma-separated interpreters allowed to "
+                             "die w/ a StackOverflowError; any other "
+                             "failure still fails the run")
+    parser.add_argument("scripts", nargs="*")
+    args = parser.parse_args()
+
+    targets = list(TARGETS)
+    if args.only:
+        targets = [t for t in args.only.split(",") if t in TARGETS]
+
+    baseline = load_baseline(args.baseline) if args.baseline else {}
+    may_overflow = set(args.expect_overflow.split(",")) - {""}
+
+    results = []
+    with tempfile.TemporaryDirectory() as tmpdir:
+        if args.before:
+            # its plain `Lox script`, whatever engine that was then
+            name = "jlox@" + args.before
+            before = os.path.join(tmpdir, "before")
+            os.mkdir(before)
+            classpath = build_baseline(args.before, before)
+            TARGETS[name] = {
+                "cmd": ["java", "-cp", classpath, LOX_MAIN],
+                "runs": "all",
+            }
+            targets.insert(0, name)
+
+        for path, kind in find_scripts(args.scripts):
+            for target in targets:
+                if TARGETS[target]["runs"] == "expr" and kind != "expr":
+                    continue
+                try:
+                    results.append(bench(target, path, kind, args, tmpdir))
+                except StackOverflow as e:
+                    result = {
+                        "script": os.path.relpath(path, ROOT),
+                        "interpreter": target,
+                    }
+                    if target in may_overflow:
+                        result["overflowed"] = True
+                    else:
+                        result["error"] = str(e)
+                    results.append(result)
+                except (OSError, RuntimeError) as e:
+                    results.append({
+                        "script": os.path.relpath(path, ROOT),
+                        "interpreter": target,
+                        "error": str(e),
+                    })
+
+    regressed = print_table(results, baseline)
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({
+                "warmup": args.warmup,
+                "reps": args.reps,
+                "results": results,
+            }, f, indent=2)
+
+    failed = any("error" in r for r in results)
+    return 1 if regressed or failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+# runs every script under lox-files/conformance/ (or the ones given)...
+# ... on each jlox engine, the visitor too, and checks that stdout,...
+# ... stderr and the exit code match the script's golden output,...
+# ... `<script>.expected` next to it
+#
+# the golden output comes from the baseline interpreter, not from...
+# ... any engine at HEAD: --bless checks out --baseline-rev (the...
+# ... repo's first commit unless told otherwise), compiles its jlox...
+# ... and writes what it prints for each script
+#
+# scripts w/out a `;` are single expressions (the clox corpus) and...
+# ... get wrapped in a `print` statement, like tools/bench.py does
+#
+# w/ --optimize every engine, the visitor too, also runs the script...
+# ... through the AST optimizer, whose report on exit isn't compared...
+# ... but printed next to the result, i.e. the nodes before and after
+#
+# usage: conformance.py [--engines NAME,...] [--optimize] [script ...]
+#        conformance.py --bless [--baseline-rev REV] [script ...]
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+LOX_FILES = os.path.join(ROOT, "lox-files")
+CONFORMANCE_DIR = os.path.join(LOX_FILES, "conformance")
+
+LOX_MAIN = "com.craftinginterpreters.lox.Lox"
+JAVA = ["java", "-cp", os.path.join(ROOT, "java"), LOX_MAIN]
+
+ENGINES = ["visitor", "closure", "jvm", "stack"]
+
+STDOUT_MARK = "--- stdout\n"
+STDERR_MARK = "--- stderr\n"
+
+
+def find_scripts():
+    # only these have golden files; any other script has to be...
+    # ... blessed and then given by name
+    return sorted(os.path.join(CONFORMANCE_DIR, name)
+                  for name in os.listdir(CONFORMANCE_DIR)
+                  if name.endswith(".lox"))
+
+
+def program_for(path, tmpdir):
+    with open(path) as f:
+        src = f.read()
+    if ";" in src:
+        return path
+
+    wrapped = os.path.join(tmpdir, os.path.relpath(path, LOX_FILES)
+                           .replace(os.sep, "_"))
+    with open(wrapped, "w") as f:
+        f.write("print " + src.strip() + ";\n")
+    return wrapped
+
+
+def expected_path(path):
+    return os.path.splitext(path)[0] + ".expected"
+
+
+def run_java(cmd):
+    proc = subprocess.run(cmd, stdout=subprocess.PIPE,
+                          stderr=subprocess.PIPE)
+    return (proc.returncode, proc.stdout.decode(errors="replace"),
+            proc.stderr.decode(errors="replace"))
+
+
+def run(engine, script, optimize=False):
+    # returns the result and the optimizer's report, if any
+    flags = ["--engine=" + engine] + (["--optimize"] if optimize else [])
+    code, out, err = run_java(JAVA + flags + [script])
+
+    report = ""
+    if optimize:
+        lines = err.splitlines(True)
+        report = "".join(line for line in lines
+                         if line.startswith("optimized ")).strip()
+        err = "".join(line for line in lines
+                      if not line.startswith("optimized "))
+    return (code, out, err), report
+
+
+# golden files hold the exit code, then stdout and stderr verbatim
+def format_expected(result):
+    code, out, err = result
+    return "exit %d\n%s%s%s%s" % (code, STDOUT_MARK, out, STDERR_MARK, err)
+
+
+def parse_expected(text):
+    head, rest = text.split("\n", 1)
+    if not head.startswith("exit ") or not rest.startswith(STDOUT_MARK):
+        raise ValueError("not a golden file")
+
+    out, err = rest[len(STDOUT_MARK):].split(STDERR_MARK, 1)
+    return (int(head[len("exit "):]), out, err)
+
+
+def load_expected(path):
+    # None when there isn't one yet
+    golden = expected_path(path)
+    if not os.path.exists(golden):
+        return None
+    with open(golden) as f:
+        return parse_expected(f.read())
+
+
+def describe(label, result):
+    code, out, err = result
+    lines = ["  %s: exit %d" % (label, code)]
+    for name, text in (("stdout", out), ("stderr", err)):
+        tail = text.strip().splitlines()[-3:]
+        for line in tail:
+            lines.append("    %s| %s" % (name, line))
+    return "\n".join(lines)
+
+
+def baseline_rev():
+    # the repo's first commit, i.e. the interpreter before any engine
+    out = subprocess.run(["git", "-C", ROOT, "rev-list", "--max-parents=0",
+                          "HEAD"], stdout=subprocess.PIPE, check=True)
+    return out.stdout.decode().split()[-1]
+
+
+def build_baseline(rev, tmpdir, extra=None):
+    # returns the classpath of the baseline's jlox; `extra` maps file...
+    # ... names to sources added to its package before compiling
+    archive = subprocess.run(["git", "-C", ROOT, "archive", rev, "java"],
+                             stdout=subprocess.PIPE, check=True)
+    subprocess.run(["tar", "-x", "-C", tmpdir], input=archive.stdout,
+                   check=True)
+
+    classpath = os.path.join(tmpdir, "java")
+    sources = os.path.join(classpath, "com", "craftinginterpreters", "lox")
+    for name, text in (extra or {}).items():
+        with open(os.path.join(sources, name), "w") as f:
+            f.write(text)
+    subprocess.run(["javac"] + sorted(
+        os.path.join(sources, name) for name in os.listdir(sources)
+        if name.endswith(".java")), check=True)
+    return classpath
+
+
+def bless(scripts, rev):
+    with tempfile.TemporaryDirectory() as tmpdir:
+        classpath = build_baseline(rev, tmpdir)
+        print("baseline %s" % rev)
+
+        for path in scripts:
+            # the baseline takes nothing but the script
+            result = run_java(["java", "-cp", classpath, LOX_MAIN,
+                               program_for(path, tmpdir)])
+            with open(expected_path(path), "w") as f:
+                f.write(format_expected(result))
+            print("wrote %-44s exit %d" % (
+                os.path.relpath(expected_path(path), ROOT), result[0]))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--engines", default=",".join(ENGINES),
+                        help="comma-separated engines to check")
+    parser.add_argument("--optimize", action="store_true",
+                        help="also check each engine w/ --optimize")
+    parser.add_argument("--bless", action="store_true",
+                        help="write each script's golden output from "
+                             "the baseline interpreter")
+    parser.add_argument("--baseline-rev",
+                        help="the revision --bless runs (default: the "
+                             "first commit)")
+    parser.add_argument("scripts", nargs="*")
+    args = parser.parse_args()
+
+    scripts = args.scripts or find_scripts()
+    if args.bless:
+        return bless(scripts, args.baseline_rev or baseline_rev())
+
+    names = [e for e in args.engines.split(",") if e]
+
+    # (label, engine, optimize)
+    engines = [(e, e, False) for e in names]
+    if args.optimize:
+        engines += [(e + "+optimize", e, True) for e in names]
+
+    failures = 0
+    with tempfile.TemporaryDirectory() as tmpdir:
+        for path in scripts:
+            name = os.path.relpath(path, ROOT)
+            expected = load_expected(path)
+            if expected is None:
+                failures += 1
+                print("FAIL %-44s no %s, see --bless" % (
+                    name, os.path.basename(expected_path(path))))
+                continue
+
+            program = program_for(path, tmpdir)
+            for label, engine, optimize in engines:
+                actual, report = run(engine, program, optimize)
+                if actual == expected:
+                    print(("PASS %-44s %-18s %s" % (name, label, report))
+                          .rstrip())
+                    continue
+
+                failures += 1
+                print("FAIL %-44s %s" % (name, label))
+                print(describe("expected", expected))
+                print(describe(label, actual))
+
+    print("%d failure(s)" % failures)
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+# how deep jlox can recurse: finds the deepest `depth(n)` (plain,...
+# ... non-tail recursion) the visitor finishes before the Java stack...
+# ... overflows, then runs the stack engine at multiples of it and...
+# ... checks it prints the right answer each time
+#
+# the visitor's limit moves a little from run to run (the JIT changes...
+# ... frame sizes), so it's a search to within --precision, not an...
+# ... exact number
+#
+# usage: depth_check.py [--precision N] [--limit N] [--multiples N,...]
+
+import argparse
+import os
+import sys
+import tempfile
+
+from conformance import JAVA, run_java
+
+PROGRAM = """fun depth(n) {
+    if (n == 0)
+        return 0;
+    return 1 + depth(n - 1);
+}
+
+print depth(%d);
+"""
+
+
+def runs(engine, n, tmpdir):
+    # returns True if it printed n, False on a StackOverflowError...
+    # ... and raises on anything else
+    path = os.path.join(tmpdir, "depth%d.lox" % n)
+    with open(path, "w") as f:
+        f.write(PROGRAM % n)
+
+    code, out, err = run_java(JAVA + ["--engine=" + engine, path])
+    os.remove(path)
+
+    if code == 0 and out.strip() == str(n):
+        return True
+    if code != 0 and "java.lang.StackOverflowError" in err:
+        return False
+    raise RuntimeError("%s, depth(%d): exit %d: %s" % (
+        engine, n, code, (out + err).strip()[-200:]))
+
+
+def visitor_limit(args, tmpdir):
+    # the deepest n that ran, or None if nothing up to --limit overflowed
+    ran = 0
+    n = 1000
+    while runs("visitor", n, tmpdir):
+        ran = n
+        if n >= args.limit:
+            return None
+        n = min(n * 2, args.limit)
+
+    # ran <= limit < n
+    failed = n
+    while failed - ran > args.precision:
+        mid = (ran + failed) // 2
+        if runs("visitor", mid, tmpdir):
+            ran = mid
+        else:
+            failed = mid
+    return ran
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--precision", type=int, default=100,
+                        help="how close to search the visitor's limit")
+    parser.add_argument("--limit", type=int, default=10000000,
+                        help="give up on the visitor overflowing past this")
+    parser.add_argument("--multiples", default="10,100",
+                        help="comma-separated multiples of the visitor's "
+                             "limit to run on the stack engine")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as tmpdir:
+        try:
+            limit = visitor_limit(args, tmpdir)
+        except RuntimeError as e:
+            print("FAIL %s" % e)
+            return 1
+
+        if limit is None:
+            print("FAIL visitor ran depth(%d) w/out overflowing" % args.limit)
+            return 1
+        print("visitor: depth(n) runs up to n = %d (to within %d), then "
+              "overflows" % (limit, args.precision))
+
+        failures = 0
+        for multiple in [int(m) for m in args.multiples.split(",") if m]:
+            n = limit * multiple
+            try:
+                ok = runs("stack", n, tmpdir)
+            except RuntimeError as e:
+                failures += 1
+                print("FAIL %s" % e)
+                continue
+
+            if ok:
+                print("PASS stack:   depth(%d), %dx the visitor's" % (
+                    n, multiple))
+            else:
+                failures += 1
+                print("FAIL stack:   depth(%d), %dx the visitor's, "
+                      "overflowed" % (n, multiple))
+
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+# runs FrontEndBench, scan + parse time and heap on a generated...
+# ... source, against HEAD's jlox and w/ --before REV against that...
+# ... revision's too
+#
+# the older scanners return a List<Token> rather than a TokenStream,...
+# ... so REV gets HEAD's FrontEndBench w/ its token stream declared...
+# ... as that instead; it only calls size() on it, which both have
+#
+# usage: front_end_bench.py [--before REV] [megabytes | script] [reps]
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+from conformance import ROOT, build_baseline
+
+BENCH = "com.craftinginterpreters.lox.FrontEndBench"
+BENCH_SRC = os.path.join(ROOT, "java", "com", "craftinginterpreters", "lox",
+                         "FrontEndBench.java")
+
+# the whole input and AST have to fit
+JAVA_FLAGS = ["-Xmx4g"]
+
+
+def run(label, classpath, args):
+    print("== %s ==" % label)
+    sys.stdout.flush()
+    return subprocess.run(["java"] + JAVA_FLAGS + ["-cp", classpath, BENCH] +
+                          args).returncode
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--before",
+                        help="also run it against this git revision")
+    parser.add_argument("args", nargs="*",
+                        help="passed on to FrontEndBench")
+    args = parser.parse_args()
+
+    failed = False
+    with tempfile.TemporaryDirectory() as tmpdir:
+        if args.before:
+            with open(BENCH_SRC) as f:
+                bench = f.read()
+            if "TokenStream tokens" not in bench:
+                raise RuntimeError("FrontEndBench has no TokenStream to "
+                                   "swap for a List<Token>")
+            bench = bench.replace("TokenStream tokens", "List<Token> tokens")
+
+            classpath = build_baseline(args.before, tmpdir,
+                                       {"FrontEndBench.java": bench})
+            failed = run("jlox@" + args.before, classpath, args.args) != 0
+            print()
+
+        if run("jlox", os.path.join(ROOT, "java"), args.args) != 0:
+            failed = True
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+# checks that jlox reports several files' front-end errors the same...
+# ... way however many threads scan, parse and resolve them: runs...
+# ... `Lox --threads=N` over the same generated files w/ 1, 2, 4, ...
+# ... up to every core (at least 4, so that threads interleave even...
+# ... on one core), a few times each, and compares the exit code,...
+# ... stdout and stderr against the single-threaded run
+#
+# the files mix syntax errors, resolver errors and clean ones, each...
+# ... error on a line of its own, so that output in the wrong order...
+# ... or from the wrong file shows up
+#
+# usage: threads_check.py [--files N] [--reps N]
+
+import argparse
+import os
+import sys
+import tempfile
+
+from conformance import JAVA, describe, run_java
+
+# one of these, after `i` lines of filler, in file i
+ERRORS = [
+    None,
+    "var = 1;\n",
+    "{ var a = a; }\n",
+    "return 1;\n",
+    "print (1 + ;\n",
+]
+
+
+def generate(count, tmpdir):
+    paths = []
+    for i in range(count):
+        path = os.path.join(tmpdir, "file%02d.lox" % i)
+        with open(path, "w") as f:
+            for line in range(i):
+                f.write("var f%d_%d = %d;\n" % (i, line, line))
+            error = ERRORS[i % len(ERRORS)]
+            if error:
+                f.write(error)
+        paths.append(path)
+    return paths
+
+
+def thread_counts():
+    cores = max(os.cpu_count() or 1, 4)
+    counts = []
+    threads = 1
+    while threads < cores:
+        counts.append(threads)
+        threads *= 2
+    return counts + [cores]
+
+
+def in_file_order(err, paths):
+    # every error line starts w/ its file, and files come in...
+    # ... argument order
+    order = {path: i for i, path in enumerate(paths)}
+    seen = [order.get(line.split(": ", 1)[0], -1)
+            for line in err.splitlines()]
+    return -1 not in seen and seen == sorted(seen)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--files", type=int, default=32)
+    parser.add_argument("--reps", type=int, default=5)
+    args = parser.parse_args()
+
+    failures = 0
+    with tempfile.TemporaryDirectory() as tmpdir:
+        paths = generate(args.files, tmpdir)
+        expected = run_java(JAVA + ["--threads=1"] + paths)
+
+        code, _, err = expected
+        if code != 65 or not err or not in_file_order(err, paths):
+            failures += 1
+            print("FAIL --threads=1 didn't report every file's errors, "
+                  "in order")
+            print(describe("--threads=1", expected))
+
+        for threads in thread_counts():
+            label = "--threads=%d" % threads
+            for rep in range(args.reps):
+                actual = run_java(JAVA + [label] + paths)
+                if actual == expected:
+                    continue
+
+                failures += 1
+                print("FAIL %s, run %d" % (label, rep + 1))
+                print(describe("--threads=1", expected))
+                print(describe(label, actual))
+                break
+            else:
+                print("PASS %-14s %d runs" % (label, args.reps))
+
+    print("%d failure(s)" % failures)
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())